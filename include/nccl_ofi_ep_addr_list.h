@@ -6,6 +6,7 @@
 #define NCCL_OFI_EP_ADDR_LIST_H
 
 #include <cstdint>
+#include <map>
 #include <mutex>
 #include <string_view>
 #include <unordered_map>
@@ -25,12 +26,17 @@ class nccl_ofi_ep_addr_list_t {
 	 * If an endpoint is found, add this address to its connection list.
 	 * If all endpoints are already connected to addr, return NULL.
 	 *
+	 * Endpoints are handed out in the order they were inserted. The
+	 * cost is O(1) amortized in the number of endpoints: each
+	 * endpoint is skipped at most once per address.
+	 *
 	 * @param addr_in Libfabric address
 	 * @param addr_size Size of address
 	 * @param ep Output ep
 	 *	     NULL if no ep found
 	 *
 	 * @return 0, on success
+	 *         -EINVAL, the endpoint order is inconsistent
 	 */
 	int get(const void *addr_in, size_t addr_size, nccl_net_ofi_ep_t **ep);
 
@@ -98,11 +104,38 @@ class nccl_ofi_ep_addr_list_t {
 		}
 	};
 
-        using address_set = std::unordered_set<address_storage, address_storage_hash>;
-	using endpoint_map = std::unordered_map<nccl_net_ofi_ep_t *, address_set>;
+	/* Endpoint of the list */
+	struct endpoint_entry {
+		/* Position of the endpoint in `endpoint_order' */
+		uint64_t seq;
+		/* Addresses the endpoint is connected to. Point to the
+		   keys of `address_index', which are stable until the
+		   entry is erased. */
+		std::vector<const address_storage *> addresses;
+	};
+
+	/* Reverse index entry of a remote address */
+	struct address_entry {
+		/* Endpoints connected to the address */
+		std::unordered_set<nccl_net_ofi_ep_t *> eps;
+		/* All endpoints with a sequence number lower than the
+		   cursor are connected to the address */
+		uint64_t cursor;
+	};
+
+	using endpoint_map = std::unordered_map<nccl_net_ofi_ep_t *, endpoint_entry>;
+	using address_index = std::unordered_map<address_storage, address_entry, address_storage_hash>;
+
+	/* Record that `ep' is connected to the address of `addr_iter' */
+	void connect(endpoint_map::iterator ep_iter, address_index::iterator addr_iter);
 
 	std::mutex lock;
 	endpoint_map endpoints;
+	/* Endpoints by insertion sequence number */
+	std::map<uint64_t, nccl_net_ofi_ep_t *> endpoint_order;
+	/* Sequence number of the next inserted endpoint */
+	uint64_t next_seq = 0;
+	address_index addresses;
 };
 
 #endif
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2025 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+#ifndef NCCL_OFI_IDTABLE_H_
+#define NCCL_OFI_IDTABLE_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <mutex>
+#include <vector>
+
+
+/*
+ * Sparse table mapping IDs to pointers, used to look up communicators
+ * by the communicator ID carried in immediate data.
+ *
+ * The table is a two-level radix tree: the upper bits of an ID select
+ * a directory entry, the lower bits an entry of the leaf it points
+ * to. Leaves are allocated on demand the first time an ID of their
+ * range is set, so memory grows with the range of IDs in use instead
+ * of the size of the ID space. Leaves are only released when the
+ * table is destroyed, which keeps lookups lock-free.
+ */
+class nccl_ofi_idtable_t {
+public:
+	/* Number of ID bits resolved by a leaf */
+	static constexpr size_t leaf_bits = 10;
+	static constexpr size_t leaf_size = (size_t)1 << leaf_bits;
+
+	/*
+	 * @brief	Initialize table for IDs `0..size-1'
+	 *
+	 * Only the directory is allocated; all IDs map to NULL.
+	 */
+	nccl_ofi_idtable_t(size_t size);
+
+	~nccl_ofi_idtable_t();
+
+	/* Disable implicit copy constructor and assignment operator */
+	nccl_ofi_idtable_t(const nccl_ofi_idtable_t&) = delete;
+	nccl_ofi_idtable_t& operator=(const nccl_ofi_idtable_t&) = delete;
+
+
+	/*
+	 * @brief	Return the pointer stored for `id', or NULL
+	 *
+	 * Lock-free, and safe to call concurrently with `set()'.
+	 */
+	inline void *get(size_t id) const
+	{
+		assert(id < size);
+
+		void **leaf = __atomic_load_n(&dir[id >> leaf_bits], __ATOMIC_ACQUIRE);
+		if (OFI_UNLIKELY(leaf == NULL)) {
+			return NULL;
+		}
+		return __atomic_load_n(&leaf[id & (leaf_size - 1)], __ATOMIC_ACQUIRE);
+	}
+
+
+	/*
+	 * @brief	Store `ptr' for `id'
+	 *
+	 * Allocates the leaf covering `id' if needed. Storing NULL
+	 * never allocates.
+	 *
+	 * @return	0, on success
+	 *		-ENOMEM, if the leaf could not be allocated
+	 */
+	int set(size_t id, void *ptr);
+
+
+	/* Return number of IDs in the table */
+	size_t get_size() const { return size; }
+
+	/* Return number of leaves allocated so far */
+	size_t get_num_leaves();
+
+
+/* Make member variables protected to allow for unit test child classes to
+   directly access them */
+protected:
+	/* Number of IDs */
+	size_t size;
+
+	/* Directory of `ceil(size / leaf_size)' leaf pointers. A
+	   leaf pointer is NULL until an ID of its range is set */
+	std::vector<void **> dir;
+
+	/* Number of allocated leaves */
+	size_t num_leaves;
+
+	/* Lock serializing leaf allocation */
+	std::mutex lock;
+};
+
+#endif // End NCCL_OFI_IDTABLE_H_
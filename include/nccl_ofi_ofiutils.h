@@ -16,12 +16,15 @@ int nccl_ofi_ofiutils_get_providers(const char *prov_include,
  * @brief	Allocates and initialises libfabric endpoint and AV.
  *
  * @param cq:	Completion queue to which the new endpoint will be bound
+ * @param srx:	Shared receive context to which the new endpoint will be
+ *		bound, or NULL. `info' must request a shared receive
+ *		context if set.
  * @return	Endpoint ep
  * @return	Address vector av
  */
 int nccl_ofi_ofiutils_init_connection(struct fi_info *info, struct fid_domain *domain,
 				      struct fid_ep **ep,   struct fid_av **av,
-				      struct fid_cq *cq);
+				      struct fid_cq *cq, struct fid_ep *srx);
 
 /*
  * @brief	Release libfabric endpoint and address vector
@@ -225,6 +225,48 @@ OFI_NCCL_PARAM_INT(mr_cache_disable, "MR_CACHE_DISABLE",
  */
 OFI_NCCL_PARAM_INT(cq_read_count, "CQ_READ_COUNT", 4);
 
+/*
+ * Maximum number of cq entries to read in a single call to fi_cq_read
+ * in the RDMA protocol. The RDMA protocol starts with CQ_READ_COUNT
+ * entries per read and adapts the count of each rail to the CQ
+ * occupancy, up to this value.
+ */
+OFI_NCCL_PARAM_INT(cq_read_count_max, "CQ_READ_COUNT_MAX", 64);
+
+/*
+ * Polling interval of completion queues of idle rails in the RDMA
+ * protocol. A rail is idle when its CQ returned no completion in the
+ * last 256 reads and no operation was posted to it since. Idle rails
+ * are only polled every CQ_IDLE_POLL_INTERVAL calls to the progress
+ * engine, while active rails are polled on every call. Since idle
+ * rails may still receive messages and RDMA writes from peers, larger
+ * values reduce the number of empty CQ reads at the cost of delaying
+ * those completions. The default of 1 polls all rails on every call.
+ * The number of CQ reads per completion entry of each rail is logged
+ * at NCCL_DEBUG=INFO when the domain is freed.
+ */
+OFI_NCCL_PARAM_UINT(cq_idle_poll_interval, "CQ_IDLE_POLL_INTERVAL", 1);
+
+/*
+ * Whether to drive progress of the RDMA protocol from a dedicated
+ * thread per domain, pinned to the cores local to the domain's NICs.
+ * When enabled, the progress thread reads completions, reposts rx
+ * buffers and retries pending requests, and test() only checks the
+ * request state.
+ */
+OFI_NCCL_PARAM_INT(progress_thread, "PROGRESS_THREAD", 0);
+
+/*
+ * Time in microseconds the progress thread keeps polling the CQs
+ * after the last completion before blocking on the CQ wait objects,
+ * or, if the provider does not support CQ wait objects, before
+ * polling at a lower rate. Lower values save CPU cycles between
+ * communication phases at the cost of wake-up latency when traffic
+ * resumes. A negative value makes the progress thread poll
+ * continuously. Only used with PROGRESS_THREAD.
+ */
+OFI_NCCL_PARAM_INT(cq_wait_spin_usec, "CQ_WAIT_SPIN_USEC", 100);
+
 /*
  * Protocol to use for send/recv operations.  Valid options are
  * SENDRECV and RDMA, with SENDRECV the default.  Default param is
@@ -332,6 +374,115 @@ OFI_NCCL_PARAM_INT(rdma_max_posted_control_buffers, "RDMA_MAX_POSTED_CONTROL_BUF
  */
 OFI_NCCL_PARAM_INT(rdma_rr_ctrl_msg, "RR_CTRL_MSG", 1);
 
+/*
+ * Whether endpoints of the same domain share their rx buffers through
+ * libfabric shared receive contexts. Only used together with
+ * ENDPOINT_PER_COMM, where every receive communicator otherwise posts
+ * its own set of eager and control rx buffers. When enabled, the pool
+ * shared by all endpoints of a domain holds the
+ * RDMA_{MIN,MAX}_POSTED_{EAGER,CONTROL}_BUFFERS rx buffers of a
+ * single endpoint for every endpoint sharing it, up to
+ * RDMA_SHARED_RX_MAX_EPS endpoints. Cannot be combined with
+ * RDMA_MULTI_RECV_MSGS.
+ */
+OFI_NCCL_PARAM_INT(rdma_shared_rx, "RDMA_SHARED_RX", 0);
+
+/*
+ * Maximum number of endpoints the shared rx buffer pool of a domain
+ * is sized for (see RDMA_SHARED_RX). Endpoints sharing the pool
+ * beyond this number do not grow it further, which bounds the memory
+ * of posted rx buffers per domain.
+ */
+OFI_NCCL_PARAM_UINT(rdma_shared_rx_max_eps, "RDMA_SHARED_RX_MAX_EPS", 8);
+
+/*
+ * Number of communicators the request freelist of an RDMA endpoint is
+ * sized for. The freelist grows on demand up to the maximum number of
+ * requests a communicator may hold for every one of these
+ * communicators. Requests beyond that fail with ENOMEM. 0 means no
+ * limit.
+ */
+OFI_NCCL_PARAM_UINT(rdma_ep_max_comms, "RDMA_EP_MAX_COMMS", 64);
+
+/*
+ * Post ctrl and eager rx buffers as slabs with FI_MULTI_RECV, sized
+ * to receive this many messages each, instead of posting one rx buffer
+ * per message. A slab is reposted once the provider released it and
+ * all messages received into it have been consumed. The
+ * RDMA_{MIN,MAX}_POSTED_{EAGER,CONTROL}_BUFFERS bounds are divided by
+ * this value to get the number of posted slabs. Requires a provider
+ * supporting FI_MULTI_RECV. Defaults to 0 (disabled).
+ */
+OFI_NCCL_PARAM_UINT(rdma_multi_recv_msgs, "RDMA_MULTI_RECV_MSGS", 0);
+
+/*
+ * Adapt the number of rx buffers kept posted on each rail to its
+ * traffic, instead of always refilling up to
+ * RDMA_MAX_POSTED_{EAGER,CONTROL}_BUFFERS. A rail starts at twice its
+ * minimum, doubles its depth when it runs dry or fails to post rx
+ * buffers, and halves it when fewer buffers than half its depth were
+ * filled during the last RDMA_RX_BUFF_TUNE_EPOCH_US microseconds.
+ * RDMA_{MIN,MAX}_POSTED_{EAGER,CONTROL}_BUFFERS still bound the depth.
+ */
+OFI_NCCL_PARAM_INT(rdma_rx_buff_autotune, "RDMA_RX_BUFF_AUTOTUNE", 0);
+OFI_NCCL_PARAM_UINT(rdma_rx_buff_tune_epoch_us, "RDMA_RX_BUFF_TUNE_EPOCH_US", 100000);
+
+/*
+ * Upper bound in bytes on the rx buffers kept posted by all rails of
+ * all endpoints of the process when RDMA_RX_BUFF_AUTOTUNE is enabled.
+ * Rails do not grow their depth beyond this budget, but always keep
+ * their minimum posted. 0 means no limit.
+ */
+OFI_NCCL_PARAM_UINT(rdma_rx_buff_mem_budget, "RDMA_RX_BUFF_MEM_BUDGET", 0);
+
+/*
+ * Coalesce GPUDirect RDMA flushes of a receive communicator. A flush
+ * joins a flush read that is still in flight if that read was started
+ * after the data of the flushed receive arrived, instead of posting a
+ * read of its own. Flushes of receives whose data was placed by an
+ * eager copy are skipped, since the copy is a read by the NIC itself.
+ * Every flush decision is logged at trace level together with the
+ * number of flush reads and received messages of the communicator.
+ */
+OFI_NCCL_PARAM_INT(rdma_flush_coalesce, "RDMA_FLUSH_COALESCE", 0);
+
+/*
+ * Bring up data rails of RDMA communicators lazily. Communicators
+ * start with their control rails and the first data rail only. The
+ * sender activates the remaining data rails the first time it sends a
+ * message larger than MIN_STRIPE_SIZE, which is the first time the
+ * scheduler would stripe across rails. The receiver activates them
+ * once it receives data striped or sent over another data rail, or
+ * before it stripes a pull read of such a message.
+ */
+OFI_NCCL_PARAM_INT(rdma_lazy_data_rails, "RDMA_LAZY_DATA_RAILS", 0);
+
+/*
+ * Post eager messages that fit into the provider's inject size with
+ * fi_injectdata(). Injected sends generate no send completion; the
+ * send side of the request is complete once the inject is posted.
+ * Disabled by default.
+ */
+OFI_NCCL_PARAM_INT(rdma_eager_inject, "RDMA_EAGER_INJECT", 0);
+
+/*
+ * Send zero-byte messages as injected sends or RDMA writes that only
+ * carry immediate data, without a schedule or memory descriptor. The
+ * send side of such a request is complete once it is posted. Only
+ * used if the provider supports injects with remote CQ data on the
+ * first data rail. Disabled by default.
+ */
+OFI_NCCL_PARAM_INT(rdma_zero_byte_inject, "RDMA_ZERO_BYTE_INJECT", 0);
+
+/*
+ * Minimum size of messages from device buffers that the receiver pulls
+ * with RDMA reads instead of advertising its buffer for the sender to
+ * write into. The sender injects a header describing its buffer, and
+ * falls back to writes if the receiver posted its buffer first, or if
+ * pull mode is disabled on the receiver. -1 disables pull mode.
+ */
+OFI_NCCL_PARAM_INT(rdma_pull_min_size, "RDMA_PULL_MIN_SIZE", -1);
+
 /*
  * Internode network latency reported to NCCL. Defaults to 0, unless the configured
  * platform sets a specific value.
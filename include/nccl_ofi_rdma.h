@@ -8,16 +8,26 @@
 
 #include <rdma/fabric.h>
 
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
 #include <deque>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "nccl_ofi.h"
 #include "nccl_ofi_ep_addr_list.h"
 #include "nccl_ofi_freelist.h"
 #include "nccl_ofi_idpool.h"
+#include "nccl_ofi_idtable.h"
 #include "nccl_ofi_log.h"
+#include "nccl_ofi_math.h"
 #include "nccl_ofi_msgbuff.h"
 #include "nccl_ofi_scheduler.h"
 #include "nccl_ofi_topo.h"
+#include "stats/histogram.h"
+#include "stats/histogram_binner.h"
 #if HAVE_NVTX_TRACING
 #include <nvtx3/nvToolsExt.h>
 #endif
@@ -31,6 +41,33 @@ static_assert(MAX_NUM_RAILS <= UINT16_MAX);
 
 #define NCCL_OFI_RDMA_CTRL_TYPE_BITS (4)
 
+/*
+ * @brief	Version of the RDMA protocol spoken on the wire
+ *
+ * Carried in connect and connect response messages. Increment it
+ * whenever the layout or interpretation of a message changes.
+ *
+ * Version 2 widens the segment count of the write immediate data to
+ * 6 bits (see NCCL_OFI_RDMA_SEQ_BITS).
+ */
+#define NCCL_OFI_RDMA_PROTOCOL_VERSION (2)
+
+/*
+ * @brief	Oldest protocol version accepted from a peer
+ */
+#define NCCL_OFI_RDMA_PROTOCOL_VERSION_MIN (1)
+
+/*
+ * @brief	First protocol version with 6-bit segment counts and
+ *		16-bit comm IDs in the write immediate data
+ */
+#define NCCL_OFI_RDMA_PROTOCOL_VERSION_WIDE_SEGMS (2)
+
+/*
+ * @brief	Number of bits used for the protocol version
+ */
+#define NCCL_OFI_RDMA_PROTOCOL_VERSION_BITS (8)
+
 /*
  * @brief      Number of bits used for the communicator ID
  */
@@ -42,16 +79,110 @@ static_assert(MAX_NUM_RAILS <= UINT16_MAX);
  * The immediate data associated with an RDMA write operation is 32
  * bits and is divided into three parts, the segment count, the
  * communicator ID, and the message sequence number (msg_seq_num).
- * The data is encoded as follows:
+ * Up to protocol version 1, the data is encoded as follows:
  *
  * | 4-bit segment count | 18-bit comm ID | 10-bit msg_seq_num |
  *
+ * Since protocol version 2, the upper two bits of the comm ID field
+ * hold the upper bits of a 6-bit segment count:
+ *
+ * | segment count bits 0-3 | segment count bits 4-5 | 16-bit comm ID | 10-bit msg_seq_num |
+ *
  * - Segment count: number of RDMA writes that will be delivered as part of this message
  * - Comm ID: the ID for this communicator
  * - Message sequence number: message identifier
+ *
+ * Communicators are given IDs below 1 << NCCL_OFI_RDMA_IMM_COMM_ID_BITS,
+ * so the upper two bits of the comm ID field are zero in immediate
+ * data from version 1 peers and both layouts decode the same way.
+ * Immediate data to a version 1 peer carries at most
+ * NCCL_OFI_RDMA_MAX_NUM_SEGMS_V1 segments, which leaves the upper
+ * segment count bits zero and the 18-bit comm ID field intact.
  */
 #define NCCL_OFI_RDMA_SEQ_BITS     (10)
 
+/*
+ * @brief	Number of bits of the comm ID in immediate data since
+ *		protocol version 2
+ */
+#define NCCL_OFI_RDMA_IMM_COMM_ID_BITS (16)
+
+/*
+ * @brief	Number of bits used for number of segments value
+ */
+#define NUM_NUM_SEG_BITS ((uint64_t)6)
+
+/*
+ * @brief	Number of bits used for number of segments value up to
+ *		protocol version 1
+ */
+#define NUM_NUM_SEG_BITS_V1 ((uint64_t)4)
+
+static_assert(NCCL_OFI_RDMA_SEQ_BITS + NCCL_OFI_RDMA_COMM_ID_BITS + NUM_NUM_SEG_BITS_V1 == 32,
+	      "Version 1 immediate data must be 32 bits");
+static_assert(NCCL_OFI_RDMA_SEQ_BITS + NCCL_OFI_RDMA_IMM_COMM_ID_BITS + NUM_NUM_SEG_BITS == 32,
+	      "Immediate data must be 32 bits");
+
+/*
+ * @brief	Maximum number of segments of a message that the immediate
+ *		data can encode
+ */
+#define NCCL_OFI_RDMA_MAX_NUM_SEGMS (((uint64_t)1 << NUM_NUM_SEG_BITS) - 1)
+
+/*
+ * @brief	Maximum number of segments of a message to a protocol
+ *		version 1 peer
+ */
+#define NCCL_OFI_RDMA_MAX_NUM_SEGMS_V1 (((uint64_t)1 << NUM_NUM_SEG_BITS_V1) - 1)
+
+/*
+ * @brief	Communicator ID bitmask for immediate data
+ */
+#define IMM_COMM_ID_MASK (((uint64_t)1 << NCCL_OFI_RDMA_IMM_COMM_ID_BITS) - 1)
+
+/*
+ * @brief	Message sequence number bitmask for immediate data
+ */
+#define MSG_SEQ_NUM_MASK (((uint64_t)1 << NCCL_OFI_RDMA_SEQ_BITS) - 1)
+
+/*
+ * @brief	Extract communicator ID from write completion immediate data
+ *
+ * The immediate data bit format is documented in the definition of NCCL_OFI_RDMA_SEQ_BITS
+ */
+#define GET_COMM_ID_FROM_IMM(data) (((data) >> NCCL_OFI_RDMA_SEQ_BITS) & IMM_COMM_ID_MASK)
+
+/*
+ * @brief	Extract message sequence number from write completion immediate data
+ *
+ * The immediate data bit format is documented in the definition of NCCL_OFI_RDMA_SEQ_BITS
+ */
+#define GET_SEQ_NUM_FROM_IMM(data) ((data) & MSG_SEQ_NUM_MASK)
+
+/*
+ * @brief	Extract number of segments from write completion immediate data
+ *
+ * The immediate data bit format is documented in the definition of NCCL_OFI_RDMA_SEQ_BITS
+ */
+#define GET_NUM_SEG_FROM_IMM(data)							\
+	((((data) >> (NCCL_OFI_RDMA_SEQ_BITS + NCCL_OFI_RDMA_COMM_ID_BITS)) &		\
+	  NCCL_OFI_RDMA_MAX_NUM_SEGMS_V1) |						\
+	 ((((data) >> (NCCL_OFI_RDMA_SEQ_BITS + NCCL_OFI_RDMA_IMM_COMM_ID_BITS)) &	\
+	   (NCCL_OFI_RDMA_MAX_NUM_SEGMS >> NUM_NUM_SEG_BITS_V1)) << NUM_NUM_SEG_BITS_V1))
+
+/*
+ * @brief	Build write completion immediate data from comm ID, message seq
+ *		number and number of segments used to transfer RDMA write
+ *
+ * The immediate data bit format is documented in the definition of NCCL_OFI_RDMA_SEQ_BITS
+ */
+#define GET_RDMA_WRITE_IMM_DATA(comm_id, seq, nseg)					\
+	((uint64_t)(seq) | ((uint64_t)(comm_id) << NCCL_OFI_RDMA_SEQ_BITS) |		\
+	 (((uint64_t)(nseg) & NCCL_OFI_RDMA_MAX_NUM_SEGMS_V1) <<			\
+	  (NCCL_OFI_RDMA_SEQ_BITS + NCCL_OFI_RDMA_COMM_ID_BITS)) |			\
+	 (((uint64_t)(nseg) >> NUM_NUM_SEG_BITS_V1) <<					\
+	  (NCCL_OFI_RDMA_SEQ_BITS + NCCL_OFI_RDMA_IMM_COMM_ID_BITS)))
+
 typedef enum nccl_net_ofi_rdma_req_state {
 	NCCL_OFI_RDMA_REQ_CREATED = 0,
 	NCCL_OFI_RDMA_REQ_PENDING,
@@ -102,6 +233,8 @@ enum nccl_ofi_rdma_msg_type {
 	NCCL_OFI_RDMA_MSG_EAGER,
 	NCCL_OFI_RDMA_MSG_CLOSE,
 	NCCL_OFI_RDMA_MSG_CTRL_NO_COMPLETION,
+	NCCL_OFI_RDMA_MSG_PULL,
+	NCCL_OFI_RDMA_MSG_PULL_DONE,
 	NCCL_OFI_RDMA_MSG_INVALID = 15,
 	NCCL_OFI_RDMA_MSG_MAX = NCCL_OFI_RDMA_MSG_INVALID,
 };
@@ -128,13 +261,36 @@ typedef struct nccl_net_ofi_rdma_mr_handle {
 
 	/* Array of size `num_rails' */
 	struct fid_mr **mr;
+
+	/* True if `mr' registers host memory, which the provider can
+	 * read without a descriptor (e.g., to inject a message) */
+	bool host_mem;
+
+	/* Descriptors of `mr', cached at registration since they
+	 * never change afterwards */
+	void *desc[MAX_NUM_RAILS];
+
+	/* Remote keys of `mr', cached at registration. False if the
+	 * provider did not report all keys yet. */
+	bool rkeys_valid;
+	/* True if all remote keys fit the short key encoding of
+	 * control messages */
+	bool short_rkeys_valid;
+	/* Remote keys in long and short control message encoding, so
+	 * that they can be copied into a control message as is */
+	uint64_t long_rkeys[MAX_NUM_RAILS];
+	uint32_t short_rkeys[MAX_NUM_RAILS];
 } nccl_net_ofi_rdma_mr_handle_t;
 
 
 /* Contents of ctrl message sent from receiver to sender to advertise
-   destination buffer */
+   destination buffer. Pull messages (NCCL_OFI_RDMA_MSG_PULL) use the
+   same layout to advertise the source buffer of the sender, and
+   NCCL_OFI_RDMA_MSG_PULL_DONE reports the number of bytes read in
+   `buff_len'. */
 typedef struct nccl_net_ofi_rdma_ctrl_msg {
-	/* Message type, must be NCCL_OFI_RDMA_MSG_CTRL */
+	/* Message type, NCCL_OFI_RDMA_MSG_CTRL or one of the types
+	 * above */
 	uint32_t type:NCCL_OFI_RDMA_CTRL_TYPE_BITS;
 
 	/* Message sequence number */
@@ -195,11 +351,26 @@ typedef struct nccl_net_ofi_ep_rail nccl_net_ofi_ep_rail_t;
 typedef struct {
 	/* Rx buffer freelist item */
 	nccl_ofi_freelist_elem_t *rx_buff_fl_elem;
+	/* Start of the received message. Equal to the freelist item
+	 * pointer, unless the message was received into a slab */
+	void *buff;
 	/* Length of rx buffer */
 	size_t buff_len;
 	/* Length of received data */
 	size_t recv_len;
 
+	/* True if the rx buffer is a slab posted with FI_MULTI_RECV */
+	bool multi_recv;
+	/*
+	 * References to a slab: one held by the provider while the
+	 * slab is posted plus one per received message that has not
+	 * been consumed yet. The slab is reposted once it drops to zero.
+	 */
+	int32_t slab_refcnt;
+	/* Slab the message was received into, or NULL if this request
+	 * owns its rx buffer */
+	nccl_net_ofi_rdma_req_t *slab_req;
+
 	/*
 	 * Keeps tracks of Rail ID which is used to post the rx buffer.
 	 * This is useful for re-posting the buffer on the same rail
@@ -213,6 +384,12 @@ typedef struct {
 } rdma_req_rx_buff_data_t;
 
 typedef struct {
+	/* Total number of completions. Expect one completion for receiving the
+	 * control message and one completion for each send segment. */
+	int total_num_compls;
+	/* Number of rails where we have successfully posted the network xfer.
+	 * Used mostly when the network xfer is sliced across multiple rails */
+	uint16_t xferred_rail_id;
 	/* Remote destination buffer address */
 	uint64_t remote_buff;
 	/* Remote MR key */
@@ -225,15 +402,42 @@ typedef struct {
 	void *desc;
 	/* Additional flags */
 	uint64_t flags;
+	/* (Pull reads) receive request that the data is read for, or
+	 * NULL for reads issued by the application */
+	nccl_net_ofi_rdma_req_t *recv_req;
+	/* (Pull reads) rx buffer holding the pull message, which
+	 * provides the remote keys */
+	nccl_net_ofi_rdma_req_t *pull_rx_buff_req;
+	/* (Pull reads) schedule striping the read across rails */
+	nccl_net_ofi_schedule_t *schedule;
+} rdma_req_rma_op_data_t;
+
+/*
+ * @brief	Progress of a send request offered to the receiver to pull
+ *		(see RDMA_PULL_MIN_SIZE)
+ *
+ * The pull message and the fallback writes of a request are posted by
+ * a single owner. Until the pull message is posted, the request is
+ * owned by the thread posting it, or by the pending requests queue it
+ * waits in. Once the pull message is posted, a received ctrl message
+ * makes its handler the owner that posts the writes.
+ */
+typedef enum nccl_ofi_rdma_pull_state {
+	/* Pull message not posted yet */
+	NCCL_OFI_RDMA_PULL_POSTING = 0,
+	/* Pull message posted, the request has no owner */
+	NCCL_OFI_RDMA_PULL_POSTED,
+	/* Ctrl message received, the data is written by the owner */
+	NCCL_OFI_RDMA_PULL_WRITES,
+} nccl_ofi_rdma_pull_state_t;
+
+typedef struct {
 	/* Total number of completions. Expect one completion for receiving the
 	 * control message and one completion for each send segment. */
 	int total_num_compls;
 	/* Number of rails where we have successfully posted the network xfer.
 	 * Used mostly when the network xfer is sliced across multiple rails */
 	uint16_t xferred_rail_id;
-} rdma_req_rma_op_data_t;
-
-typedef struct {
 	/* True for eager messages */
 	bool eager;
 	/* Remote destination buffer address */
@@ -253,18 +457,17 @@ typedef struct {
 	/* Schedule used to transfer this request. We save the pointer to
 	 * reference it when transferring the request over network. */
 	nccl_net_ofi_schedule_t *schedule;
-	/* Total number of completions. Expect one completion for receiving the
-	 * control message and one completion for each send segment. */
-	int total_num_compls;
-	/* Number of rails where we have successfully posted the network xfer.
-	 * Used mostly when the network xfer is sliced across multiple rails */
-	uint16_t xferred_rail_id;
 	/* 
 	 * Flag to indicate target side early completion, so that sender side
 	 * uses the corresponding RMA write operation.
 	 * True to use fi_write instead of fi_writedata in send() 
 	 */
 	bool no_target_completion;
+	/* True if the receiver is offered to read the data (see
+	 * RDMA_PULL_MIN_SIZE) */
+	bool pull;
+	/* Progress of a pull send. Accessed atomically. */
+	nccl_ofi_rdma_pull_state_t pull_state;
 #if HAVE_NVTX_TRACING
 	nvtxRangeId_t trace_id;
 	nvtxRangeId_t seg_trace_id[MAX_NUM_RAILS];
@@ -319,6 +522,16 @@ typedef struct {
  * @brief	Data of request responsible for receive operation
  */
 typedef struct {
+	/* Total number of completions. Expect one send ctrl
+	 * completion and one completion that indicates that all
+	 * segments have arrived.
+	 *
+	 * For eager messages, the second completion will be received
+	 * when the local read into the destination buffer is complete.
+	 * For pull messages, the ctrl completion is the one of the
+	 * PULL_DONE message, and the second completion the one of the
+	 * reads from the sender's buffer */
+	int total_num_compls;
 	/* Destination buffer */
 	void *dst_buff;
 	/* Destination length */
@@ -331,13 +544,8 @@ typedef struct {
 	nccl_net_ofi_rdma_req_t *recv_segms_req;
 	/* (Eager messages) pointer to eager local copy request */
 	nccl_net_ofi_rdma_req_t *eager_copy_req;
-	/* Total number of completions. Expect one send ctrl
-	 * completion and one completion that indicates that all
-	 * segments have arrived.
-	 *
-	 * For eager messages, the second completion will be received
-	 * when the local read into the destination buffer is complete */
-	int total_num_compls;
+	/* (Pull messages) pointer to read request */
+	nccl_net_ofi_rdma_req_t *pull_read_req;
 #if HAVE_NVTX_TRACING
 	nvtxRangeId_t trace_id;
 #endif
@@ -347,33 +555,70 @@ typedef struct {
  * @brief	Data of request responsible for flush operatoin
  */
 typedef struct {
+	/* Total number of completions. Expect completions from all NIC rail */
+	int total_num_compls;
 	/* Buffer to read flush data from */
 	void *data;
 	/* MR handles for the data buffer */
 	nccl_net_ofi_rdma_mr_handle_t *mr_handle;
-	/* Total number of completions. Expect completions from all NIC rail */
-	int total_num_compls;
+	/* Sequence number of the flush read among the flush reads of
+	 * the communicator */
+	uint64_t seq;
+	/* Flush requests that joined this flush read instead of posting
+	 * their own (see RDMA_FLUSH_COALESCE) */
+	nccl_net_ofi_rdma_req_t *joined_head;
+	/* Next flush request that joined the same flush read */
+	nccl_net_ofi_rdma_req_t *joined_next;
 } rdma_req_flush_data_t;
 
 /*
  * @brief	RDMA request
+ *
+ * The request is laid out such that the fields accessed when a
+ * completion is processed (rdma_req_handle_cq_entry(),
+ * inc_req_completion()) and by test() are located in the first CPU
+ * cache line. The type-specific data follows in the second cache line,
+ * starting with its fields read on the completion path, and the per-rail
+ * Libfabric contexts are placed last so that requests allocated from
+ * freelists only hold contexts for the rails that are in use (see
+ * nccl_net_ofi_rdma_req_size()).
  */
 typedef struct nccl_net_ofi_rdma_req {
 	nccl_net_ofi_req_t base;
 
-	nccl_net_ofi_context_t ctx[MAX_NUM_RAILS];
-
 	/* Associated Comm object */
 	nccl_net_ofi_comm_t *comm;
 
-	/* Associated Device ID */
-	int dev_id;
+	/* Size of completed request. Updated atomically, see `ncompls' */
+	size_t size;
+
+	/* Number of arrived request completions. Updated atomically,
+	 * since completions of a request may arrive on multiple rails
+	 * concurrently. */
+	int ncompls;
+
+	/* State of request. The transition to completed is published
+	 * with release semantics, see rdma_req_set_state() */
+	nccl_net_ofi_rdma_req_state_t state;
+
+	/* Type of request */
+	nccl_net_ofi_rdma_req_type_t type;
 
 	/* Message sequence number */
 	uint16_t msg_seq_num;
 
-	/* Number of arrived request completions */
-	int ncompls;
+	/* Associated Device ID */
+	int dev_id;
+
+	/* Deinitialzie and free request. This function returns error
+	 * in cases where cleanup fails. This function may also return
+	 * error if the owner of the request has to deallocate the
+	 * request by its own. */
+	int (*free)(nccl_net_ofi_rdma_req_t *req,
+		    bool dec_inflight_reqs);
+
+	/* Backpointer to freelist element */
+	nccl_ofi_freelist_elem_t *elem;
 
 	union {
 		rdma_req_rma_op_data_t rma_op_data;
@@ -387,32 +632,69 @@ typedef struct nccl_net_ofi_rdma_req {
 		rdma_req_rx_buff_data_t rx_buff_data;
 	};
 
-	/* Size of completed request */
-	size_t size;
-
-	/*
-	 * Protect updating critical fields such as size and ncompls when
-	 * network xfer happened over multiple rails
-	 */
-	pthread_mutex_t req_lock;
-
-	/* State of request */
-	nccl_net_ofi_rdma_req_state_t state;
-
-	/* Type of request */
-	nccl_net_ofi_rdma_req_type_t type;
-
-	/* Backpointer to freelist element */
-	nccl_ofi_freelist_elem_t *elem;
+	/* Libfabric contexts, one per rail. Must be the last member,
+	 * since freelist allocated requests only provide storage for
+	 * the rails of their endpoint. */
+	nccl_net_ofi_context_t ctx[MAX_NUM_RAILS];
+} nccl_net_ofi_rdma_req_t;
+/* Fields of the completion path must fit into the first cache line */
+static_assert(offsetof(nccl_net_ofi_rdma_req_t, elem) + sizeof(nccl_ofi_freelist_elem_t *) <=
+	      NCCL_OFI_DEFAULT_CPU_CACHE_LINE_SIZE,
+	      "Hot fields of RDMA request exceed a cache line");
+static_assert(offsetof(nccl_net_ofi_rdma_req_t, ctx) +
+	      sizeof( ((nccl_net_ofi_rdma_req_t *)0)->ctx ) == sizeof(nccl_net_ofi_rdma_req_t),
+	      "Per-rail contexts must be the last member of RDMA request");
+/* Fields of the type-specific data read when a completion is processed
+   must fit into the second cache line, which starts with the union */
+#define NCCL_OFI_RDMA_REQ_ASSERT_WARM(member)					\
+	static_assert(offsetof(nccl_net_ofi_rdma_req_t, member) +		\
+		      sizeof( ((nccl_net_ofi_rdma_req_t *)0)->member ) <=	\
+		      2 * NCCL_OFI_DEFAULT_CPU_CACHE_LINE_SIZE,			\
+		      "Completion path field " #member " of RDMA request exceeds the second cache line")
+NCCL_OFI_RDMA_REQ_ASSERT_WARM(send_data.total_num_compls);
+NCCL_OFI_RDMA_REQ_ASSERT_WARM(send_data.xferred_rail_id);
+NCCL_OFI_RDMA_REQ_ASSERT_WARM(rma_op_data.total_num_compls);
+NCCL_OFI_RDMA_REQ_ASSERT_WARM(recv_data.total_num_compls);
+NCCL_OFI_RDMA_REQ_ASSERT_WARM(flush_data.total_num_compls);
+NCCL_OFI_RDMA_REQ_ASSERT_WARM(send_ctrl_data.recv_req);
+NCCL_OFI_RDMA_REQ_ASSERT_WARM(eager_copy_data.recv_req);
+NCCL_OFI_RDMA_REQ_ASSERT_WARM(recv_segms_data.recv_req);
+NCCL_OFI_RDMA_REQ_ASSERT_WARM(rx_buff_data.rail);
+NCCL_OFI_RDMA_REQ_ASSERT_WARM(rx_buff_data.ep);
+#undef NCCL_OFI_RDMA_REQ_ASSERT_WARM
 
-	/* Deinitialzie and free request. This function returns error
-	 * in cases where cleanup fails. This function may also return
-	 * error if the owner of the request has to deallocate the
-	 * request by its own. */
-	int (*free)(nccl_net_ofi_rdma_req_t *req,
-		    bool dec_inflight_reqs);
+/*
+ * @brief	Return size of a RDMA request holding contexts for
+ *		`num_rails' rails
+ *
+ * The size is rounded up to a multiple of the cache line size, so
+ * that consecutive freelist entries do not share cache lines.
+ */
+static inline size_t nccl_net_ofi_rdma_req_size(uint16_t num_rails)
+{
+	assert(num_rails > 0 && num_rails <= MAX_NUM_RAILS);
+	size_t size = offsetof(nccl_net_ofi_rdma_req_t, ctx) +
+		num_rails * sizeof(nccl_net_ofi_context_t);
+	return NCCL_OFI_ROUND_UP(size, static_cast<size_t>(NCCL_OFI_DEFAULT_CPU_CACHE_LINE_SIZE));
+}
 
-} nccl_net_ofi_rdma_req_t;
+/*
+ * @brief	Requests of a communicator
+ *
+ * Communicators draw their requests from the request freelist shared by
+ * all communicators of their endpoint, so that request memory does not
+ * scale with the number of communicators and stays warm when
+ * communicators are recreated. A per-communicator counter bounds the
+ * number of requests a single communicator may hold.
+ */
+typedef struct {
+	/* Request freelist of the endpoint */
+	nccl_ofi_freelist_t *fl;
+	/* Number of requests currently held by the communicator */
+	size_t num_allocated;
+	/* Maximum number of requests the communicator may hold */
+	size_t max_allocated;
+} nccl_net_ofi_rdma_comm_reqs_t;
 
 /*
  * Rdma endpoint name
@@ -429,18 +711,39 @@ typedef struct nccl_ofi_rdma_ep_name {
  *
  * Connect message is send from sender to receiver side to provide
  * connection information.
+ *
+ * The message is variable-length: the header is followed by the
+ * endpoint names of the `num_control_rails' control rails and then of
+ * the `num_rails' data rails, `ep_name_len' bytes each. Use
+ * nccl_ofi_rdma_connection_info_size() for the length of a message and
+ * the accessors below for the names.
+ *
+ * The message type, protocol version and communicator IDs keep their
+ * place in all protocol versions, so that a peer speaking an
+ * unsupported version can be identified and rejected.
  */
 typedef struct nccl_ofi_rdma_connection_info {
 	/* Message type
 	 * either NCCL_OFI_RDMA_MSG_CONN or NCCL_OFI_RDMA_MSG_CONN_RESP
 	 */
 	uint16_t type:NCCL_OFI_RDMA_CTRL_TYPE_BITS;
-	uint16_t pad:(16 - NCCL_OFI_RDMA_CTRL_TYPE_BITS);
+	/* Set in the connect message if the sender wants to bring up
+	 * data rails lazily, and in the connect response if the
+	 * receiver agreed to */
+	uint16_t lazy_data_rails:1;
+	/* NCCL_OFI_RDMA_PROTOCOL_VERSION of the sending side */
+	uint16_t version:NCCL_OFI_RDMA_PROTOCOL_VERSION_BITS;
+	uint16_t pad:(16 - NCCL_OFI_RDMA_CTRL_TYPE_BITS - 1 - NCCL_OFI_RDMA_PROTOCOL_VERSION_BITS);
 
 	/* Number of rails */
 	uint16_t num_rails;
 	uint16_t num_control_rails;
 
+	/* Length of each endpoint name in the message. Both sides
+	 * must use the same address length, so that the names can be
+	 * inserted into an address vector as they are */
+	uint16_t ep_name_len;
+
 	/* A comm identitifer that uniquely identifies the comm on the sender
 	   side. The receiver must use this ID when sending messages to sender */
 	uint32_t local_comm_id;
@@ -448,16 +751,37 @@ typedef struct nccl_ofi_rdma_connection_info {
 	/* A comm identitifer that uniquely identifies the comm
 	 * on the receiver side */
 	uint32_t remote_comm_id;
-
-	/* Arrays of `MAX_NUM_RAILS` `nccl_ofi_rdma_ep_name_t`
-	 * structs. The member `num_rails` and `num_control_rails` indicate
-	 * the number of entries that are in use. */
-	nccl_ofi_rdma_ep_name_t control_ep_names[MAX_NUM_RAILS];
-	nccl_ofi_rdma_ep_name_t ep_names[MAX_NUM_RAILS];
 } nccl_ofi_rdma_connection_info_t;
 /* Since this is a message on the wire, check that it has the expected size */
-static_assert(sizeof(nccl_ofi_rdma_connection_info_t) == 528,
-			  "Wrong size for RDMA connect message");
+static_assert(sizeof(nccl_ofi_rdma_connection_info_t) == 16,
+			  "Wrong size for RDMA connect message header");
+
+/* Maximum length of a connect message */
+#define NCCL_OFI_RDMA_CONNECTION_INFO_MAX_SIZE \
+	(sizeof(nccl_ofi_rdma_connection_info_t) + 2 * MAX_NUM_RAILS * MAX_EP_ADDR)
+
+static inline size_t nccl_ofi_rdma_connection_info_size(const nccl_ofi_rdma_connection_info_t *conn_msg)
+{
+	return sizeof(nccl_ofi_rdma_connection_info_t) +
+		((size_t)conn_msg->num_control_rails + conn_msg->num_rails) * conn_msg->ep_name_len;
+}
+
+/* Return endpoint name of control rail `rail_id' of a connect message */
+static inline char *nccl_ofi_rdma_connection_info_control_ep_name(nccl_ofi_rdma_connection_info_t *conn_msg,
+								  uint16_t rail_id)
+{
+	assert(rail_id < conn_msg->num_control_rails);
+	return (char *)(conn_msg + 1) + (size_t)rail_id * conn_msg->ep_name_len;
+}
+
+/* Return endpoint name of data rail `rail_id' of a connect message */
+static inline char *nccl_ofi_rdma_connection_info_ep_name(nccl_ofi_rdma_connection_info_t *conn_msg,
+							  uint16_t rail_id)
+{
+	assert(rail_id < conn_msg->num_rails);
+	return (char *)(conn_msg + 1) +
+		((size_t)conn_msg->num_control_rails + rail_id) * conn_msg->ep_name_len;
+}
 
 /*
  * @brief	Send communicator rail
@@ -489,7 +813,7 @@ typedef struct nccl_net_ofi_rdma_send_comm {
 	uint64_t num_inflight_reqs;
 	uint64_t num_inflight_writes;
 
-	nccl_ofi_freelist_t *nccl_ofi_reqs_fl;
+	nccl_net_ofi_rdma_comm_reqs_t reqs;
 
 	/* Comm ID provided by the local endpoint */
 	uint32_t local_comm_id;
@@ -497,6 +821,11 @@ typedef struct nccl_net_ofi_rdma_send_comm {
 	/* Comm ID provided by remote endpoint */
 	uint32_t remote_comm_id;
 
+	/* Maximum number of segments of a message that the receiver
+	 * can decode from the immediate data, depending on its
+	 * protocol version */
+	uint16_t max_num_segms;
+
 	/* Request to receive connect response message to finalize
 	 * connection establishment */
 	nccl_net_ofi_rdma_req_t *conn_resp_req;
@@ -522,6 +851,16 @@ typedef struct nccl_net_ofi_rdma_send_comm {
 	 * and `num_init_control_rails' is adjusted. */
 	int num_init_control_rails;
 
+	/* Number of data rails that are brought up. Rails
+	 * `num_active_rails..num_rails-1' are only initialized by
+	 * `rdma_send_comm_activate_rails()' once the first transfer
+	 * large enough to be striped is scheduled. Updated under
+	 * `ctrl_recv_lock'. */
+	uint16_t num_active_rails;
+	/* Remote endpoint names of all data rails, kept until the
+	 * remaining data rails are activated */
+	nccl_ofi_rdma_ep_name_t *lazy_remote_ep_names;
+
 #if HAVE_NVTX_TRACING
 	nvtxDomainHandle_t nvtx_domain[NCCL_OFI_N_NVTX_DOMAIN_PER_COMM];
 #endif
@@ -580,7 +919,7 @@ typedef struct nccl_net_ofi_rdma_recv_comm {
 	nccl_net_ofi_recv_comm_t base;
 
 	uint64_t num_inflight_reqs;
-	nccl_ofi_freelist_t *nccl_ofi_reqs_fl;
+	nccl_net_ofi_rdma_comm_reqs_t reqs;
 
 	/* Comm ID provided by the local endpoint */
 	uint32_t local_comm_id;
@@ -605,11 +944,51 @@ typedef struct nccl_net_ofi_rdma_recv_comm {
 	uint64_t n_ctrl_sent;
 	uint64_t n_ctrl_delivered;
 
+	/*
+	 * Flush coalescing and elision (see RDMA_FLUSH_COALESCE)
+	 */
+
+	/* Lock for the flush state below */
+	pthread_mutex_t flush_lock;
+	/* Most recent flush read that has not completed yet, or NULL */
+	nccl_net_ofi_rdma_req_t *inflight_flush;
+	/* Number of flush reads posted so far. Also serves as sequence
+	 * number of the flush reads. */
+	uint64_t num_flush_reads;
+	/* Value of num_flush_reads when a completed receive was last
+	 * reported to NCCL. Flush reads with a higher sequence number
+	 * were started after the data of that receive arrived. */
+	uint64_t flush_seq_at_last_recv;
+	/* Set of at most NCCL_OFI_MAX_REQUESTS destination buffers of
+	 * completed receives whose data was placed by an eager copy
+	 * and that have not been flushed yet. Flushes of these buffers
+	 * are elided. NULL if flush coalescing is disabled. */
+	std::unordered_set<void *> *eager_copied_buffs;
+	/* Number of completed receives, flushes joining an in-flight
+	 * flush read, flushes elided after an eager copy, and eager
+	 * copies whose flush was not elided because
+	 * `eager_copied_buffs' was full */
+	uint64_t num_recvs_completed;
+	uint64_t num_flushes_coalesced;
+	uint64_t num_flushes_elided;
+	uint64_t num_flush_elisions_skipped;
+
 	/* Number of rails */
 	uint16_t num_rails;
 	/* Number of control rails */
 	uint16_t num_control_rails;
 
+	/* Number of data rails that are brought up. The remaining
+	 * rails are activated by `rdma_recv_comm_activate_rails()'
+	 * once the sender stripes a message or writes on another data
+	 * rail. Updated atomically under `rails_lock'. */
+	uint16_t num_active_rails;
+	/* Remote endpoint names of all data rails, kept until the
+	 * remaining data rails are activated */
+	nccl_ofi_rdma_ep_name_t *lazy_remote_ep_names;
+	/* Serializes the activation of data rails */
+	pthread_mutex_t rails_lock;
+
 	bool comm_active;
 
 	/* free list item containing a nccl_ofi_rdma_connection_info_t */
@@ -621,6 +1000,32 @@ typedef struct nccl_net_ofi_rdma_recv_comm {
 	nccl_net_ofi_rdma_recv_comm_rail_t *control_rails;
 } nccl_net_ofi_rdma_recv_comm_t;
 
+/*
+ * @brief	Connection being accepted by a listen communicator
+ *
+ * One entry is created per received connect message. Entries progress
+ * independently, so several peers can connect to the same listen
+ * communicator while earlier connections are still being established.
+ */
+typedef struct nccl_net_ofi_rdma_listen_conn {
+	/* Communicator created for this peer */
+	nccl_net_ofi_rdma_recv_comm_t *r_comm;
+
+	/* Request for the connect response message */
+	nccl_net_ofi_rdma_req_t req;
+
+	/* Stage of connection establishment for this peer */
+	nccl_ofi_comm_stage_t stage;
+
+	/* Time the connect message was received, in microseconds */
+	uint64_t recv_time_us;
+
+	/* Copy of the connect message received from the peer. Must be
+	 * the last member, the endpoint names of the message are
+	 * stored right after it. */
+	nccl_ofi_rdma_connection_info_t conn_msg;
+} nccl_net_ofi_rdma_listen_conn_t;
+
 typedef struct nccl_net_ofi_rdma_listen_comm {
 	/* This base listen communicator must be the first member of
 	 * this struct. This allows casting between pointers of this
@@ -630,22 +1035,18 @@ typedef struct nccl_net_ofi_rdma_listen_comm {
 	/* Comm ID provided by local endpoint */
 	uint32_t comm_id;
 
-	/* Communicator created while accept routine is executed */
-	nccl_net_ofi_rdma_recv_comm_t *r_comm;
+	/* Connect messages received but not yet picked up by
+	 * accept. Filled by the completion handler, protected by
+	 * conn_queue_lock. */
+	std::deque<nccl_net_ofi_rdma_listen_conn_t *> *conn_queue;
+	pthread_mutex_t conn_queue_lock;
 
-	/* Reusable request for connect and connect response message */
-	nccl_net_ofi_rdma_req_t req;
+	/* Connections currently being established by accept. Only
+	 * accessed by the thread calling accept. */
+	std::deque<nccl_net_ofi_rdma_listen_conn_t *> *accepting;
 
-	/* Stage of connection establishment on listen side */
-	nccl_ofi_comm_stage_t stage;
-
-	/* Message struct send connect message and receive connect
-	 * response message
-	 *
-	 * TODO: This should really be a list of outstanding connect
-	 * messages to allow multiple connects per listen communicator.
-	 */
-	nccl_ofi_rdma_connection_info_t conn_msg;
+	/* Number of connections accepted so far */
+	uint64_t num_accepted;
 } nccl_net_ofi_rdma_listen_comm_t;
 
 /*
@@ -669,6 +1070,14 @@ struct nccl_net_ofi_ep_rail {
 	/* Address vector handle */
 	struct fid_av *av;
 
+	/* Addresses already inserted into `av', keyed by endpoint
+	 * name. Communicators to the same peer reuse the address
+	 * instead of inserting it again. Entries live as long as the
+	 * address vector, which is never shrunk. */
+	std::unordered_map<std::string, fi_addr_t> *av_cache;
+	/* Lock for `av_cache' */
+	pthread_mutex_t av_cache_lock;
+
 	/*
 	 * Rx buffer management
 	 */
@@ -679,9 +1088,38 @@ struct nccl_net_ofi_ep_rail {
 	size_t min_rx_buff_posted;
 	/* Maximum posted rx buffers (see RDMA_MAX_POSTED_BOUNCE_BUFFERS) */
 	size_t max_rx_buff_posted;
+	/* Number of rx buffers kept posted. Equal to max_rx_buff_posted
+	 * unless adapted to the traffic of the rail between
+	 * min_rx_buff_posted and max_rx_buff_posted (see
+	 * RDMA_RX_BUFF_AUTOTUNE) */
+	size_t target_rx_buff_posted;
+	/* Size of a single rx buffer of this rail */
+	size_t rx_buff_size;
+	/* Rx buffers filled since the start of the tuning epoch */
+	size_t rx_buff_arrivals;
+	/* Times the rail ran short of posted rx buffers in the
+	 * tuning epoch */
+	size_t rx_buff_shortages;
+	/* Rx buffer reposts since the clock was last checked for the
+	 * end of the tuning epoch */
+	size_t rx_buff_tune_reposts;
+	/* Start of the tuning epoch in microseconds */
+	uint64_t rx_buff_epoch_start_us;
 	/* Mutex for rx buffer operations */
 	pthread_mutex_t rx_buff_mutex;
 
+	/*
+	 * Pending requests
+	 */
+
+	/* Requests whose next network operation targets this rail and
+	 * could not be posted since the rail returned FI_EAGAIN. Each
+	 * rail has its own queue so that a busy rail does not block
+	 * requests targeting other rails. */
+	std::deque<nccl_net_ofi_rdma_req_t *> *pending_reqs_queue;
+	/* Lock for `pending_reqs_queue` */
+	pthread_mutex_t pending_reqs_lock;
+
 	/* Allocate a receive buffer request for this rail (eager or ctrl) */
 	nccl_net_ofi_rdma_req_t* (*rx_buff_req_alloc)(nccl_net_ofi_rdma_ep_t *ep,
 						      nccl_net_ofi_ep_rail_t *rail);
@@ -718,12 +1156,12 @@ struct nccl_net_ofi_rdma_ep {
 	/* Array of `num_control_rails` endpoint rails */
 	nccl_net_ofi_ep_rail_t *control_rails;
 
-	bool use_long_rkeys;
+	/* Number of requests in the pending requests queues of all
+	 * rails. Updated atomically under the queue lock of the rail,
+	 * read without locks to check for pending requests. */
+	size_t num_pending_reqs;
 
-	/* Pending requests queue */
-	std::deque<nccl_net_ofi_rdma_req_t *> *pending_reqs_queue;
-	/* Lock for `pending_reqs_queue` */
-	pthread_mutex_t pending_reqs_lock;
+	bool use_long_rkeys;
 
 	/* Free list of ctrl rx buffers */
 	nccl_ofi_freelist_t *ctrl_rx_buff_fl;
@@ -731,6 +1169,9 @@ struct nccl_net_ofi_rdma_ep {
 	nccl_ofi_freelist_t *eager_rx_buff_fl;
 	/* Free list of rx buffer requests */
 	nccl_ofi_freelist_t *rx_buff_reqs_fl;
+	/* Free list of requests of the communicators of this
+	 * endpoint (see nccl_net_ofi_rdma_comm_reqs_t) */
+	nccl_ofi_freelist_t *comm_reqs_fl;
 	/* Free list for connection messages */
 	nccl_ofi_freelist_t *conn_msg_fl;
 	/* Size of ctrl rx buffers */
@@ -748,11 +1189,32 @@ struct nccl_net_ofi_rdma_ep {
 	 * disabled.
 	 */
 	ssize_t eager_send_size;
+	/* Eager messages up to this size are posted with
+	 * fi_injectdata(). Will be -1 if injecting eager messages is
+	 * disabled. */
+	ssize_t eager_inject_size;
+	/* True if zero-byte messages are injected on the first data
+	 * rail without a schedule (see RDMA_ZERO_BYTE_INJECT) */
+	bool zero_byte_inject;
+	/* Minimum size of messages offered to the receiver to pull
+	 * with RDMA reads. Will be -1 if pull mode is disabled. */
+	ssize_t pull_min_size;
+	/* Number of messages a ctrl or eager rx buffer slab is sized
+	 * for when rx buffers are posted with FI_MULTI_RECV, or 0 if
+	 * every rx buffer receives a single message */
+	size_t multi_recv_msgs;
 
 	/* true if the current endpoint is a endpoint_per_communicator
 	   receive communicator */
 	bool is_endpoint_per_communicator_ep;
 
+	/* Closed communicators of this endpoint pending deferred
+	 * cleanup. Allocated while the endpoint is on the list of
+	 * closing endpoints, NULL otherwise. Protected by the comm
+	 * cleanup list lock. */
+	std::deque<nccl_net_ofi_rdma_send_comm_t *> *closing_s_comms;
+	std::deque<nccl_net_ofi_rdma_recv_comm_t *> *closing_r_comms;
+
 	/* thread id of the thread that called get_ep().  Used as the
 	   hash key for the endpoint hash */
 	long creating_thread_id;
@@ -811,12 +1273,22 @@ typedef struct nccl_net_ofi_rdma_device {
 	/* ID pool */
 	nccl_ofi_idpool_t *comm_idpool;
 
-	/* Array of open comms associated with this endpoint. This is needed for fast
-	   lookup of comms in the RDMA protocol. */
-	nccl_net_ofi_comm_t **comms;
+	/* Table of open comms associated with this endpoint, indexed by
+	   comm ID. This is needed for fast lookup of comms in the RDMA
+	   protocol. */
+	nccl_ofi_idtable_t *comm_table;
+
+	/* Serializes looking up listen communicators in `comm_table'
+	 * on connect message arrival with closing them */
+	pthread_mutex_t listen_comm_lock;
 
 	bool use_long_rkeys;
 
+	/* CPUs local to the NICs of this device. Used to pin domain
+	 * progress threads if `has_local_cpuset' is set. */
+	cpu_set_t local_cpuset;
+	bool has_local_cpuset;
+
 #if HAVE_NVTX_TRACING
 	nvtxDomainHandle_t nvtx_domain[MAX_NUM_RAILS];
 #endif
@@ -830,6 +1302,31 @@ typedef struct nccl_net_ofi_rdma_domain_rail {
 	struct fid_domain *domain;
 
 	struct fid_cq *cq;
+
+	/* Recent activity of this rail. Reset to RDMA_CQ_ACTIVE_POLLS
+	 * when a completion is read from `cq' or a locally initiated
+	 * operation is posted to the rail, and decremented by every
+	 * empty read of `cq'. ofi_process_cq() polls rails whose
+	 * activity decayed to zero at a lower frequency. Updated
+	 * atomically. */
+	uint32_t cq_activity;
+
+	/* Serializes reads of `cq' and protects the members below */
+	pthread_mutex_t cq_lock;
+
+	/* Current number of entries read per fi_cq_read() call, adapted
+	 * to the CQ occupancy */
+	size_t cq_read_count;
+
+	/* Upper bound of `cq_read_count' and capacity of `cqe_buffers' */
+	size_t cq_read_count_max;
+
+	/* Buffer for completion entries read from `cq' */
+	struct fi_cq_data_entry *cqe_buffers;
+
+	/* Number of fi_cq_read() calls on `cq' and of entries read */
+	uint64_t num_cq_reads;
+	uint64_t num_cq_entries;
 } nccl_net_ofi_rdma_domain_rail_t;
 
 
@@ -845,8 +1342,55 @@ typedef struct nccl_net_ofi_rdma_domain {
 	/* List of endpoints and set of addresses they have connections to */
 	nccl_ofi_ep_addr_list_t *ep_addr_list;
 
+	/* Receive-only endpoint owning the rx buffers shared by all
+	 * endpoints of this domain, or NULL if each endpoint posts its
+	 * own rx buffers (see RDMA_SHARED_RX). The rails of this
+	 * endpoint hold libfabric shared receive contexts instead of
+	 * endpoints. */
+	nccl_net_ofi_rdma_ep_t *shared_rx_ep;
+
+	/* Number of endpoints using `shared_rx_ep'. The rx buffer pool
+	 * of `shared_rx_ep' is sized for this many endpoints (see
+	 * RDMA_SHARED_RX_MAX_EPS). Updated atomically. */
+	size_t num_shared_rx_eps;
+
 	/* Message scheduler */
 	nccl_net_ofi_scheduler_t *scheduler;
+
+	/* Number of calls to ofi_process_cq() on this domain. Used to
+	 * poll idle rails at a lower frequency (see
+	 * CQ_IDLE_POLL_INTERVAL). Updated atomically. */
+	uint64_t cq_poll_count;
+
+	/* Dedicated progress thread (see PROGRESS_THREAD), valid if
+	 * `progress_thread_started' is set */
+	pthread_t progress_thread;
+	bool progress_thread_started;
+
+	/* Set to request the progress thread to exit. Accessed
+	 * atomically. */
+	bool progress_thread_stop;
+
+	/* Error that terminated the progress thread, or zero. Accessed
+	 * atomically. */
+	int progress_thread_error;
+
+	/* epoll instance watching the wait fds of all rail CQs, or -1
+	 * if the progress thread does not block (see
+	 * CQ_WAIT_SPIN_USEC) */
+	int cq_epoll_fd;
+
+	/* eventfd in the `cq_epoll_fd' set, signaled when a request is
+	 * added to a pending queue so that the progress thread retries
+	 * it without waiting for a completion, or -1 */
+	int progress_wake_fd;
+
+	/* Number of CQ entries read on this domain. Only maintained
+	 * if `cq_epoll_fd' is valid. Updated atomically. */
+	uint64_t num_cqes_read;
+
+	/* Time spent blocked by the progress thread in microseconds */
+	timer_histogram<histogram_custom_binner<std::size_t>> *progress_wait_histogram;
 } nccl_net_ofi_rdma_domain_t;
 
 
@@ -6,6 +6,7 @@
 #define NCCL_NET_OFI_TOPO_H_
 
 #include <hwloc.h>
+#include <sched.h>
 #include <rdma/fabric.h>
 
 /*
@@ -298,6 +299,26 @@ int nccl_ofi_topo_num_info_lists(nccl_ofi_topo_t *topo, int *num_lists);
  */
 struct fi_info *nccl_ofi_topo_next_info_list(nccl_ofi_topo_data_iterator_t *iter);
 
+/*
+ * @brief	Return the set of CPUs local to a NIC
+ *
+ * Look up the topology node of the NIC described by `info' and
+ * return the cpuset of its closest non-I/O ancestor, i.e., the cores
+ * of the package or NUMA node the NIC is attached to.
+ *
+ * @param	topo
+ *		NCCL OFI topology
+ * @param	info
+ *		Libfabric NIC info struct
+ * @param	cpuset
+ *		Output CPU set
+ * @return	0, on success
+ *		-ENOENT, if the NIC is not found in the topology
+ *		-EINVAL, on others
+ */
+int nccl_ofi_topo_get_nic_cpuset(nccl_ofi_topo_t *topo, struct fi_info *info,
+				 cpu_set_t *cpuset);
+
 /*
  * @brief	Dump NCCL topology into file
  *
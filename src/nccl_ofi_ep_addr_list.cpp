@@ -4,6 +4,9 @@
 
 #include "config.h"
 
+#include <cassert>
+#include <inttypes.h>
+
 #include "nccl_ofi_ep_addr_list.h"
 #include "nccl_ofi_log.h"
 
@@ -27,25 +30,59 @@ bool nccl_ofi_ep_addr_list_t::address_storage::operator==(const address_storage
 }
 
 
+void nccl_ofi_ep_addr_list_t::connect(endpoint_map::iterator ep_iter,
+				      address_index::iterator addr_iter)
+{
+	addr_iter->second.eps.insert(ep_iter->first);
+	ep_iter->second.addresses.push_back(&addr_iter->first);
+}
+
+
 int nccl_ofi_ep_addr_list_t::get(const void *addr_in, size_t addr_size, nccl_net_ofi_ep_t **ep)
 {
 	address_storage remote_address = address_storage(addr_in, addr_size);
 	std::lock_guard l(lock);
 
-        *ep = NULL;
+	*ep = NULL;
+
+	if (endpoints.empty()) {
+		return 0;
+	}
 
-	for (auto ep_iter = endpoints.begin() ; ep_iter != endpoints.end() ; ++ep_iter) {
-		if (0 == ep_iter->second.count(remote_address)) {
-			/* found one that works */
-			*ep = ep_iter->first;
+	auto addr_iter = addresses.find(remote_address);
+	if (addr_iter == addresses.end()) {
+		addr_iter = addresses.emplace(remote_address, address_entry{{}, 0}).first;
+	}
+	address_entry &entry = addr_iter->second;
 
-			ep_iter->second.emplace(remote_address);
+	if (entry.eps.size() == endpoints.size()) {
+		/* All endpoints are connected to addr */
+		return 0;
+	}
 
-                        return 0;
-		}
+	/* The first endpoint at or after the cursor that is not
+	   connected to addr. Endpoints skipped here are connected to
+	   addr and fall behind the cursor, so they are not visited
+	   again. */
+	auto order_iter = endpoint_order.lower_bound(entry.cursor);
+	while (order_iter != endpoint_order.end() &&
+	       entry.eps.count(order_iter->second) != 0) {
+		++order_iter;
+	}
+	if (OFI_UNLIKELY(order_iter == endpoint_order.end())) {
+		/* An endpoint not connected to addr lies behind the
+		   cursor, which insert() and remove() never allow */
+		NCCL_OFI_WARN("Endpoint list out of order: no unconnected endpoint after cursor %" PRIu64,
+			      entry.cursor);
+		return -EINVAL;
 	}
+	entry.cursor = order_iter->first + 1;
 
-        return 0;
+	/* found one that works */
+	*ep = order_iter->second;
+	connect(endpoints.find(*ep), addr_iter);
+
+	return 0;
 }
 
 
@@ -61,19 +98,21 @@ int nccl_ofi_ep_addr_list_t::insert(nccl_net_ofi_ep_t *ep, const void *addr_in,
 		return -EINVAL;
 	}
 
-	auto ep_ret = endpoints.emplace(ep, address_set());
+	auto ep_ret = endpoints.emplace(ep, endpoint_entry{next_seq, {}});
 	if (!ep_ret.second) {
 		NCCL_OFI_WARN("Failed to insert new endpoint");
 		return -EINVAL;
 	}
-
-	auto endpoints_iter = ep_ret.first;
-	auto addr_ret = endpoints_iter->second.emplace(remote_address);
-	if (!addr_ret.second) {
-		NCCL_OFI_WARN("Failed to insert address in new endpoint");
-		endpoints.erase(ep_ret.first);
-		return -EINVAL;
+	endpoint_order.emplace(next_seq, ep);
+	++next_seq;
+
+	/* The new endpoint has the highest sequence number, so it is
+	   at or after the cursor of every address */
+	auto addr_iter = addresses.find(remote_address);
+	if (addr_iter == addresses.end()) {
+		addr_iter = addresses.emplace(remote_address, address_entry{{}, 0}).first;
 	}
+	connect(ep_ret.first, addr_iter);
 
 	return 0;
 }
@@ -83,5 +122,22 @@ int nccl_ofi_ep_addr_list_t::remove(nccl_net_ofi_ep_t *ep)
 {
 	std::lock_guard l(lock);
 
-	return (endpoints.erase(ep) == 0) ? -ENOENT : 0;
+	auto ep_iter = endpoints.find(ep);
+	if (ep_iter == endpoints.end()) {
+		return -ENOENT;
+	}
+
+	for (const address_storage *addr : ep_iter->second.addresses) {
+		auto addr_iter = addresses.find(*addr);
+		assert(addr_iter != addresses.end());
+		addr_iter->second.eps.erase(ep);
+		if (addr_iter->second.eps.empty()) {
+			addresses.erase(addr_iter);
+		}
+	}
+
+	endpoint_order.erase(ep_iter->second.seq);
+	endpoints.erase(ep_iter);
+
+	return 0;
 }
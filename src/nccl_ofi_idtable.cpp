@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2025 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+#include "config.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+#include "nccl_ofi_idtable.h"
+#include "nccl_ofi_math.h"
+#include "nccl_ofi_log.h"
+
+
+nccl_ofi_idtable_t::nccl_ofi_idtable_t(size_t size_arg) :
+	size(size_arg),
+	num_leaves(0)
+{
+	dir.assign(NCCL_OFI_DIV_CEIL(size, leaf_size), NULL);
+}
+
+
+nccl_ofi_idtable_t::~nccl_ofi_idtable_t()
+{
+	for (void **leaf : dir) {
+		free(leaf);
+	}
+}
+
+
+int nccl_ofi_idtable_t::set(size_t id, void *ptr)
+{
+	assert(id < size);
+
+	size_t dir_idx = id >> leaf_bits;
+	void **leaf = __atomic_load_n(&dir[dir_idx], __ATOMIC_ACQUIRE);
+
+	if (leaf == NULL) {
+		if (ptr == NULL) {
+			/* Nothing stored in this range */
+			return 0;
+		}
+
+		std::lock_guard<std::mutex> l(lock);
+
+		leaf = dir[dir_idx];
+		if (leaf == NULL) {
+			leaf = (void **)calloc(leaf_size, sizeof(void *));
+			if (OFI_UNLIKELY(leaf == NULL)) {
+				NCCL_OFI_WARN("Unable to allocate ID table leaf for ID %zu", id);
+				return -ENOMEM;
+			}
+			/* Publish the zeroed leaf to lock-free readers */
+			__atomic_store_n(&dir[dir_idx], leaf, __ATOMIC_RELEASE);
+			++num_leaves;
+		}
+	}
+
+	__atomic_store_n(&leaf[id & (leaf_size - 1)], ptr, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+
+size_t nccl_ofi_idtable_t::get_num_leaves()
+{
+	std::lock_guard<std::mutex> l(lock);
+	return num_leaves;
+}
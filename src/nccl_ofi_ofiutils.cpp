@@ -220,7 +220,8 @@ int nccl_ofi_ofiutils_get_providers(const char *prov_include,
 
 
 int nccl_ofi_ofiutils_init_connection(struct fi_info *info, struct fid_domain *domain,
-				      struct fid_ep **ep, struct fid_av **av, struct fid_cq *cq)
+				      struct fid_ep **ep, struct fid_av **av, struct fid_cq *cq,
+				      struct fid_ep *srx)
 {
 	int ret = 0;
 	struct fi_av_attr av_attr = {};
@@ -257,6 +258,16 @@ int nccl_ofi_ofiutils_init_connection(struct fi_info *info, struct fid_domain *d
 		goto error;
 	}
 
+	/* Bind shared receive context to endpoint */
+	if (srx != NULL) {
+		ret = fi_ep_bind(*ep, &(srx->fid), 0);
+		if (OFI_UNLIKELY(ret != 0)) {
+			NCCL_OFI_WARN("Couldn't bind EP-SRX. RC: %d, ERROR: %s",
+				      ret, fi_strerror(-ret));
+			goto error;
+		}
+	}
+
 	/*
 	 * Disable shared memory.  There's really only three cases
 	 * we're going to be using network operations inside a shared
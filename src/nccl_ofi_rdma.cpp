@@ -4,11 +4,16 @@
 #include "config.h"
 
 #include <algorithm>
+#include <chrono>
 #include <deque>
+#include <unordered_set>
+#include <vector>
 
 #include <assert.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #include <pthread.h>
@@ -35,70 +40,70 @@
 /* Message buffer size -- maximum span of simultaneous inflight messages */
 #define NCCL_OFI_RDMA_MSGBUFF_SIZE 256
 
-/* Maximum number of comms open simultaneously. Eventually this will be
-   runtime-expandable */
-#define NCCL_OFI_RDMA_MAX_COMMS    (1 << NCCL_OFI_RDMA_COMM_ID_BITS)
+/* Maximum time a blocking progress thread waits for a completion
+ * before it checks whether it has been asked to stop */
+#define RDMA_PROGRESS_WAIT_TIMEOUT_MS 100
+/* Sleep time of the progress thread while its domain has no endpoint */
+#define RDMA_PROGRESS_IDLE_SLEEP_US 1000
+/* Sleep time of an idle progress thread between two polls of CQs
+ * without wait objects */
+#define RDMA_PROGRESS_POLL_BACKOFF_US 50
 
-/*
- * @brief	Number of bits used for number of segments value
- */
-#define NUM_NUM_SEG_BITS ((uint64_t)4)
+/* Number of consecutive empty reads of the CQ of a domain rail after
+ * the last completion or post on the rail before the rail is considered
+ * idle and only polled every CQ_IDLE_POLL_INTERVAL progress calls */
+#define RDMA_CQ_ACTIVE_POLLS 256
 
-/*
- * @brief	Communicator ID bitmask
- */
-#define COMM_ID_MASK               (((uint64_t)1 << NCCL_OFI_RDMA_COMM_ID_BITS) - 1)
+/* Number of rx buffer reposts of a rail in between two checks of the
+ * clock for the end of its rx buffer tuning epoch */
+#define RDMA_RX_BUFF_TUNE_CLOCK_STRIDE 32
 
-/*
- * @brief	Signifier for an invalid Communicator ID
- */
-#define COMM_ID_INVALID            (COMM_ID_MASK)
+/* Maximum number of comms open simultaneously. Local communicator IDs
+ * must fit the comm ID of the immediate data. */
+#define NCCL_OFI_RDMA_MAX_COMMS    (1 << NCCL_OFI_RDMA_IMM_COMM_ID_BITS)
 
-/*
- * @brief	Message sequence number bitmask for immediate data
- */
-#define MSG_SEQ_NUM_MASK (((uint64_t)1 << NCCL_OFI_RDMA_SEQ_BITS) - 1)
+/* Communicator IDs of protocol version 1 peers may use all
+ * NCCL_OFI_RDMA_COMM_ID_BITS bits */
+#define NCCL_OFI_RDMA_MAX_REMOTE_COMMS (1 << NCCL_OFI_RDMA_COMM_ID_BITS)
 
-/*
- * @brief	Number of segments bitmask for immediate data
- */
-#define MSG_NUM_SEG_MASK (((uint64_t)1 << NUM_NUM_SEG_BITS) - 1)
+/* The schedulers stripe a message over at most one segment per rail */
+static_assert(MAX_NUM_RAILS <= NCCL_OFI_RDMA_MAX_NUM_SEGMS_V1,
+	      "Immediate data cannot encode a segment per rail");
 
 /*
- * @brief	Extract communicator ID from write completion immediate data
- *
- * The immediate data bit format is documented in the definition of NCCL_OFI_RDMA_SEQ_BITS
+ * @brief	Communicator ID bitmask
  */
-#define GET_COMM_ID_FROM_IMM(data) (((data) >> NCCL_OFI_RDMA_SEQ_BITS) & COMM_ID_MASK)
+#define COMM_ID_MASK               (((uint64_t)1 << NCCL_OFI_RDMA_COMM_ID_BITS) - 1)
 
 /*
- * @brief	Extract message sequence number from write completion immediate data
- *
- * The immediate data bit format is documented in the definition of NCCL_OFI_RDMA_SEQ_BITS
+ * @brief	Signifier for an invalid Communicator ID
  */
-#define GET_SEQ_NUM_FROM_IMM(data) ((data) & MSG_SEQ_NUM_MASK)
+#define COMM_ID_INVALID            (COMM_ID_MASK)
 
 /*
- * @brief	Extract number of segments from write completion immediate data
+ * @brief	Maximum number of consecutive operations posted with FI_MORE
+ *		while draining a pending requests queue
  *
- * The immediate data bit format is documented in the definition of NCCL_OFI_RDMA_SEQ_BITS
+ * Bounds the number of operations a provider may hold back, so that a
+ * batch never fills a provider queue with operations that were not
+ * submitted yet.
  */
-#define GET_NUM_SEG_FROM_IMM(data) (((data) >> (NCCL_OFI_RDMA_SEQ_BITS + NCCL_OFI_RDMA_COMM_ID_BITS)) & MSG_NUM_SEG_MASK)
+#define NCCL_OFI_RDMA_MAX_FI_MORE_BATCH (16)
 
 /*
- * @brief	Build write completion immediate data from comm ID, message seq
- *		number and number of segments used to transfer RDMA write
- *
- * The immediate data bit format is documented in the definition of NCCL_OFI_RDMA_SEQ_BITS
+ * Maximum number of endpoint names resolved by one call to
+ * rdma_ep_rail_av_insert(): the remote and the local name of a receive
+ * communicator rail.
  */
-#define GET_RDMA_WRITE_IMM_DATA(comm_id, seq, nseg) \
-	((seq) | ((comm_id) << NCCL_OFI_RDMA_SEQ_BITS) | ((nseg) << (NCCL_OFI_RDMA_SEQ_BITS + NCCL_OFI_RDMA_COMM_ID_BITS)))
+#define NCCL_OFI_RDMA_MAX_AV_INSERT (2)
 
 /** Global variables **/
 
-/* List of comms undergoing deferred cleanup */
-static std::deque<nccl_net_ofi_rdma_send_comm_t*> *s_comm_cleanup_list = NULL;
-static std::deque<nccl_net_ofi_rdma_recv_comm_t*> *r_comm_cleanup_list = NULL;
+/* List of endpoints with comms undergoing deferred cleanup. The
+ * comms are queued on their endpoint (see closing_s_comms and
+ * closing_r_comms), so that the CQs of an endpoint are polled once
+ * per sweep regardless of the number of comms closing on it. */
+static std::deque<nccl_net_ofi_rdma_ep_t*> *closing_ep_list = NULL;
 static pthread_mutex_t comm_cleanup_list_lock = PTHREAD_MUTEX_INITIALIZER;
 /* Number of open (not finalizing) send and recv comms */
 static int num_open_comms = 0;
@@ -110,13 +115,22 @@ static bool is_max_write_inline_size_initialized = false;
 /* CPU cache line size */
 static ssize_t cpu_cache_line_size;
 
+/* Bytes of rx buffers targeted to be posted by all endpoint rails
+ * (see RDMA_RX_BUFF_MEM_BUDGET) */
+static size_t rx_buff_mem_used = 0;
+
 static bool early_completion = false;
 
 /* Function prototypes */
-static int send_progress(nccl_net_ofi_rdma_req_t *req);
+static int send_progress(nccl_net_ofi_rdma_req_t *req, bool set_fi_more);
+
+static int post_rdma_send_data(nccl_net_ofi_rdma_req_t *req, bool set_fi_more);
 
 static int receive_progress(nccl_net_ofi_rdma_req_t *req, bool add_to_pending);
 
+static int ofi_process_cq_rail(nccl_net_ofi_rdma_device_t *device, nccl_net_ofi_rdma_domain_rail_t *rail,
+			       size_t *num_cqes);
+
 static int post_rx_buffs_on_rail(nccl_net_ofi_rdma_ep_t *ep, nccl_net_ofi_ep_rail_t *rail);
 
 static inline int repost_rx_buff(nccl_net_ofi_rdma_ep_t *ep,
@@ -133,8 +147,19 @@ static inline int free_base_req(uint64_t *num_inflight_reqs,
 				nccl_net_ofi_rdma_req_t *req,
 				bool dec_inflight_reqs);
 
+static nccl_net_ofi_rdma_req_t *allocate_comm_req(nccl_net_ofi_rdma_comm_reqs_t *reqs);
+
+static inline int free_comm_req(uint64_t *num_inflight_reqs,
+				nccl_net_ofi_rdma_comm_reqs_t *reqs,
+				nccl_net_ofi_rdma_req_t *req,
+				bool dec_inflight_reqs);
+
 static inline int check_post_rx_buff_req(nccl_net_ofi_rdma_req_t *rx_buff_req);
 
+static inline int put_rx_buff_msg(nccl_net_ofi_rdma_req_t *rx_buff_req);
+
+static int rdma_recv_comm_activate_rails(nccl_net_ofi_rdma_recv_comm_t *r_comm);
+
 
 static nccl_net_ofi_rdma_domain_t *rdma_endpoint_get_domain(nccl_net_ofi_rdma_ep_t *ep)
 {
@@ -159,6 +184,15 @@ static nccl_net_ofi_rdma_plugin_t *rdma_device_get_plugin(nccl_net_ofi_rdma_devi
 	return (nccl_net_ofi_rdma_plugin_t*)device->base.plugin;
 }
 
+/*
+ * @brief	Return the current time of a monotonic clock in microseconds
+ */
+static inline uint64_t rdma_time_now_us(void)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 /*
  * @brief	Get endpoint communicator with given ID
  */
@@ -166,29 +200,42 @@ static inline nccl_net_ofi_comm_t *rdma_device_get_comm(nccl_net_ofi_rdma_device
 {
 	assert(local_comm_id < NCCL_OFI_RDMA_MAX_COMMS);
 	assert(local_comm_id < device->num_comm_ids);
-	return device->comms[local_comm_id];
+	return (nccl_net_ofi_comm_t *)device->comm_table->get(local_comm_id);
 }
 
 /*
  * @brief	Set endpoint communicator with given ID
+ *
+ * @return	0, on success
+ *		-ENOMEM, if the lookup table could not be extended
  */
-static inline void rdma_device_set_comm(nccl_net_ofi_rdma_device_t *device,
+static inline int rdma_device_set_comm(nccl_net_ofi_rdma_device_t *device,
 			    uint32_t local_comm_id,
 			    nccl_net_ofi_comm_t *comm)
 {
 	assert(local_comm_id < NCCL_OFI_RDMA_MAX_COMMS);
 	assert(local_comm_id < device->num_comm_ids);
-	device->comms[local_comm_id] = comm;
+	return device->comm_table->set(local_comm_id, comm);
 }
 
 /*
  * @brief	Get endpoint listen communicator with given comm_id
+ *
+ * Connect messages may still arrive for a listen communicator that
+ * was closed, so the lookup may fail. Caller must hold
+ * device->listen_comm_lock and keep holding it while using the
+ * communicator.
+ *
+ * @return	listen communicator, if one with this ID is open
+ *		NULL, otherwise
  */
 static inline nccl_net_ofi_rdma_listen_comm_t *rdma_device_get_listen_comm(nccl_net_ofi_rdma_device_t *device, uint32_t local_comm_id)
 {
-	nccl_net_ofi_rdma_listen_comm_t *l_comm = (nccl_net_ofi_rdma_listen_comm_t *)rdma_device_get_comm(device, local_comm_id);
-	assert(l_comm->base.base.type == NCCL_NET_OFI_LISTEN_COMM);
-	return l_comm;
+	nccl_net_ofi_comm_t *comm = rdma_device_get_comm(device, local_comm_id);
+	if (comm == NULL || comm->type != NCCL_NET_OFI_LISTEN_COMM) {
+		return NULL;
+	}
+	return (nccl_net_ofi_rdma_listen_comm_t *)comm;
 }
 
 /*
@@ -224,7 +271,7 @@ static inline nccl_net_ofi_rdma_recv_comm_t *rdma_device_get_recv_comm(nccl_net_
 static inline nccl_ofi_rdma_connection_info_t *get_rx_connection_msg(
 	rdma_req_rx_buff_data_t *rx_buff_data)
 {
-	return (nccl_ofi_rdma_connection_info_t *)rx_buff_data->rx_buff_fl_elem->ptr;
+	return (nccl_ofi_rdma_connection_info_t *)rx_buff_data->buff;
 }
 
 /*
@@ -233,7 +280,7 @@ static inline nccl_ofi_rdma_connection_info_t *get_rx_connection_msg(
 static inline nccl_net_ofi_rdma_ctrl_msg_t *get_rx_ctrl_msg
 	(rdma_req_rx_buff_data_t *rx_buff_data)
 {
-	return (nccl_net_ofi_rdma_ctrl_msg_t *)rx_buff_data->rx_buff_fl_elem->ptr;
+	return (nccl_net_ofi_rdma_ctrl_msg_t *)rx_buff_data->buff;
 }
 
 /*
@@ -243,7 +290,7 @@ static inline nccl_net_ofi_rdma_close_msg_t *rx_get_close_msg
 	(rdma_req_rx_buff_data_t *rx_buff_data)
 {
 	nccl_net_ofi_rdma_close_msg_t *close_msg =
-		(nccl_net_ofi_rdma_close_msg_t *)rx_buff_data->rx_buff_fl_elem->ptr;
+		(nccl_net_ofi_rdma_close_msg_t *)rx_buff_data->buff;
 	assert(close_msg->type == NCCL_OFI_RDMA_MSG_CLOSE);
 	return close_msg;
 }
@@ -360,6 +407,44 @@ static inline nccl_net_ofi_ep_rail_t *rdma_endpoint_get_control_rail(nccl_net_of
 	return &ep->control_rails[rail_id];
 }
 
+/*
+ * @brief	Return size of the ctrl or eager rx buffers of endpoint
+ *		`ep' receiving messages of up to `msg_size' bytes
+ */
+static inline size_t rdma_ep_rx_buff_alloc_size(nccl_net_ofi_rdma_ep_t *ep, size_t msg_size)
+{
+	return (ep->multi_recv_msgs > 0) ? msg_size * ep->multi_recv_msgs : msg_size;
+}
+
+/*
+ * @brief	Return number of rx buffers of endpoint `ep' needed to
+ *		receive `num_msgs' messages
+ */
+static inline size_t rdma_ep_rx_buff_count(nccl_net_ofi_rdma_ep_t *ep, size_t num_msgs)
+{
+	if (ep->multi_recv_msgs == 0) {
+		return num_msgs;
+	}
+
+	/* Keep a second slab posted while the first one drains */
+	return std::max(NCCL_OFI_DIV_CEIL(num_msgs, ep->multi_recv_msgs), (size_t)2);
+}
+
+/*
+ * @brief	Mark rail `rail_id' of the domain of endpoint `ep' as
+ *		active after a locally initiated operation was posted to it
+ *
+ * The completion of the operation is expected on the CQ of the rail,
+ * so the rail is polled on every progress call until its activity
+ * decays, see ofi_process_cq().
+ */
+static inline void rdma_ep_mark_rail_active(nccl_net_ofi_rdma_ep_t *ep, uint16_t rail_id)
+{
+	nccl_net_ofi_rdma_domain_rail_t *rail =
+		rdma_domain_get_rail(rdma_endpoint_get_domain(ep), rail_id);
+	__atomic_store_n(&rail->cq_activity, RDMA_CQ_ACTIVE_POLLS, __ATOMIC_RELAXED);
+}
+
 /*
  * @brief	Write topology to NCCL topology file
  *
@@ -487,6 +572,12 @@ static int set_mr_req_attr(uint64_t mr_key,
 	mr_attr->access |= (FI_WRITE | FI_REMOTE_WRITE);
 	nccl_ofi_mr_ckey_fill_mr_attrs(ckey, mr_attr, flags);
 
+	/* Add FI_READ (sink of fi_read) for receivers pulling messages
+	   into device buffers */
+	if (ofi_nccl_rdma_pull_min_size() >= 0) {
+		mr_attr->access |= FI_READ;
+	}
+
 	switch (type) {
 	case NCCL_PTR_HOST:
 		mr_attr->access |= FI_READ;
@@ -619,6 +710,19 @@ static inline rdma_req_send_data_t *get_send_data(nccl_net_ofi_rdma_req_t *req)
 	return &req->send_data;
 }
 
+/*
+ * @brief	Return true if the next operation of send request
+ *		`send_data' is its pull message, false if it is a write
+ *
+ * The schedule and remote buffer of a pull send may only be read once
+ * this returned false.
+ */
+static inline bool rdma_send_data_pull_msg_pending(rdma_req_send_data_t *send_data)
+{
+	return send_data->pull &&
+		__atomic_load_n(&send_data->pull_state, __ATOMIC_ACQUIRE) != NCCL_OFI_RDMA_PULL_WRITES;
+}
+
 /*
  * @brief	Return recv data struct of recv request
  */
@@ -667,23 +771,187 @@ static inline rdma_req_flush_data_t *get_flush_data(nccl_net_ofi_rdma_req_t *req
 	return &req->flush_data;
 }
 
+/*
+ * @brief	Return the endpoint rail whose pending requests queue holds
+ *		`req' while the network is busy
+ *
+ * A request is queued on the rail of the next network operation it
+ * has to post. Send requests striped over multiple rails resume from
+ * `xferred_rail_id'.
+ */
+static inline nccl_net_ofi_ep_rail_t *rdma_req_get_pending_rail(nccl_net_ofi_rdma_ep_t *ep,
+								 nccl_net_ofi_rdma_req_t *req)
+{
+	switch (req->type) {
+	case NCCL_OFI_RDMA_SEND: {
+		rdma_req_send_data_t *send_data = get_send_data(req);
+		if (rdma_send_data_pull_msg_pending(send_data)) {
+			/* Pull message is injected on the first control rail */
+			return rdma_endpoint_get_control_rail(ep, 0);
+		}
+		nccl_net_ofi_schedule_t *schedule = send_data->schedule;
+		uint16_t xfer_id = send_data->eager ? 0 : send_data->xferred_rail_id;
+		if (schedule != NULL && xfer_id < schedule->num_xfer_infos) {
+			return rdma_endpoint_get_rail(ep, schedule->rail_xfer_infos[xfer_id].rail_id);
+		}
+		return rdma_endpoint_get_rail(ep, 0);
+	}
+	case NCCL_OFI_RDMA_CTRL_RX_BUFF:
+	case NCCL_OFI_RDMA_EAGER_RX_BUFF:
+		return get_rx_buff_data(req)->rail;
+	case NCCL_OFI_RDMA_SEND_CTRL: {
+		nccl_net_ofi_schedule_t *schedule = get_send_ctrl_data(req)->ctrl_schedule;
+		uint16_t rail_id = (schedule != NULL) ? schedule->rail_xfer_infos[0].rail_id : 0;
+		return rdma_endpoint_get_control_rail(ep, rail_id);
+	}
+	case NCCL_OFI_RDMA_SEND_CLOSE:
+		return rdma_endpoint_get_control_rail(ep, 0);
+	case NCCL_OFI_RDMA_EAGER_COPY: {
+		nccl_net_ofi_rdma_req_t *rx_buff_req = get_eager_copy_data(req)->eager_rx_buff_req;
+		return rdma_endpoint_get_rail(ep, get_rx_buff_data(rx_buff_req)->rail->rail_id);
+	}
+	case NCCL_OFI_RDMA_READ: {
+		rdma_req_rma_op_data_t *rma_op_data = req_get_rma_op_data(req, NCCL_OFI_RDMA_READ);
+		nccl_net_ofi_schedule_t *schedule = rma_op_data->schedule;
+		if (schedule != NULL && rma_op_data->xferred_rail_id < schedule->num_xfer_infos) {
+			return rdma_endpoint_get_rail(ep, schedule->rail_xfer_infos[rma_op_data->xferred_rail_id].rail_id);
+		}
+		return rdma_endpoint_get_rail(ep, 0);
+	}
+	case NCCL_OFI_RDMA_WRITE:
+	case NCCL_OFI_RDMA_FLUSH:
+	default:
+		return rdma_endpoint_get_rail(ep, 0);
+	}
+}
+
+/*
+ * @brief	Add request to the pending requests queue of the rail it
+ *		targets, to be retried by process_pending_reqs()
+ */
+static inline void rdma_ep_add_pending_req(nccl_net_ofi_rdma_ep_t *ep,
+					   nccl_net_ofi_rdma_req_t *req)
+{
+	nccl_net_ofi_ep_rail_t *rail = rdma_req_get_pending_rail(ep, req);
+
+	nccl_net_ofi_mutex_lock(&rail->pending_reqs_lock);
+	rail->pending_reqs_queue->push_back(req);
+	__atomic_fetch_add(&ep->num_pending_reqs, 1, __ATOMIC_RELEASE);
+	nccl_net_ofi_mutex_unlock(&rail->pending_reqs_lock);
+
+	/* Wake up the progress thread if it may be blocked on the CQs.
+	 * A full counter already wakes it up, so errors are ignored. */
+	int wake_fd = rdma_endpoint_get_domain(ep)->progress_wake_fd;
+	if (wake_fd >= 0) {
+		(void)eventfd_write(wake_fd, 1);
+	}
+}
+
+/*
+ * @brief	Return true if any rail of the endpoint has pending requests
+ *
+ * Reads the pending request counter of the endpoint and does not take
+ * the locks of the rail queues, so that it is cheap to call on every
+ * send() and recv().
+ */
+static inline bool rdma_ep_has_pending_reqs(nccl_net_ofi_rdma_ep_t *ep)
+{
+	return __atomic_load_n(&ep->num_pending_reqs, __ATOMIC_ACQUIRE) > 0;
+}
+
+/*
+ * @brief	Return state of request
+ *
+ * Pairs with the release store of rdma_req_set_state(), so that all
+ * updates of the request made before it completed (e.g., `size') are
+ * visible to the caller once the completed state is observed.
+ */
+static inline nccl_net_ofi_rdma_req_state_t rdma_req_get_state(nccl_net_ofi_rdma_req_t *req)
+{
+	return __atomic_load_n(&req->state, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * @brief	Set state of request with release semantics
+ */
+static inline void rdma_req_set_state(nccl_net_ofi_rdma_req_t *req,
+				      nccl_net_ofi_rdma_req_state_t state)
+{
+	__atomic_store_n(&req->state, state, __ATOMIC_RELEASE);
+}
+
+/*
+ * @brief	Set state of request to completed unless the request
+ *		already tracks an error
+ */
+static inline void rdma_req_set_completed(nccl_net_ofi_rdma_req_t *req)
+{
+	nccl_net_ofi_rdma_req_state_t state = __atomic_load_n(&req->state, __ATOMIC_RELAXED);
+
+	while (OFI_LIKELY(state != NCCL_OFI_RDMA_REQ_ERROR)) {
+		if (__atomic_compare_exchange_n(&req->state, &state, NCCL_OFI_RDMA_REQ_COMPLETED,
+						false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+			break;
+		}
+	}
+}
+
+/*
+ * @brief	Stop flush requests from joining flush read `req' and
+ *		return the list of flush requests that joined it
+ */
+static inline nccl_net_ofi_rdma_req_t *rdma_flush_detach_joined(nccl_net_ofi_rdma_req_t *req)
+{
+	nccl_net_ofi_rdma_recv_comm_t *r_comm = (nccl_net_ofi_rdma_recv_comm_t *)req->comm;
+	rdma_req_flush_data_t *flush_data = get_flush_data(req);
+
+	nccl_net_ofi_mutex_lock(&r_comm->flush_lock);
+	if (r_comm->inflight_flush == req) {
+		r_comm->inflight_flush = NULL;
+	}
+	nccl_net_ofi_rdma_req_t *joined = flush_data->joined_head;
+	flush_data->joined_head = NULL;
+	nccl_net_ofi_mutex_unlock(&r_comm->flush_lock);
+
+	return joined;
+}
+
+/*
+ * @brief	Set state of the flush requests that joined flush read
+ *		`req' to error
+ */
+static inline void rdma_flush_fail_joined(nccl_net_ofi_rdma_req_t *req)
+{
+	nccl_net_ofi_rdma_req_t *joined = rdma_flush_detach_joined(req);
+
+	while (joined != NULL) {
+		nccl_net_ofi_rdma_req_t *next = get_flush_data(joined)->joined_next;
+		rdma_req_set_state(joined, NCCL_OFI_RDMA_REQ_ERROR);
+		joined = next;
+	}
+}
+
 /*
  * @brief	Set state of request and potential parent requests to error
  *
+ * Flush requests that joined a failed flush read fail with it.
+ *
  * @param	req
  *		The request
  */
 static inline void set_request_state_to_error(nccl_net_ofi_rdma_req_t *req)
 {
-	req->state = NCCL_OFI_RDMA_REQ_ERROR;
+	rdma_req_set_state(req, NCCL_OFI_RDMA_REQ_ERROR);
 
 	/* Set state of parent requests to error as well */
 	if (req->type == NCCL_OFI_RDMA_SEND_CTRL) {
 		rdma_req_send_ctrl_data_t *send_ctrl_data = get_send_ctrl_data(req);
-		send_ctrl_data->recv_req->state = NCCL_OFI_RDMA_REQ_ERROR;
+		rdma_req_set_state(send_ctrl_data->recv_req, NCCL_OFI_RDMA_REQ_ERROR);
 	} else if (req->type == NCCL_OFI_RDMA_RECV_SEGMS) {
 		rdma_req_recv_segms_data_t *recv_segms_data = get_recv_segms_data(req);
-		recv_segms_data->recv_req->state = NCCL_OFI_RDMA_REQ_ERROR;
+		rdma_req_set_state(recv_segms_data->recv_req, NCCL_OFI_RDMA_REQ_ERROR);
+	} else if (req->type == NCCL_OFI_RDMA_FLUSH) {
+		rdma_flush_fail_joined(req);
 	}
 }
 
@@ -694,7 +962,12 @@ static inline void set_request_state_to_error(nccl_net_ofi_rdma_req_t *req)
  * Note that the request state is only updated if the request state
  * does not track an error already.
  *
- * This function is guarded by the request lock.
+ * Completions of a request may be processed concurrently (e.g., on
+ * multiple rails), so `size' and `ncompls' are updated with atomic
+ * operations instead of taking a lock. The acquire-release increment
+ * of `ncompls' orders all previous size updates before the thread
+ * that observes the last completion, which then publishes the
+ * completed state with release semantics.
  *
  * To update the state of subrequests, use the subrequest specific
  * update functions.
@@ -711,26 +984,21 @@ static inline void set_request_state_to_error(nccl_net_ofi_rdma_req_t *req)
 static inline int inc_req_completion(nccl_net_ofi_rdma_req_t *req,
 				     size_t size, int total_ncompls)
 {
-	int ret = 0;
-	int ncompls;
-	nccl_net_ofi_mutex_lock(&req->req_lock);
-
-	req->size += size;
-	ncompls = ++(req->ncompls);
+	if (size != 0) {
+		__atomic_fetch_add(&req->size, size, __ATOMIC_RELAXED);
+	}
+	int ncompls = __atomic_add_fetch(&req->ncompls, 1, __ATOMIC_ACQ_REL);
 
 	/* Set state to completed if all completions arrived but avoid
-	 * overriding the state in case of previs errors */
-	if (ncompls == total_ncompls &&
-	    OFI_LIKELY(req->state != NCCL_OFI_RDMA_REQ_ERROR)) {
-		req->state = NCCL_OFI_RDMA_REQ_COMPLETED;
+	 * overriding the state in case of previous errors */
+	if (ncompls == total_ncompls) {
+		rdma_req_set_completed(req);
 
 		/* Trace this completion */
 		NCCL_OFI_TRACE_COMPLETIONS(req->dev_id, req, req);
 	}
 
-	nccl_net_ofi_mutex_unlock(&req->req_lock);
-
-	return -ret;
+	return 0;
 }
 
 /*
@@ -739,10 +1007,6 @@ static inline int inc_req_completion(nccl_net_ofi_rdma_req_t *req,
  * Set eager copy ctrl request to completed. Furthermore, increment
  * completions of parent request (receive request).
  *
- * Modifications of the eager copy request are guarded by the eager copy req's
- * lock.  Modifications of the receive request are guarded by the receive
- * request's lock.
- *
  * @param	req
  *		Eager copy request
  *		size
@@ -758,13 +1022,9 @@ static inline int set_eager_copy_completed(nccl_net_ofi_rdma_req_t *req)
 	nccl_net_ofi_rdma_req_t *recv_req = eager_copy_data->recv_req;
 	rdma_req_recv_data_t *recv_data = get_recv_data(recv_req);
 
-	nccl_net_ofi_mutex_lock(&req->req_lock);
-
-	/* Set send ctrl request completed */
+	/* Set eager copy request completed */
 	req->ncompls = 1;
-	req->state = NCCL_OFI_RDMA_REQ_COMPLETED;
-
-	nccl_net_ofi_mutex_unlock(&req->req_lock);
+	rdma_req_set_state(req, NCCL_OFI_RDMA_REQ_COMPLETED);
 
 	/* Get size of received data */
 	rdma_req_rx_buff_data_t *rx_buff_data = get_rx_buff_data(eager_copy_data->eager_rx_buff_req);
@@ -789,10 +1049,6 @@ static inline int set_eager_copy_completed(nccl_net_ofi_rdma_req_t *req)
  * Set send ctrl request to completed. Furthermore, increment
  * completions of parent request (receive request).
  *
- * Modifications of the send control request are guarded by the send
- * control request's lock.  Modifications of the receive request are
- * guarded by the receive request's lock.
- *
  * @param	req
  *		Send ctrl request
  * @return	0, on success
@@ -809,13 +1065,9 @@ static inline int set_send_ctrl_completed(nccl_net_ofi_rdma_req_t *req)
 	nccl_net_ofi_rdma_recv_comm_t *r_comm =
 		(nccl_net_ofi_rdma_recv_comm_t *)req->comm;
 
-	nccl_net_ofi_mutex_lock(&req->req_lock);
-
 	/* Set send ctrl request completed */
 	req->ncompls = 1;
-	req->state = NCCL_OFI_RDMA_REQ_COMPLETED;
-
-	nccl_net_ofi_mutex_unlock(&req->req_lock);
+	rdma_req_set_state(req, NCCL_OFI_RDMA_REQ_COMPLETED);
 
 	nccl_net_ofi_mutex_lock(&r_comm->ctrl_counter_lock);
 	r_comm->n_ctrl_delivered += 1;
@@ -832,9 +1084,10 @@ static inline int set_send_ctrl_completed(nccl_net_ofi_rdma_req_t *req)
  * all segments arrived, increment completions of parent request
  * (receive request).
  *
- * Modifications of the receive segment request are guarded by the
- * receive segment request's lock.  Modifications of the receive
- * request are guarded by the receive request's lock.
+ * Segments may complete concurrently on multiple rails. As in
+ * inc_req_completion(), the segment size and count are updated
+ * atomically and only the thread observing the last segment
+ * completes the parent request.
  *
  * @param	req
  *		Receive request
@@ -850,40 +1103,186 @@ static inline int inc_recv_seg_completion(nccl_net_ofi_rdma_req_t *req,
 {
 	assert(req->type == NCCL_OFI_RDMA_RECV_SEGMS);
 	int ret = 0;
-	bool segms_received;
-	
-	nccl_net_ofi_mutex_lock(&req->req_lock);
 
 	/* Sum up segment sizes */
-	req->size += size;
+	__atomic_fetch_add(&req->size, size, __ATOMIC_RELAXED);
 	/* Sum up number of segments */
-	req->ncompls++;
+	int nsegms = __atomic_add_fetch(&req->ncompls, 1, __ATOMIC_ACQ_REL);
 
 	/* The arrival of the last segment is treated as a single
 	 * request completion of the parent request */
-	segms_received = req->ncompls == total_nsegms;
-	
-	/* Mark receive segments request and receive request as completed */
-	if (segms_received) {
+	if (nsegms == total_nsegms) {
 		rdma_req_recv_segms_data_t *recv_segms_data = get_recv_segms_data(req);
 		nccl_net_ofi_rdma_req_t *recv_req = recv_segms_data->recv_req;
 		rdma_req_recv_data_t *recv_data = get_recv_data(recv_req);
+		size_t total_size = __atomic_load_n(&req->size, __ATOMIC_RELAXED);
 
 		/* Total number of completions have arrived */
-		req->state = NCCL_OFI_RDMA_REQ_COMPLETED;
-
-		/* Release lock of receive segment request before
-		 * receive request is set to completed to avoid
-		 * unlocking receive segment request after it has been
-		 * freed in `test()` */
-		nccl_net_ofi_mutex_unlock(&req->req_lock);
-		
-		/* Add completion to parent request */
-		ret = inc_req_completion(recv_req, req->size, recv_data->total_num_compls);
-	} else {
-		nccl_net_ofi_mutex_unlock(&req->req_lock);
+		rdma_req_set_state(req, NCCL_OFI_RDMA_REQ_COMPLETED);
+
+		/* Add completion to parent request. The receive
+		 * segment request must not be accessed after this
+		 * point, since `test()' may free the receive request
+		 * together with its receive segment request. */
+		ret = inc_req_completion(recv_req, total_size, recv_data->total_num_compls);
+	}
+
+	return ret;
+}
+
+/*
+ * @brief	Resolve endpoint names into addresses of the address vector
+ *		of an endpoint rail
+ *
+ * Names that were resolved before are served from the address cache of
+ * the rail. The others are inserted into the address vector with a
+ * single fi_av_insert() call and added to the cache.
+ *
+ * @param	rail
+ *		Endpoint rail
+ * @param	ep_names
+ *		`count' endpoint names, packed at the address length of
+ *		the rail
+ * @param	count
+ *		Number of names, at most NCCL_OFI_RDMA_MAX_AV_INSERT
+ * @param	addrs
+ *		Output array of `count' addresses
+ * @param	dev_id
+ *		Device ID, for logging
+ *
+ * @return	0, on success
+ *		-EINVAL, if the address vector rejected an address
+ */
+static int rdma_ep_rail_av_insert(nccl_net_ofi_ep_rail_t *rail, const char *ep_names,
+				  size_t count, fi_addr_t *addrs, int dev_id)
+{
+	size_t ep_name_len = rail->local_ep_name_len;
+	char missing_names[NCCL_OFI_RDMA_MAX_AV_INSERT * MAX_EP_ADDR];
+	size_t missing_idx[NCCL_OFI_RDMA_MAX_AV_INSERT];
+	fi_addr_t missing_addrs[NCCL_OFI_RDMA_MAX_AV_INSERT];
+	size_t num_missing = 0;
+	int ret = 0;
+
+	assert(count <= NCCL_OFI_RDMA_MAX_AV_INSERT);
+
+	nccl_net_ofi_mutex_lock(&rail->av_cache_lock);
+
+	for (size_t i = 0; i < count; ++i) {
+		const char *ep_name = ep_names + i * ep_name_len;
+		auto it = rail->av_cache->find(std::string(ep_name, ep_name_len));
+		if (it != rail->av_cache->end()) {
+			addrs[i] = it->second;
+			continue;
+		}
+
+		memcpy(missing_names + num_missing * ep_name_len, ep_name, ep_name_len);
+		missing_idx[num_missing++] = i;
+	}
+
+	if (num_missing == 0) {
+		goto exit;
+	}
+
+	ret = fi_av_insert(rail->av, missing_names, num_missing, missing_addrs, 0, NULL);
+	if (OFI_UNLIKELY(ret != (int)num_missing)) {
+		NCCL_OFI_WARN("Unable to insert %zu addresses into address vector "
+			      "for device %d. RC: %s",
+			      num_missing, dev_id, fi_strerror(-ret));
+		ret = -EINVAL;
+		goto exit;
+	}
+	ret = 0;
+
+	for (size_t i = 0; i < num_missing; ++i) {
+		const char *ep_name = missing_names + i * ep_name_len;
+		(*rail->av_cache)[std::string(ep_name, ep_name_len)] = missing_addrs[i];
+		addrs[missing_idx[i]] = missing_addrs[i];
+	}
+
+ exit:
+	nccl_net_ofi_mutex_unlock(&rail->av_cache_lock);
+
+	return ret;
+}
+
+/*
+ * @brief	Initialize data rail `rail_id' of a send communicator by
+ *		inserting the remote endpoint name into the address vector
+ *		of the corresponding endpoint rail
+ */
+static int rdma_send_comm_init_rail(nccl_net_ofi_rdma_send_comm_t *s_comm,
+				    nccl_net_ofi_rdma_ep_t *ep, uint16_t rail_id,
+				    const char *remote_ep_name)
+{
+	nccl_net_ofi_rdma_send_comm_rail_t *comm_rail = &s_comm->rails[rail_id];
+	nccl_net_ofi_ep_rail_t *ep_rail = &ep->rails[rail_id];
+
+	comm_rail->local_ep = ep_rail->ofi_ep;
+
+	/* Resolve remote EP address */
+	return rdma_ep_rail_av_insert(ep_rail, remote_ep_name, 1,
+				      &comm_rail->remote_addr, s_comm->base.base.dev_id);
+}
+
+/*
+ * @brief	Bring up the data rails of a send communicator that were
+ *		left uninitialized at connection establishment
+ */
+static int rdma_send_comm_activate_rails(nccl_net_ofi_rdma_send_comm_t *s_comm)
+{
+	int ret = 0;
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)s_comm->base.base.ep;
+
+	nccl_net_ofi_mutex_lock(&s_comm->ctrl_recv_lock);
+
+	for (uint16_t rail_id = s_comm->num_active_rails; rail_id < s_comm->num_rails; ++rail_id) {
+		ret = rdma_send_comm_init_rail(s_comm, ep, rail_id,
+					       s_comm->lazy_remote_ep_names[rail_id].ep_name);
+		if (OFI_UNLIKELY(ret != 0)) {
+			goto unlock;
+		}
+		__atomic_store_n(&s_comm->num_active_rails, rail_id + 1, __ATOMIC_RELEASE);
+	}
+
+	if (s_comm->lazy_remote_ep_names != NULL) {
+		NCCL_OFI_TRACE(NCCL_NET, "Activated %u data rails of send comm %p",
+			       s_comm->num_rails, s_comm);
+		free(s_comm->lazy_remote_ep_names);
+		s_comm->lazy_remote_ep_names = NULL;
+	}
+
+ unlock:
+	nccl_net_ofi_mutex_unlock(&s_comm->ctrl_recv_lock);
+
+	return ret;
+}
+
+/*
+ * @brief	Return in `num_rails' the number of data rails a transfer
+ *		of `size' bytes may be scheduled on
+ *
+ * A transfer that the scheduler would stripe across rails activates
+ * the data rails that have not been brought up yet. The receiver
+ * activated its rails before advertising a buffer of that size, so
+ * no further handshake is needed.
+ */
+static inline int rdma_send_comm_get_sched_rails(nccl_net_ofi_rdma_send_comm_t *s_comm,
+						 size_t size, int *num_rails)
+{
+	int ret = 0;
+	uint16_t num_active_rails = __atomic_load_n(&s_comm->num_active_rails, __ATOMIC_ACQUIRE);
+
+	if (OFI_UNLIKELY(num_active_rails < s_comm->num_rails) &&
+	    size > ofi_nccl_min_stripe_size()) {
+		ret = rdma_send_comm_activate_rails(s_comm);
+		if (OFI_UNLIKELY(ret != 0)) {
+			return ret;
+		}
+		num_active_rails = __atomic_load_n(&s_comm->num_active_rails, __ATOMIC_ACQUIRE);
 	}
 
+	*num_rails = num_active_rails;
+
 	return ret;
 }
 
@@ -893,7 +1292,6 @@ static inline int update_send_data_from_remote(nccl_net_ofi_rdma_send_comm_t *s_
 	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)s_comm->base.base.ep;
 	assert(ep != NULL);
 
-	nccl_net_ofi_rdma_device_t *device = rdma_endpoint_get_device(ep);
 	nccl_net_ofi_rdma_domain_t *domain = rdma_endpoint_get_domain(ep);
 	assert(domain != NULL);
 	nccl_net_ofi_scheduler_t *scheduler = domain->scheduler;
@@ -914,18 +1312,36 @@ static inline int update_send_data_from_remote(nccl_net_ofi_rdma_send_comm_t *s_
 	send_data->remote_len = ctrl_msg->buff_len;
 
 	/* If recv buffer is smaller than send buffer, we reduce the size of the send req */
-	nccl_net_ofi_mutex_lock(&req->req_lock);
 	if (send_data->remote_len < send_data->buff_len) {
 		NCCL_OFI_TRACE(NCCL_NET, "Remote recv buffer (%zu) smaller than send buffer (%zu)",
 			       send_data->remote_len, send_data->buff_len);
-		req->size = send_data->remote_len;
+		__atomic_store_n(&req->size, send_data->remote_len, __ATOMIC_RELAXED);
 		send_data->buff_len = send_data->remote_len;
 	}
-	nccl_net_ofi_mutex_unlock(&req->req_lock);
 
-	send_data->schedule = scheduler->get_schedule(scheduler, send_data->buff_len, device->num_rails);
+	send_data->no_target_completion = (ctrl_msg->type == NCCL_OFI_RDMA_MSG_CTRL_NO_COMPLETION);
+
+	if (send_data->buff_len == 0 && ep->zero_byte_inject) {
+		/* Zero-byte write is injected without a schedule (see
+		   post_rdma_zero_byte_send()) */
+		send_data->total_num_compls = 1;
+		send_data->wdata = GET_RDMA_WRITE_IMM_DATA(s_comm->remote_comm_id, req->msg_seq_num, 1);
+		return 0;
+	}
+
+	int num_rails = 0;
+	int ret = rdma_send_comm_get_sched_rails(s_comm, send_data->buff_len, &num_rails);
+	if (OFI_UNLIKELY(ret != 0)) {
+		return ret;
+	}
+
+	send_data->schedule = scheduler->get_schedule(scheduler, send_data->buff_len, num_rails);
 	if (OFI_UNLIKELY(send_data->schedule == NULL)) {
 		return -EINVAL;
+	} else if (OFI_UNLIKELY(send_data->schedule->num_xfer_infos > s_comm->max_num_segms)) {
+		NCCL_OFI_WARN("Schedule of %zu segments exceeds the maximum of %u segments of the receiver",
+			      send_data->schedule->num_xfer_infos, s_comm->max_num_segms);
+		return -EINVAL;
 	}
 
 	/* Set expected number of completions */
@@ -934,24 +1350,204 @@ static inline int update_send_data_from_remote(nccl_net_ofi_rdma_send_comm_t *s_
 	send_data->wdata =
 		GET_RDMA_WRITE_IMM_DATA(s_comm->remote_comm_id, req->msg_seq_num, send_data->schedule->num_xfer_infos);
 
-	send_data->no_target_completion = (ctrl_msg->type == NCCL_OFI_RDMA_MSG_CTRL_NO_COMPLETION);
 	return 0;
 }
 
 /*
- * Post all rx buffers for a rail if we don't have enough
+ * @brief	Set the number of rx buffers rail `rail' keeps posted
+ *
+ * The target is clamped to the rail's bounds. Growing the target
+ * beyond the minimum is limited by RDMA_RX_BUFF_MEM_BUDGET.
+ *
+ * Caller must hold rail->rx_buff_mutex.
  */
-static inline int check_post_rx_buffers_rail(nccl_net_ofi_rdma_ep_t *ep,
-						 nccl_net_ofi_ep_rail_t *rail)
+static void rdma_rail_set_rx_buff_target(nccl_net_ofi_ep_rail_t *rail, size_t target)
 {
-	/* Not taking lock here since we are only reading a value.
-	   If needed, post_rx_buffs_on_rail will take the lock. */
-	if (rail->num_rx_buff_posted < rail->min_rx_buff_posted) {
-		return post_rx_buffs_on_rail(ep, rail);
-	}
+	size_t budget = ofi_nccl_rdma_rx_buff_mem_budget();
 
-	return 0;
-}
+	target = std::min(std::max(target, rail->min_rx_buff_posted), rail->max_rx_buff_posted);
+
+	if (rail->rx_buff_size == 0) {
+		rail->target_rx_buff_posted = target;
+		return;
+	}
+
+	if (target < rail->target_rx_buff_posted) {
+		__atomic_fetch_sub(&rx_buff_mem_used,
+				   (rail->target_rx_buff_posted - target) * rail->rx_buff_size,
+				   __ATOMIC_RELAXED);
+		rail->target_rx_buff_posted = target;
+		return;
+	}
+
+	size_t used = __atomic_load_n(&rx_buff_mem_used, __ATOMIC_RELAXED);
+	size_t delta;
+	do {
+		delta = (target - rail->target_rx_buff_posted) * rail->rx_buff_size;
+		if (budget > 0 && used + delta > budget &&
+		    target > rail->min_rx_buff_posted) {
+			/* Grow as far as the budget allows */
+			size_t avail = (used < budget) ? budget - used : 0;
+			target = std::max(rail->target_rx_buff_posted + avail / rail->rx_buff_size,
+					  rail->min_rx_buff_posted);
+			target = std::min(target, rail->max_rx_buff_posted);
+			delta = (target - rail->target_rx_buff_posted) * rail->rx_buff_size;
+		}
+		if (delta == 0) {
+			return;
+		}
+	} while (!__atomic_compare_exchange_n(&rx_buff_mem_used, &used, used + delta,
+					      false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	rail->target_rx_buff_posted = target;
+}
+
+/*
+ * @brief	Initialize the posted rx buffer target of rail `rail'
+ *		after its bounds and buffer size have been set
+ */
+static void rdma_rail_init_rx_buff_target(nccl_net_ofi_ep_rail_t *rail)
+{
+	rail->rx_buff_arrivals = 0;
+	rail->rx_buff_shortages = 0;
+	rail->rx_buff_tune_reposts = 0;
+	rail->rx_buff_epoch_start_us = rdma_time_now_us();
+
+	if (ofi_nccl_rdma_rx_buff_autotune() == 0) {
+		rail->target_rx_buff_posted = rail->max_rx_buff_posted;
+		return;
+	}
+
+	rail->target_rx_buff_posted = 0;
+	rdma_rail_set_rx_buff_target(rail, 2 * rail->min_rx_buff_posted);
+}
+
+/*
+ * @brief	Release the budget accounted for the target of rail `rail'
+ */
+static void rdma_rail_fini_rx_buff_target(nccl_net_ofi_ep_rail_t *rail)
+{
+	if (ofi_nccl_rdma_rx_buff_autotune() != 0) {
+		__atomic_fetch_sub(&rx_buff_mem_used,
+				   rail->target_rx_buff_posted * rail->rx_buff_size,
+				   __ATOMIC_RELAXED);
+	}
+	rail->target_rx_buff_posted = 0;
+}
+
+/*
+ * @brief	Account rx buffers of rail `rail' being filled
+ */
+static inline void rdma_rail_rx_buff_arrived(nccl_net_ofi_ep_rail_t *rail)
+{
+	__atomic_fetch_add(&rail->rx_buff_arrivals, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * @brief	Account rail `rail' running short of posted rx buffers,
+ *		and grow its target on the first shortage of the epoch
+ *
+ * Caller must hold rail->rx_buff_mutex.
+ */
+static inline void rdma_rail_rx_buff_shortage(nccl_net_ofi_ep_rail_t *rail)
+{
+	if (ofi_nccl_rdma_rx_buff_autotune() == 0) {
+		return;
+	}
+
+	if (rail->rx_buff_shortages++ == 0) {
+		rdma_rail_set_rx_buff_target(rail, 2 * rail->target_rx_buff_posted);
+	}
+}
+
+/*
+ * @brief	Shrink the target of rail `rail' at the end of an epoch
+ *		in which it had neither shortages nor much traffic
+ *
+ * The clock is only read every RDMA_RX_BUFF_TUNE_CLOCK_STRIDE
+ * reposts, so an epoch may end late. Arrivals are scaled down to the
+ * nominal epoch length before being compared to the target.
+ *
+ * Caller must hold rail->rx_buff_mutex.
+ */
+static inline void rdma_rail_tune_rx_buff(nccl_net_ofi_ep_rail_t *rail)
+{
+	if (ofi_nccl_rdma_rx_buff_autotune() == 0) {
+		return;
+	}
+
+	if (++rail->rx_buff_tune_reposts < RDMA_RX_BUFF_TUNE_CLOCK_STRIDE) {
+		return;
+	}
+	rail->rx_buff_tune_reposts = 0;
+
+	uint64_t epoch_us = ofi_nccl_rdma_rx_buff_tune_epoch_us();
+	uint64_t now = rdma_time_now_us();
+	uint64_t elapsed_us = now - rail->rx_buff_epoch_start_us;
+	if (elapsed_us < epoch_us) {
+		return;
+	}
+
+	size_t arrivals = __atomic_exchange_n(&rail->rx_buff_arrivals, 0, __ATOMIC_RELAXED);
+	if (elapsed_us > 0) {
+		arrivals = arrivals * epoch_us / elapsed_us;
+	}
+	if (rail->rx_buff_shortages == 0 && arrivals < rail->target_rx_buff_posted / 2) {
+		rdma_rail_set_rx_buff_target(rail, rail->target_rx_buff_posted / 2);
+	}
+
+	rail->rx_buff_shortages = 0;
+	rail->rx_buff_epoch_start_us = now;
+}
+
+/*
+ * @brief	Return true if a filled rx buffer of rail `rail' should be
+ *		freed instead of reposted, because the rail has more rx
+ *		buffers posted than its target. The buffer is removed
+ *		from the posted count in this case.
+ */
+static inline bool rdma_rail_drop_rx_buff(nccl_net_ofi_ep_rail_t *rail)
+{
+	bool drop = false;
+
+	if (ofi_nccl_rdma_rx_buff_autotune() == 0) {
+		return false;
+	}
+
+	nccl_net_ofi_mutex_lock(&rail->rx_buff_mutex);
+
+	rdma_rail_tune_rx_buff(rail);
+	if (rail->num_rx_buff_posted > rail->target_rx_buff_posted) {
+		rail->num_rx_buff_posted--;
+		drop = true;
+	}
+
+	nccl_net_ofi_mutex_unlock(&rail->rx_buff_mutex);
+
+	return drop;
+}
+
+/*
+ * Post all rx buffers for a rail if we don't have enough
+ */
+static inline int check_post_rx_buffers_rail(nccl_net_ofi_rdma_ep_t *ep,
+						 nccl_net_ofi_ep_rail_t *rail)
+{
+	/* Not taking lock here since we are only reading a value.
+	   If needed, post_rx_buffs_on_rail will take the lock. */
+	if (rail->num_rx_buff_posted < rail->min_rx_buff_posted) {
+		if (rail->num_rx_buff_posted == 0 && ofi_nccl_rdma_rx_buff_autotune() != 0) {
+			/* Running dry means the depth of the rail did not
+			 * cover the arrivals in between two refills */
+			nccl_net_ofi_mutex_lock(&rail->rx_buff_mutex);
+			rdma_rail_rx_buff_shortage(rail);
+			nccl_net_ofi_mutex_unlock(&rail->rx_buff_mutex);
+		}
+		return post_rx_buffs_on_rail(ep, rail);
+	}
+
+	return 0;
+}
 
 /**
  * @brief	Re-post a rx buffer that has not yet been removed from active
@@ -962,13 +1558,26 @@ static inline int repost_rx_buff(nccl_net_ofi_rdma_ep_t *ep,
 {
 	int ret = 0;
 
+	/* Messages received into a slab are reposted with their slab */
+	if (get_rx_buff_data(rx_buff_req)->slab_req != NULL) {
+		return put_rx_buff_msg(rx_buff_req);
+	}
+
+	/* Let the rail shrink towards its target depth */
+	if (rdma_rail_drop_rx_buff(get_rx_buff_data(rx_buff_req)->rail)) {
+		ret = rx_buff_req->free(rx_buff_req, false);
+		if (OFI_UNLIKELY(ret != 0)) {
+			NCCL_OFI_WARN("Failed to free rx_buff_req");
+			return -EIO;
+		}
+		return 0;
+	}
+
 	/* First, repost this rx buffer */
-	ret = send_progress(rx_buff_req);
+	ret = send_progress(rx_buff_req, false);
 	if (ret == -FI_EAGAIN) {
 		/* Add to pending reqs queue */
-		nccl_net_ofi_mutex_lock(&ep->pending_reqs_lock);
-		ep->pending_reqs_queue->push_back(rx_buff_req);
-		nccl_net_ofi_mutex_unlock(&ep->pending_reqs_lock);
+		rdma_ep_add_pending_req(ep, rx_buff_req);
 		NCCL_OFI_TRACE_PENDING_INSERT(rx_buff_req);
 
 		return 0;
@@ -999,6 +1608,127 @@ static inline int decrease_rx_buff_cnt(nccl_net_ofi_rdma_ep_t *ep,
 	return check_post_rx_buffers_rail(ep, rail);
 }
 
+/*
+ * @brief	Account that rx buffer request `rx_buff_req' is kept by
+ *		a communicator and is no longer posted
+ *
+ * Messages received into a slab do not change the posted count. The
+ * slab itself is accounted for when the provider releases it.
+ */
+static inline int hold_rx_buff(nccl_net_ofi_rdma_req_t *rx_buff_req)
+{
+	rdma_req_rx_buff_data_t *rx_buff_data = get_rx_buff_data(rx_buff_req);
+
+	if (rx_buff_data->slab_req != NULL) {
+		return 0;
+	}
+
+	return decrease_rx_buff_cnt(rx_buff_data->ep, rx_buff_data->rail);
+}
+
+static inline int rx_buff_msg_req_free(nccl_net_ofi_rdma_req_t *req,
+				       bool dec_inflight_reqs)
+{
+	assert(!dec_inflight_reqs);
+	rdma_req_rx_buff_data_t *rx_buff_data = get_rx_buff_data(req);
+	nccl_net_ofi_rdma_ep_t *ep = rx_buff_data->ep;
+
+	/* The rx buffer belongs to the slab */
+	assert(rx_buff_data->slab_req != NULL);
+	rx_buff_data->slab_req = NULL;
+	rx_buff_data->rx_buff_fl_elem = NULL;
+
+	return free_base_req(NULL, ep->rx_buff_reqs_fl, req, false);
+}
+
+/*
+ * @brief	Allocate request for a message received into slab `slab_req'
+ *
+ * The returned request references the slab, which is not reposted
+ * before the request is released with put_rx_buff_msg().
+ */
+static inline nccl_net_ofi_rdma_req_t *get_rx_buff_msg(nccl_net_ofi_rdma_req_t *slab_req,
+						       struct fi_cq_data_entry *cq_entry)
+{
+	rdma_req_rx_buff_data_t *slab_data = get_rx_buff_data(slab_req);
+	nccl_net_ofi_rdma_ep_t *ep = slab_data->ep;
+
+	nccl_net_ofi_rdma_req_t *req = allocate_req(ep->rx_buff_reqs_fl);
+	if (OFI_UNLIKELY(req == NULL)) {
+		NCCL_OFI_WARN("Failed to allocate rx_buff message req");
+		return NULL;
+	}
+
+	req->comm = NULL;
+	req->type = slab_req->type;
+	req->dev_id = slab_req->dev_id;
+	req->free = rx_buff_msg_req_free;
+
+	rdma_req_rx_buff_data_t *rx_buff_data = get_rx_buff_data(req);
+	rx_buff_data->rx_buff_fl_elem = slab_data->rx_buff_fl_elem;
+	rx_buff_data->buff = cq_entry->buf;
+	rx_buff_data->buff_len = cq_entry->len;
+	rx_buff_data->multi_recv = false;
+	rx_buff_data->slab_refcnt = 0;
+	rx_buff_data->slab_req = slab_req;
+	rx_buff_data->rail = slab_data->rail;
+	rx_buff_data->ep = ep;
+
+	__atomic_fetch_add(&slab_data->slab_refcnt, 1, __ATOMIC_RELAXED);
+
+	return req;
+}
+
+/*
+ * @brief	Drop a reference to slab `slab_req' and repost it once
+ *		neither the provider nor any received message use it
+ */
+static inline int put_rx_buff_slab(nccl_net_ofi_rdma_req_t *slab_req)
+{
+	rdma_req_rx_buff_data_t *slab_data = get_rx_buff_data(slab_req);
+
+	assert(slab_data->multi_recv);
+	if (__atomic_sub_fetch(&slab_data->slab_refcnt, 1, __ATOMIC_ACQ_REL) > 0) {
+		return 0;
+	}
+
+	return check_post_rx_buff_req(slab_req);
+}
+
+/*
+ * @brief	Release a message received into a slab
+ */
+static inline int put_rx_buff_msg(nccl_net_ofi_rdma_req_t *rx_buff_req)
+{
+	nccl_net_ofi_rdma_req_t *slab_req = get_rx_buff_data(rx_buff_req)->slab_req;
+
+	int ret = rx_buff_req->free(rx_buff_req, false);
+	if (OFI_UNLIKELY(ret != 0)) {
+		NCCL_OFI_WARN("Failed to free rx_buff message req");
+		return ret;
+	}
+
+	return put_rx_buff_slab(slab_req);
+}
+
+/*
+ * @brief	Handle the provider releasing slab `slab_req' after it
+ *		has been filled
+ */
+static inline int release_rx_buff_slab(nccl_net_ofi_rdma_req_t *slab_req)
+{
+	rdma_req_rx_buff_data_t *slab_data = get_rx_buff_data(slab_req);
+
+	/* The slab is no longer posted, even though messages received
+	 * into it may still be in use */
+	int ret = decrease_rx_buff_cnt(slab_data->ep, slab_data->rail);
+	if (OFI_UNLIKELY(ret != 0)) {
+		return ret;
+	}
+
+	return put_rx_buff_slab(slab_req);
+}
+
 /**
  * @brief	Handle receiving an RDMA control message. These are control messages
  *       	containing information about the remote buffer location which will be
@@ -1018,7 +1748,7 @@ static inline int handle_ctrl_recv(nccl_net_ofi_rdma_send_comm_t *s_comm,
 	if (mb_res == NCCL_OFI_MSGBUFF_SUCCESS) {
 		/* Inserted! In this case sender has not yet called send() for this message, so
 		   return success and initiate RDMA write when sender calls send(). */
-		return decrease_rx_buff_cnt(ep, get_rx_buff_data(rx_buff_req)->rail);
+		return hold_rx_buff(rx_buff_req);
 	}
 
 	if (OFI_UNLIKELY(mb_res != NCCL_OFI_MSGBUFF_INVALID_IDX || stat != NCCL_OFI_MSGBUFF_INPROGRESS)) {
@@ -1041,20 +1771,56 @@ static inline int handle_ctrl_recv(nccl_net_ofi_rdma_send_comm_t *s_comm,
 	rdma_req_rx_buff_data_t *rx_buff_data = get_rx_buff_data(rx_buff_req);
 	nccl_net_ofi_rdma_ctrl_msg_t *ctrl_msg = get_rx_ctrl_msg(rx_buff_data);
 
-	if (!send_data->eager) {
+	if (ctrl_msg->type == NCCL_OFI_RDMA_MSG_PULL_DONE) {
+		/* The receiver has read the data of a pull send, which
+		   is the only completion of the send request */
+		if (OFI_UNLIKELY(!send_data->pull)) {
+			NCCL_OFI_WARN("Received pull done message for msg %hu, which was not offered to pull",
+				      msg_seq_num);
+			return -EINVAL;
+		}
+		if (ctrl_msg->buff_len < send_data->buff_len) {
+			__atomic_store_n(&req->size, (size_t)ctrl_msg->buff_len, __ATOMIC_RELAXED);
+			send_data->buff_len = ctrl_msg->buff_len;
+		}
+
+		send_data->total_num_compls = 1;
+		ret = inc_req_completion(req, 0, send_data->total_num_compls);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Failed to increase completion count");
+			return ret;
+		}
+	} else if (!send_data->eager) {
+		/* Pull sends whose buffer the receiver advertised
+		   before the pull message arrived fall back to writes.
+		   The pull message does not read any of the fields
+		   updated here. */
 		ret = update_send_data_from_remote(s_comm, rx_buff_req, req);
 		if (OFI_UNLIKELY(ret != 0)) {
 			NCCL_OFI_WARN("Failed to copy ctrl data");
 			return ret;
 		}
 
+		if (send_data->pull) {
+			nccl_ofi_rdma_pull_state_t state =
+				__atomic_exchange_n(&send_data->pull_state, NCCL_OFI_RDMA_PULL_WRITES,
+						    __ATOMIC_ACQ_REL);
+			if (state == NCCL_OFI_RDMA_PULL_POSTING) {
+				/* The owner of the request posts the
+				   writes instead of the pull message */
+				goto repost;
+			} else if (OFI_UNLIKELY(state != NCCL_OFI_RDMA_PULL_POSTED)) {
+				NCCL_OFI_WARN("Received duplicate ctrl message for pull send msg %hu",
+					      msg_seq_num);
+				return -EINVAL;
+			}
+		}
+
 		/* Initiate rdma write */
-		ret = send_progress(req);
+		ret = post_rdma_send_data(req, false);
 		if (ret == -FI_EAGAIN) {
 			/* Add to pending reqs queue */
-			nccl_net_ofi_mutex_lock(&ep->pending_reqs_lock);
-			ep->pending_reqs_queue->push_back(req);
-			nccl_net_ofi_mutex_unlock(&ep->pending_reqs_lock);
+			rdma_ep_add_pending_req(ep, req);
 			ret = 0;
 			NCCL_OFI_TRACE_PENDING_INSERT(req);
 		}
@@ -1065,15 +1831,13 @@ static inline int handle_ctrl_recv(nccl_net_ofi_rdma_send_comm_t *s_comm,
 		/* If recv buffer is smaller than send buffer, we reduce the size of the send req, even if we have
 		   have already eagerly sent the whole send buffer. The receive side will discard the extra data. */
 		send_data->remote_len = ctrl_msg->buff_len;
-		nccl_net_ofi_mutex_lock(&req->req_lock);
 		if (send_data->remote_len < send_data->buff_len) {
 			NCCL_OFI_TRACE(NCCL_NET,
 				       "Remote recv buffer (%zu) smaller than send buffer (%zu) in eager send",
 				       send_data->remote_len, send_data->buff_len);
-			req->size = send_data->remote_len;
+			__atomic_store_n(&req->size, send_data->remote_len, __ATOMIC_RELAXED);
 			send_data->buff_len = send_data->remote_len;
 		}
-		nccl_net_ofi_mutex_unlock(&req->req_lock);
 
 		/* In the eager case, increment completion count for send req */
 		ret = inc_req_completion(req, 0, send_data->total_num_compls);
@@ -1083,8 +1847,11 @@ static inline int handle_ctrl_recv(nccl_net_ofi_rdma_send_comm_t *s_comm,
 		}
 	}
 
-	/* Attempt to re-post rx buffer */
-	ret = repost_rx_buff(ep, rx_buff_req);
+repost:
+	/* Attempt to re-post rx buffer. The rx buffer is owned by the
+	 * endpoint that posted it, which is not necessarily the
+	 * endpoint of the communicator (see RDMA_SHARED_RX). */
+	ret = repost_rx_buff(rx_buff_data->ep, rx_buff_req);
 	if (ret != 0) {
 		NCCL_OFI_WARN("Failed to repost rx buff");
 		return ret;
@@ -1100,14 +1867,14 @@ static inline int free_eager_copy_req(nccl_net_ofi_rdma_req_t *req, bool dec_inf
 	nccl_net_ofi_rdma_recv_comm_t *r_comm =
 		(nccl_net_ofi_rdma_recv_comm_t *)req->comm;
 
-	return free_base_req(&r_comm->num_inflight_reqs, r_comm->nccl_ofi_reqs_fl,
+	return free_comm_req(&r_comm->num_inflight_reqs, &r_comm->reqs,
 			     req, dec_inflight_reqs);
 }
 
 static inline int alloc_eager_copy_req(nccl_net_ofi_rdma_req_t *recv_req, nccl_net_ofi_rdma_recv_comm_t *r_comm,
 				       nccl_net_ofi_rdma_req_t *rx_buff_req)
 {
-	nccl_net_ofi_rdma_req_t *eager_copy_req = allocate_req(r_comm->nccl_ofi_reqs_fl);
+	nccl_net_ofi_rdma_req_t *eager_copy_req = allocate_comm_req(&r_comm->reqs);
 	if (eager_copy_req == NULL) {
 		NCCL_OFI_WARN("Failed to allocate eager_copy_req");
 		return -ENOMEM;
@@ -1137,10 +1904,10 @@ static inline int handle_eager_recv(nccl_net_ofi_rdma_recv_comm_t *r_comm,
 					     nccl_net_ofi_rdma_req_t *rx_buff_req)
 {
 	int ret;
-	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
+	rdma_req_rx_buff_data_t *rx_buff_data = get_rx_buff_data(rx_buff_req);
 
 	/* Decrease rx buffer count. It will be incremented again when reposting */
-	ret = decrease_rx_buff_cnt(ep, get_rx_buff_data(rx_buff_req)->rail);
+	ret = hold_rx_buff(rx_buff_req);
 	if (ret != 0) {
 		return ret;
 	}
@@ -1175,7 +1942,6 @@ static inline int handle_eager_recv(nccl_net_ofi_rdma_recv_comm_t *r_comm,
 	nccl_net_ofi_rdma_req_t *recv_req = (nccl_net_ofi_rdma_req_t *)elem;
 	rdma_req_recv_data_t *recv_data = get_recv_data(recv_req);
 
-	rdma_req_rx_buff_data_t *rx_buff_data = get_rx_buff_data(rx_buff_req);
 	if (rx_buff_data->recv_len == 0) {
 		/* Special case: for zero-sized messages, we can skip the local read */
 		/* Re-post rx buffer */
@@ -1203,6 +1969,58 @@ static inline int handle_eager_recv(nccl_net_ofi_rdma_recv_comm_t *r_comm,
 	return 0;
 }
 
+/**
+ * @brief	Handle receiving a pull message, which advertises the source
+ *		buffer of a send for the receiver to read
+ *
+ * The message is kept until recv() is called for it. If recv() was
+ * called first, the receiver has advertised its buffer already and the
+ * sender writes the data, so the pull message is dropped.
+ */
+static inline int handle_pull_recv(nccl_net_ofi_rdma_recv_comm_t *r_comm,
+				   uint16_t msg_seq_num,
+				   nccl_net_ofi_rdma_req_t *rx_buff_req)
+{
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
+
+	/* Decrease rx buffer count. It will be incremented again when reposting */
+	int ret = hold_rx_buff(rx_buff_req);
+	if (ret != 0) {
+		return ret;
+	}
+
+	if (OFI_UNLIKELY(ep->pull_min_size < 0)) {
+		/* Reading into device buffers requires FI_READ access,
+		   which is only requested if pull mode is enabled */
+		NCCL_OFI_TRACE(NCCL_NET, "Pull mode disabled, dropping pull message for msg %hu",
+			       msg_seq_num);
+		return check_post_rx_buff_req(rx_buff_req);
+	}
+
+	nccl_ofi_msgbuff_status_t stat;
+	nccl_ofi_msgbuff_result_t mb_res = nccl_ofi_msgbuff_insert(r_comm->msgbuff, msg_seq_num,
+		rx_buff_req, NCCL_OFI_MSGBUFF_BUFF, &stat);
+
+	if (mb_res == NCCL_OFI_MSGBUFF_SUCCESS) {
+		/* Inserted! In this case receiver has not yet called recv() for this message, so
+		   return success and initiate the reads when receiver calls recv(). */
+		return 0;
+	}
+
+	if (OFI_UNLIKELY(mb_res != NCCL_OFI_MSGBUFF_INVALID_IDX ||
+			 (stat != NCCL_OFI_MSGBUFF_INPROGRESS && stat != NCCL_OFI_MSGBUFF_COMPLETED))) {
+		NCCL_OFI_WARN("Unexpected message insert result (%d) status (%d) (pull recv)",
+			      (int)mb_res, (int)stat);
+		return -EINVAL;
+	}
+
+	/* The ctrl message of recv() races with the pull message; the
+	   sender falls back to writes once it receives the ctrl
+	   message */
+	NCCL_OFI_TRACE(NCCL_NET, "Dropping pull message for msg %hu posted before", msg_seq_num);
+	return check_post_rx_buff_req(rx_buff_req);
+}
+
 static int finish_connect(nccl_net_ofi_rdma_send_comm_t *s_comm);
 
 static int handle_close_msg_recv(nccl_net_ofi_rdma_req_t *rx_buff_req)
@@ -1236,6 +2054,116 @@ static int handle_close_msg_recv(nccl_net_ofi_rdma_req_t *rx_buff_req)
 	return repost_rx_buff(ep, rx_buff_req);
 }
 
+/**
+ * @brief	Return true if `conn_msg' was sent by a peer speaking a
+ *		protocol version that is supported locally
+ *
+ * Versions NCCL_OFI_RDMA_PROTOCOL_VERSION_MIN to
+ * NCCL_OFI_RDMA_PROTOCOL_VERSION share the layout of connect messages.
+ */
+static inline bool rdma_connection_info_version_matches(const nccl_ofi_rdma_connection_info_t *conn_msg)
+{
+	return conn_msg->version >= NCCL_OFI_RDMA_PROTOCOL_VERSION_MIN &&
+		conn_msg->version <= NCCL_OFI_RDMA_PROTOCOL_VERSION;
+}
+
+/**
+ * @brief	Reject a connection whose peer speaks an unsupported
+ *		protocol version
+ *
+ * @return	0, if the version is supported
+ *		-EINVAL, otherwise
+ */
+static int rdma_connection_info_check_version(const nccl_ofi_rdma_connection_info_t *conn_msg,
+					      int dev_id)
+{
+	if (OFI_UNLIKELY(!rdma_connection_info_version_matches(conn_msg))) {
+		NCCL_OFI_WARN("Rejecting connection on dev %d: peer speaks RDMA protocol version %u, "
+			      "but this plugin supports versions %u to %u. All ranks must run "
+			      "compatible plugin versions.",
+			      dev_id, conn_msg->version, NCCL_OFI_RDMA_PROTOCOL_VERSION_MIN,
+			      NCCL_OFI_RDMA_PROTOCOL_VERSION);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief	Check a connect or connect response message of `len' bytes
+ *		received on endpoint `ep'
+ *
+ * The endpoint names of the message must have the address length of
+ * the local endpoint, so that they can be inserted into the address
+ * vectors of the endpoint rails as they are. Of a message from a peer
+ * speaking another protocol version, only the header is checked; the
+ * connection is rejected by accept() or connect().
+ *
+ * @return	0, if the message is well-formed
+ *		-EINVAL, otherwise
+ */
+static int rdma_connection_info_validate(nccl_net_ofi_rdma_ep_t *ep,
+					 const nccl_ofi_rdma_connection_info_t *conn_msg,
+					 size_t len)
+{
+	if (OFI_UNLIKELY(len < sizeof(nccl_ofi_rdma_connection_info_t))) {
+		NCCL_OFI_WARN("Received malformed connect message of %zu bytes", len);
+		return -EINVAL;
+	}
+
+	if (OFI_UNLIKELY(!rdma_connection_info_version_matches(conn_msg))) {
+		return 0;
+	}
+
+	if (OFI_UNLIKELY(conn_msg->num_rails > MAX_NUM_RAILS ||
+			 conn_msg->num_control_rails > MAX_NUM_RAILS ||
+			 nccl_ofi_rdma_connection_info_size(conn_msg) != len)) {
+		NCCL_OFI_WARN("Received malformed connect message of %zu bytes", len);
+		return -EINVAL;
+	}
+
+	if (OFI_UNLIKELY(conn_msg->ep_name_len != ep->control_rails[0].local_ep_name_len)) {
+		NCCL_OFI_WARN("Remote endpoint name length %u does not match local length %zu",
+			      conn_msg->ep_name_len, ep->control_rails[0].local_ep_name_len);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief	Queue a received connect message on its listen communicator
+ *
+ * The message is copied, since the rx buffer it arrived in is reposted
+ * right away. accept() picks the connection up from the queue.
+ */
+static int rdma_listen_comm_enqueue_conn(nccl_net_ofi_rdma_listen_comm_t *l_comm,
+					 nccl_ofi_rdma_connection_info_t *conn_msg)
+{
+	/* Only the header of a message of another protocol version
+	   is needed to reject it */
+	size_t conn_msg_size = rdma_connection_info_version_matches(conn_msg) ?
+		nccl_ofi_rdma_connection_info_size(conn_msg) : sizeof(nccl_ofi_rdma_connection_info_t);
+	nccl_net_ofi_rdma_listen_conn_t *conn =
+		(nccl_net_ofi_rdma_listen_conn_t *)calloc(1, sizeof(nccl_net_ofi_rdma_listen_conn_t) +
+							    conn_msg_size);
+	if (OFI_UNLIKELY(conn == NULL)) {
+		NCCL_OFI_WARN("Unable to allocate connection for listen communicator %u",
+			      l_comm->comm_id);
+		return -ENOMEM;
+	}
+
+	memcpy(&conn->conn_msg, conn_msg, conn_msg_size);
+	conn->stage = COMM_RECV_CONN;
+	conn->recv_time_us = rdma_time_now_us();
+
+	nccl_net_ofi_mutex_lock(&l_comm->conn_queue_lock);
+	l_comm->conn_queue->push_back(conn);
+	nccl_net_ofi_mutex_unlock(&l_comm->conn_queue_lock);
+
+	return 0;
+}
+
 /**
  * @brief	Handle receiving a rx buffer message. These are:
  * 		connect messages (l_comm), connect response messages (s_comm),
@@ -1257,6 +2185,36 @@ static inline int handle_rx_buff_recv(nccl_net_ofi_rdma_device_t *device, uint16
 		NCCL_OFI_WARN("RECV event had NULL ctx!");
 		return -EINVAL;
 	}
+
+	if (get_rx_buff_data(rx_buff_req)->multi_recv) {
+		/* Handle the message received into the slab through a
+		 * request of its own, so that the slab can keep
+		 * receiving while the message is in use */
+		nccl_net_ofi_rdma_req_t *slab_req = rx_buff_req;
+		rx_buff_req = NULL;
+
+		if (cq_entry->flags & FI_RECV) {
+			rx_buff_req = get_rx_buff_msg(slab_req, cq_entry);
+			if (OFI_UNLIKELY(rx_buff_req == NULL)) {
+				return -ENOMEM;
+			}
+		}
+
+		if (cq_entry->flags & FI_MULTI_RECV) {
+			rdma_rail_rx_buff_arrived(get_rx_buff_data(slab_req)->rail);
+			ret = release_rx_buff_slab(slab_req);
+			if (OFI_UNLIKELY(ret != 0)) {
+				return ret;
+			}
+		}
+
+		if (rx_buff_req == NULL) {
+			return 0;
+		}
+	} else {
+		rdma_rail_rx_buff_arrived(get_rx_buff_data(rx_buff_req)->rail);
+	}
+
 	if (OFI_UNLIKELY((eager && (rx_buff_req->type != NCCL_OFI_RDMA_EAGER_RX_BUFF))
 			 || ((!eager) && (rx_buff_req->type != NCCL_OFI_RDMA_CTRL_RX_BUFF)))) {
 		NCCL_OFI_WARN("Invalid non-rx_buff request as ctx!");
@@ -1288,18 +2246,24 @@ static inline int handle_rx_buff_recv(nccl_net_ofi_rdma_device_t *device, uint16
 	switch (msg_type) {
 	case NCCL_OFI_RDMA_MSG_CONN:
 		/* CONN receive completion */
-		assert(sizeof(nccl_ofi_rdma_connection_info_t) == cq_entry->len);
-
 		conn_msg = get_rx_connection_msg(rx_buff_data);
-		l_comm = rdma_device_get_listen_comm(device, conn_msg->remote_comm_id);
-
-		assert(l_comm->req.comm->type == NCCL_NET_OFI_LISTEN_COMM);
-		assert((nccl_net_ofi_comm_t *)l_comm == l_comm->req.comm);
-
-		/* Copy connection message in the communicator */
-		l_comm->conn_msg = *conn_msg;
+		ret = rdma_connection_info_validate(ep, conn_msg, cq_entry->len);
+		if (OFI_UNLIKELY(ret != 0)) {
+			goto exit;
+		}
 
-		ret = inc_req_completion(&l_comm->req, cq_entry->len, 1);
+		/* The lock keeps the listen communicator from being
+		 * closed until the message is queued */
+		nccl_net_ofi_mutex_lock(&device->listen_comm_lock);
+		l_comm = rdma_device_get_listen_comm(device, conn_msg->remote_comm_id);
+		if (OFI_LIKELY(l_comm != NULL)) {
+			/* Queue connection message until accept picks it up */
+			ret = rdma_listen_comm_enqueue_conn(l_comm, conn_msg);
+		} else {
+			NCCL_OFI_INFO(NCCL_NET, "Dropping connect message for closed listen communicator %u",
+				      conn_msg->remote_comm_id);
+		}
+		nccl_net_ofi_mutex_unlock(&device->listen_comm_lock);
 		if (OFI_UNLIKELY(ret != 0)) {
 			goto exit;
 		}
@@ -1313,17 +2277,24 @@ static inline int handle_rx_buff_recv(nccl_net_ofi_rdma_device_t *device, uint16
 		break;
 	case NCCL_OFI_RDMA_MSG_CONN_RESP:
 		/* CONN_RESP receive completion */
-		assert(sizeof(nccl_ofi_rdma_connection_info_t) == cq_entry->len);
-
 		conn_resp_msg = get_rx_connection_msg(rx_buff_data);
+		ret = rdma_connection_info_validate(ep, conn_resp_msg, cq_entry->len);
+		if (OFI_UNLIKELY(ret != 0)) {
+			goto exit;
+		}
+
 		s_comm = rdma_device_get_send_comm(device, conn_resp_msg->remote_comm_id);
 
 		assert(NULL != s_comm->conn_resp_req);
 		assert(NCCL_NET_OFI_SEND_COMM == s_comm->conn_resp_req->comm->type);
 		assert((nccl_net_ofi_comm_t *)s_comm == s_comm->conn_resp_req->comm);
 
-		/* Copy connection response message in the communicator */
-		memcpy(s_comm->conn_msg->ptr, conn_resp_msg, sizeof(nccl_ofi_rdma_connection_info_t));
+		/* Copy connection response message in the communicator.
+		   Only the header of a message of another protocol
+		   version is needed to reject it. */
+		memcpy(s_comm->conn_msg->ptr, conn_resp_msg,
+		       rdma_connection_info_version_matches(conn_resp_msg) ?
+		       cq_entry->len : sizeof(nccl_ofi_rdma_connection_info_t));
 
 		ret = inc_req_completion(s_comm->conn_resp_req, cq_entry->len, 1);
 		if (OFI_UNLIKELY(ret != 0)) {
@@ -1338,6 +2309,7 @@ static inline int handle_rx_buff_recv(nccl_net_ofi_rdma_device_t *device, uint16
 		}
 		break;
 	case NCCL_OFI_RDMA_MSG_CTRL_NO_COMPLETION:
+	case NCCL_OFI_RDMA_MSG_PULL_DONE:
 		/* fall through to NCCL_OFI_RDMA_MSG_CTRL case */
 	case NCCL_OFI_RDMA_MSG_CTRL:
 		/* CTRL receive completion */
@@ -1364,6 +2336,28 @@ static inline int handle_rx_buff_recv(nccl_net_ofi_rdma_device_t *device, uint16
 		s_comm->n_ctrl_received += 1;
 		nccl_net_ofi_mutex_unlock(&s_comm->ctrl_recv_lock);
 
+		break;
+	case NCCL_OFI_RDMA_MSG_PULL:
+		/* Pull message receive completion */
+		if (OFI_UNLIKELY(cq_entry->len != nccl_net_ofi_rdma_ctrl_msg_size(ep->num_rails, ep->use_long_rkeys))) {
+			NCCL_OFI_WARN("Received malformed pull message of %zu bytes", cq_entry->len);
+			ret = -EINVAL;
+			goto exit;
+		}
+
+		ctrl_msg = get_rx_ctrl_msg(rx_buff_data);
+		r_comm = rdma_device_get_recv_comm(device, ctrl_msg->remote_comm_id);
+		if (OFI_UNLIKELY(r_comm == nullptr)) {
+			NCCL_OFI_WARN("Received pull message for non-existent recv comm id %u",
+				      ctrl_msg->remote_comm_id);
+			ret = -EINVAL;
+			goto exit;
+		}
+
+		ret = handle_pull_recv(r_comm, ctrl_msg->msg_seq_num, rx_buff_req);
+		if (OFI_UNLIKELY(ret != 0)) {
+			goto exit;
+		}
 		break;
 	case NCCL_OFI_RDMA_MSG_CLOSE:
 		assert(cq_entry->len == sizeof(nccl_net_ofi_rdma_close_msg_t));
@@ -1430,8 +2424,6 @@ static inline nccl_net_ofi_rdma_req_t *get_req_from_imm_data
  */
 static inline int handle_write_comp(struct fi_cq_data_entry *cq_entry, nccl_net_ofi_rdma_device_t *device, uint16_t rail_id)
 {
-	int ret;
-
 	nccl_net_ofi_rdma_req_t *req = get_req_from_imm_data(device, cq_entry->data);
 	if (!req) {
 		return -EINVAL;
@@ -1443,14 +2435,28 @@ static inline int handle_write_comp(struct fi_cq_data_entry *cq_entry, nccl_net_
 
 	uint64_t total_segms = GET_NUM_SEG_FROM_IMM(cq_entry->data);
 
-	ret = inc_recv_seg_completion(recv_segms_req, cq_entry->len, total_segms);
-	if (OFI_UNLIKELY(ret != 0)) {
-		return ret;
+	NCCL_OFI_TRACE_RECV_SEGMENT_COMPLETE(req->dev_id, rail_id, req->comm, cq_entry->len, req, req->msg_seq_num);
+
+	/* The sender striped the message or wrote on a rail that is
+	 * not active yet. Bring up the remaining data rails before the
+	 * receive completes, so that its flush covers all rails that
+	 * carried data. */
+	if (total_segms > 1 || rail_id != 0) {
+		int ret = rdma_recv_comm_activate_rails((nccl_net_ofi_rdma_recv_comm_t *)req->comm);
+		if (OFI_UNLIKELY(ret != 0)) {
+			return ret;
+		}
 	}
 
-	NCCL_OFI_TRACE_RECV_SEGMENT_COMPLETE(req->dev_id, rail_id, req->comm, cq_entry->len, req, req->msg_seq_num);
+	if (total_segms == 1) {
+		/* Single-segment messages, such as zero-byte messages,
+		   complete the receive request directly without summing
+		   up segments */
+		rdma_req_set_state(recv_segms_req, NCCL_OFI_RDMA_REQ_COMPLETED);
+		return inc_req_completion(req, cq_entry->len, recv_data->total_num_compls);
+	}
 
-	return 0;
+	return inc_recv_seg_completion(recv_segms_req, cq_entry->len, total_segms);
 }
 
 /**
@@ -1458,12 +2464,81 @@ static inline int handle_write_comp(struct fi_cq_data_entry *cq_entry, nccl_net_
  */
 static inline int handle_flush_comp(nccl_net_ofi_rdma_req_t *req)
 {
-	int ret;
 	rdma_req_flush_data_t *flush_data = get_flush_data(req);
 
-	ret = inc_req_completion(req, 0, flush_data->total_num_compls);
+	int ncompls = __atomic_add_fetch(&req->ncompls, 1, __ATOMIC_ACQ_REL);
+	if (ncompls != flush_data->total_num_compls) {
+		return 0;
+	}
 
-	return ret;
+	/* Detach the flushes that joined this read before the request
+	 * is reported complete and may be freed */
+	nccl_net_ofi_rdma_req_t *joined = rdma_flush_detach_joined(req);
+
+	rdma_req_set_completed(req);
+	NCCL_OFI_TRACE_COMPLETIONS(req->dev_id, req, req);
+
+	while (joined != NULL) {
+		nccl_net_ofi_rdma_req_t *next = get_flush_data(joined)->joined_next;
+		rdma_req_set_completed(joined);
+		NCCL_OFI_TRACE_COMPLETIONS(joined->dev_id, joined, joined);
+		joined = next;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief	Complete the transfer of a pull message into receive request
+ *		`recv_req' after `size' bytes have been read
+ *
+ * Releases the rx buffer holding the pull message and sends the
+ * PULL_DONE message, which completes the send request of the sender.
+ */
+static int finish_pull_recv(nccl_net_ofi_rdma_req_t *recv_req,
+			    nccl_net_ofi_rdma_req_t *pull_rx_buff_req,
+			    size_t size)
+{
+	rdma_req_recv_data_t *recv_data = get_recv_data(recv_req);
+	nccl_net_ofi_rdma_recv_comm_t *r_comm = (nccl_net_ofi_rdma_recv_comm_t *)recv_req->comm;
+
+	/* Check posted count and re-post rx buffer if needed */
+	int ret = check_post_rx_buff_req(pull_rx_buff_req);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Failed call to check_post_rx_buff_req");
+		return ret;
+	}
+
+	nccl_net_ofi_mutex_lock(&r_comm->ctrl_counter_lock);
+	r_comm->n_ctrl_sent += 1;
+	nccl_net_ofi_mutex_unlock(&r_comm->ctrl_counter_lock);
+	ret = receive_progress(recv_data->send_ctrl_req, true);
+	if (OFI_UNLIKELY(ret != 0)) {
+		NCCL_OFI_WARN("Failed to post pull done message: %d", ret);
+		return ret;
+	}
+
+	/* Add completion to parent request */
+	return inc_req_completion(recv_req, size, recv_data->total_num_compls);
+}
+
+/**
+ * @brief	Handle completion of a read of a pull message
+ */
+static inline int handle_pull_read_comp(nccl_net_ofi_rdma_req_t *req)
+{
+	rdma_req_rma_op_data_t *rma_op_data = req_get_rma_op_data(req, NCCL_OFI_RDMA_READ);
+
+	int ncompls = __atomic_add_fetch(&req->ncompls, 1, __ATOMIC_ACQ_REL);
+	if (ncompls != rma_op_data->total_num_compls) {
+		return 0;
+	}
+
+	/* The read request must not be accessed after completing
+	 * the receive request, which frees it */
+	rdma_req_set_state(req, NCCL_OFI_RDMA_REQ_COMPLETED);
+	return finish_pull_recv(rma_op_data->recv_req, rma_op_data->pull_rx_buff_req,
+				rma_op_data->buff_len);
 }
 
 static const char *req_state_str(nccl_net_ofi_rdma_req_state_t state)
@@ -1607,7 +2682,7 @@ static inline int rdma_req_handle_cq_entry(nccl_net_ofi_context_t *ctx,
 
 		if (req->type == NCCL_OFI_RDMA_SEND_CONN || req->type == NCCL_OFI_RDMA_SEND_CONN_RESP) {
 			/* CONN or CONN_RESP send completion */
-			ret = inc_req_completion(req, sizeof(nccl_ofi_rdma_connection_info_t), 1);
+			ret = inc_req_completion(req, 0, 1);
 
 		} else if (req->type == NCCL_OFI_RDMA_SEND_CTRL) {
 			/* CTRL message send completion */
@@ -1626,7 +2701,7 @@ static inline int rdma_req_handle_cq_entry(nccl_net_ofi_context_t *ctx,
 			NCCL_OFI_WARN("Send completion from unexpected request type");
 			ret = -EINVAL;
 		}
-	} else if (comp_flags & FI_RECV) {
+	} else if (comp_flags & (FI_RECV | FI_MULTI_RECV)) {
 
 		nccl_net_ofi_rdma_device_t *device =
 			rdma_endpoint_get_device(get_rx_buff_data(req)->ep);
@@ -1685,7 +2760,12 @@ static inline int rdma_req_handle_cq_entry(nccl_net_ofi_context_t *ctx,
 			/* Local-initiated RMA read is complete */
 
 			rma_op_data = req_get_rma_op_data(req, NCCL_OFI_RDMA_READ);
-			ret = inc_req_completion(req, 0, rma_op_data->total_num_compls);
+			if (rma_op_data->recv_req != NULL) {
+				/* Read of a pull message */
+				ret = handle_pull_read_comp(req);
+			} else {
+				ret = inc_req_completion(req, 0, rma_op_data->total_num_compls);
+			}
 			break;
 		}
 		case NCCL_OFI_RDMA_SEND:
@@ -1818,17 +2898,88 @@ static inline int rdma_req_handle_error_entry(nccl_net_ofi_context_t *ctx,
 	return ret;
 }
 
-
+
+/*
+ * @brief	Set the completion callbacks of the first `num_rails'
+ *		Libfabric contexts of request
+ *
+ * Called once when the request is initialized. Requests only provide
+ * contexts for the rails of their endpoint (see
+ * nccl_net_ofi_rdma_req_size()).
+ */
+static inline void rdma_req_init_ofi_contexts(nccl_net_ofi_rdma_req_t *req, uint16_t num_rails)
+{
+	assert(num_rails <= MAX_NUM_RAILS);
+	for (uint16_t i = 0; i < num_rails; ++i) {
+		req->ctx[i].handle_cq_entry = rdma_req_handle_cq_entry;
+		req->ctx[i].handle_error_entry = rdma_req_handle_error_entry;
+	}
+}
+
+/*
+ * @brief	Return Libfabric context of request for rail `rail_id'
+ */
 static inline void *rdma_req_get_ofi_context(nccl_net_ofi_rdma_req_t *req, uint16_t rail_id)
 {
-	return static_cast<void *>(&(req->ctx[rail_id].ofi_ctx));
+	assert(req->ctx[rail_id].handle_cq_entry == rdma_req_handle_cq_entry);
+	return static_cast<void *>(&req->ctx[rail_id].ofi_ctx);
 }
 
 
+/*
+ * @brief	Post the reads of a pull message, striped across rails
+ *		according to the schedule of the read request
+ *
+ * Reads start from `xferred_rail_id', so that a request that was
+ * queued on FI_EAGAIN resumes where it stopped.
+ */
+static int post_pull_reads(nccl_net_ofi_rdma_req_t *req)
+{
+	rdma_req_rma_op_data_t *rma_op_data = req_get_rma_op_data(req, NCCL_OFI_RDMA_READ);
+	nccl_net_ofi_rdma_recv_comm_t *r_comm = (nccl_net_ofi_rdma_recv_comm_t *)req->comm;
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
+	nccl_net_ofi_schedule_t *schedule = rma_op_data->schedule;
+	nccl_net_ofi_rdma_mr_handle_t *mr_handle = get_recv_data(rma_op_data->recv_req)->dest_mr_handle;
+	nccl_net_ofi_rdma_ctrl_msg_t *pull_msg =
+		get_rx_ctrl_msg(get_rx_buff_data(rma_op_data->pull_rx_buff_req));
+
+	for (uint16_t xfer_id = rma_op_data->xferred_rail_id; xfer_id < schedule->num_xfer_infos; xfer_id++) {
+		nccl_net_ofi_xfer_info_t *xfer_info = &schedule->rail_xfer_infos[xfer_id];
+		uint16_t rail_id = xfer_info->rail_id;
+		nccl_net_ofi_rdma_recv_comm_rail_t *comm_rail = rdma_recv_comm_get_rail(r_comm, rail_id);
+		uint64_t rkey = ep->use_long_rkeys ? pull_msg->long_buff_mr_key[rail_id]
+						   : pull_msg->short_buff_mr_key[rail_id];
+
+		ssize_t rc = fi_read(comm_rail->local_ep,
+				     (void *)((uintptr_t)rma_op_data->buff + xfer_info->offset),
+				     xfer_info->msg_size, mr_handle->desc[rail_id],
+				     comm_rail->remote_addr,
+				     rma_op_data->remote_buff + xfer_info->offset,
+				     rkey, rdma_req_get_ofi_context(req, rail_id));
+		if (rc != 0) {
+			if (rc != -FI_EAGAIN) {
+				NCCL_OFI_WARN("fi_read failed; RC: %zd, Error: %s",
+					      rc, fi_strerror(-rc));
+			}
+			return rc;
+		}
+
+		rdma_ep_mark_rail_active(ep, rail_id);
+		rma_op_data->xferred_rail_id++;
+	}
+
+	return 0;
+}
+
 static int post_rma_read(nccl_net_ofi_rdma_req_t *req)
 {
 	rdma_req_rma_op_data_t *rma_op_data = req_get_rma_op_data(req, NCCL_OFI_RDMA_READ);
 	nccl_net_ofi_rdma_recv_comm_t *r_comm = (nccl_net_ofi_rdma_recv_comm_t *)req->comm;
+
+	if (rma_op_data->schedule != NULL) {
+		return post_pull_reads(req);
+	}
+
 	uint16_t rail_id = 0;
 	nccl_net_ofi_rdma_recv_comm_rail_t *comm_rail = rdma_recv_comm_get_rail(r_comm, rail_id);
 
@@ -1843,6 +2994,8 @@ static int post_rma_read(nccl_net_ofi_rdma_req_t *req)
 	if ((rc != 0) && (rc != -FI_EAGAIN)) {
 		NCCL_OFI_WARN("fi_read failed; RC: %zd, Error: %s",
 			      rc, fi_strerror(-rc));
+	} else if (rc == 0) {
+		rdma_ep_mark_rail_active((nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep, rail_id);
 	}
 
 	return rc;
@@ -1898,9 +3051,7 @@ static int receive_progress(nccl_net_ofi_rdma_req_t *req, bool add_to_pending)
 		/* Extract ep */
 		nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
 		/* Place in pending requests queue for next try */
-		nccl_net_ofi_mutex_lock(&ep->pending_reqs_lock);
-		ep->pending_reqs_queue->push_back(req);
-		nccl_net_ofi_mutex_unlock(&ep->pending_reqs_lock);
+		rdma_ep_add_pending_req(ep, req);
 		rc = 0;
 
 		NCCL_OFI_TRACE_PENDING_INSERT(req);
@@ -1910,33 +3061,165 @@ static int receive_progress(nccl_net_ofi_rdma_req_t *req, bool add_to_pending)
 }
 
 /*
- * Attempt to post all requests in the pending requests queue.
+ * @brief	Return the libfabric endpoint that the next operation of
+ *		request `req' is posted to by send_progress(), or NULL if
+ *		it is not posted by send_progress() or not known upfront
+ */
+static inline struct fid_ep *rdma_req_get_next_post_ep(nccl_net_ofi_rdma_req_t *req)
+{
+	switch (req->type) {
+	case NCCL_OFI_RDMA_SEND: {
+		nccl_net_ofi_rdma_send_comm_t *s_comm = (nccl_net_ofi_rdma_send_comm_t *)req->comm;
+		rdma_req_send_data_t *send_data = get_send_data(req);
+
+		if (rdma_send_data_pull_msg_pending(send_data)) {
+			/* The pull message is posted to a control rail */
+			return NULL;
+		}
+		nccl_net_ofi_schedule_t *schedule = send_data->schedule;
+		if (schedule == NULL) {
+			/* Zero-byte messages are sent on rail 0 */
+			return rdma_send_comm_get_rail(s_comm, 0)->local_ep;
+		}
+		if (send_data->xferred_rail_id >= schedule->num_xfer_infos) {
+			return NULL;
+		}
+		uint16_t rail_id = schedule->rail_xfer_infos[send_data->xferred_rail_id].rail_id;
+		return rdma_send_comm_get_rail(s_comm, rail_id)->local_ep;
+	}
+	case NCCL_OFI_RDMA_WRITE:
+		return rdma_send_comm_get_rail((nccl_net_ofi_rdma_send_comm_t *)req->comm, 0)->local_ep;
+	case NCCL_OFI_RDMA_CTRL_RX_BUFF:
+	case NCCL_OFI_RDMA_EAGER_RX_BUFF:
+		return get_rx_buff_data(req)->rail->ofi_ep;
+	default:
+		return NULL;
+	}
+}
+
+/*
+ * @brief	Return true if the next operations of `req' and `next' are
+ *		posted by send_progress() to the transmit queue of the same
+ *		libfabric endpoint, i.e., posting `next' submits an
+ *		operation of `req' that was posted with FI_MORE
+ *
+ * Only transmit operations are batched. Transmit queue slots are
+ * freed by local completions, so the tail of a batch can always be
+ * posted eventually (see rdma_post_fi_more_batch_tail()). Receive
+ * queue slots are only freed by incoming messages.
+ */
+static inline bool rdma_req_can_batch(nccl_net_ofi_rdma_req_t *req,
+				      nccl_net_ofi_rdma_req_t *next)
+{
+	bool req_tx = (req->type == NCCL_OFI_RDMA_SEND || req->type == NCCL_OFI_RDMA_WRITE);
+	bool next_tx = (next->type == NCCL_OFI_RDMA_SEND || next->type == NCCL_OFI_RDMA_WRITE);
+
+	if (!(req_tx && next_tx)) {
+		return false;
+	}
+
+	struct fid_ep *req_ep = rdma_req_get_next_post_ep(req);
+	return req_ep != NULL && req_ep == rdma_req_get_next_post_ep(next);
+}
+
+/*
+ * @brief	Post `req' without FI_MORE after it failed with FI_EAGAIN
+ *		while operations posted with FI_MORE before it may still
+ *		be held back by the provider
+ *
+ * The provider may defer operations posted with FI_MORE until an
+ * operation without FI_MORE is posted to the same queue, so the batch
+ * must not be left behind with a failed tail. The completion queue of
+ * the rail is progressed until the provider accepts `req'. At most
+ * NCCL_OFI_RDMA_MAX_FI_MORE_BATCH - 1 operations are held back, so
+ * queue slots are freed by operations submitted before the batch.
+ *
+ * @return	zero once `req' is posted, or once it advanced to an
+ *		operation on another endpoint that returned FI_EAGAIN,
+ *		negative errno value on non-success.
+ */
+static int rdma_post_fi_more_batch_tail(nccl_net_ofi_rdma_ep_t *ep,
+					nccl_net_ofi_ep_rail_t *rail,
+					nccl_net_ofi_rdma_req_t *req)
+{
+	nccl_net_ofi_rdma_domain_t *domain = rdma_endpoint_get_domain(ep);
+	nccl_net_ofi_rdma_device_t *device = rdma_domain_get_device(domain);
+	nccl_net_ofi_rdma_domain_rail_t *domain_rail = rdma_domain_get_rail(domain, rail->rail_id);
+	struct fid_ep *batch_ep = rdma_req_get_next_post_ep(req);
+	int rc;
+
+	do {
+		size_t num_cqes = 0;
+		rc = ofi_process_cq_rail(device, domain_rail, &num_cqes);
+		if (OFI_UNLIKELY(rc != 0)) {
+			return rc;
+		}
+		rc = send_progress(req, false);
+		/* A striped send that advanced to another endpoint
+		   posted the tail of the batch already */
+	} while (rc == -FI_EAGAIN && rdma_req_get_next_post_ep(req) == batch_ep);
+
+	return rc;
+}
+
+/*
+ * Attempt to post all requests in the pending requests queue of a rail.
  *
  * Requests are put in the pending reqs queue when the network is busy, i.e., a
- * Libfabric operation returns FI_EAGAIN.
+ * Libfabric operation returns FI_EAGAIN. Draining stops at the first request
+ * that still cannot be posted; queues of other rails are not affected.
+ *
+ * A request that is followed in the queue by a request whose next operation
+ * goes to the same endpoint queue is posted with FI_MORE, so that the
+ * provider can submit the operations of a drain to the NIC together. Posting
+ * the following request submits the held back operation, and the last
+ * operation of a batch is always posted without FI_MORE. Requests posting to
+ * other endpoints, such as a pull message on a control rail, end the batch.
+ * If a request fails with FI_EAGAIN after an operation was posted with
+ * FI_MORE, it is retried as the tail of the batch before draining stops, so
+ * that no held back operation is left unsubmitted.
  *
  * @return zero on success, negative errno value on non-success.
  */
-static int process_pending_reqs(nccl_net_ofi_rdma_ep_t *ep)
+static int process_pending_reqs_rail(nccl_net_ofi_rdma_ep_t *ep, nccl_net_ofi_ep_rail_t *rail)
 {
 	int rc = 0;
+	/* Number of operations posted with FI_MORE since the last
+	   operation without it */
+	size_t batch_len = 0;
+	/* Request dequeued together with the previous request, which
+	   was posted with FI_MORE. It is posted next, so that no other
+	   thread can post it in between. */
+	nccl_net_ofi_rdma_req_t *next = NULL;
 
 	while (true) {
-		nccl_net_ofi_rdma_req_t *req = NULL;
-		nccl_net_ofi_mutex_lock(&ep->pending_reqs_lock);
-		if (!ep->pending_reqs_queue->empty()) {
-			req = ep->pending_reqs_queue->front();
-			ep->pending_reqs_queue->pop_front();
-		}
-		nccl_net_ofi_mutex_unlock(&ep->pending_reqs_lock);
+		nccl_net_ofi_rdma_req_t *req = next;
+		next = NULL;
+		nccl_net_ofi_mutex_lock(&rail->pending_reqs_lock);
+		if (req == NULL && !rail->pending_reqs_queue->empty()) {
+			req = rail->pending_reqs_queue->front();
+			rail->pending_reqs_queue->pop_front();
+			__atomic_fetch_sub(&ep->num_pending_reqs, 1, __ATOMIC_RELAXED);
+		}
+		if (req != NULL && !rail->pending_reqs_queue->empty() &&
+		    batch_len + 1 < NCCL_OFI_RDMA_MAX_FI_MORE_BATCH &&
+		    rdma_req_can_batch(req, rail->pending_reqs_queue->front())) {
+			next = rail->pending_reqs_queue->front();
+			rail->pending_reqs_queue->pop_front();
+			__atomic_fetch_sub(&ep->num_pending_reqs, 1, __ATOMIC_RELAXED);
+		}
+		nccl_net_ofi_mutex_unlock(&rail->pending_reqs_lock);
 		if (req == NULL) { break; }
 
+		bool set_fi_more = (next != NULL);
+		struct fid_ep *post_ep = rdma_req_get_next_post_ep(req);
+
 		switch (req->type) {
 			case NCCL_OFI_RDMA_WRITE:
 			case NCCL_OFI_RDMA_SEND:
 			case NCCL_OFI_RDMA_CTRL_RX_BUFF:
 			case NCCL_OFI_RDMA_EAGER_RX_BUFF:
-				rc = send_progress(req);
+				rc = send_progress(req, set_fi_more);
 				break;
 			case NCCL_OFI_RDMA_READ:
 			case NCCL_OFI_RDMA_EAGER_COPY:
@@ -1957,22 +3240,80 @@ static int process_pending_reqs(nccl_net_ofi_rdma_ep_t *ep)
 				return -EINVAL;
 		}
 
+		if (rc != 0 && next != NULL) {
+			/* Return the request dequeued ahead to the
+			   front of the queue */
+			nccl_net_ofi_mutex_lock(&rail->pending_reqs_lock);
+			rail->pending_reqs_queue->push_front(next);
+			__atomic_fetch_add(&ep->num_pending_reqs, 1, __ATOMIC_RELEASE);
+			nccl_net_ofi_mutex_unlock(&rail->pending_reqs_lock);
+			next = NULL;
+		}
+
+		if (rc == -FI_EAGAIN && batch_len > 0 &&
+		    rdma_req_get_next_post_ep(req) == post_ep) {
+			/* The previous request was posted with FI_MORE
+			   to the same queue and nothing was posted
+			   after it */
+			set_fi_more = false;
+			rc = rdma_post_fi_more_batch_tail(ep, rail, req);
+		}
+
 		if ((rc != 0) && (rc != -FI_EAGAIN)) {
 			NCCL_OFI_WARN("Unable to post request; RC: %d", rc);
 			break;
 		} else if (rc == -FI_EAGAIN) {
-			/* Put the request in the front of the queue and try again later */
-			nccl_net_ofi_mutex_lock(&ep->pending_reqs_lock);
-			ep->pending_reqs_queue->push_front(req);
-			nccl_net_ofi_mutex_unlock(&ep->pending_reqs_lock);
+			nccl_net_ofi_ep_rail_t *next_rail = rdma_req_get_pending_rail(ep, req);
+			/* Put the request in the front of the queue of
+			   the rail it is now waiting for and try again
+			   later. A striped send may have advanced to a
+			   different rail. */
+			nccl_net_ofi_mutex_lock(&next_rail->pending_reqs_lock);
+			next_rail->pending_reqs_queue->push_front(req);
+			__atomic_fetch_add(&ep->num_pending_reqs, 1, __ATOMIC_RELEASE);
+			nccl_net_ofi_mutex_unlock(&next_rail->pending_reqs_lock);
 			rc = 0;
-			break;
+			batch_len = 0;
+			if (next_rail == rail) {
+				break;
+			}
+			continue;
 		}
+		batch_len = set_fi_more ? batch_len + 1 : 0;
 		NCCL_OFI_TRACE_PENDING_REMOVE(req);
 	}
 	return rc;
 }
 
+/*
+ * Attempt to post the pending requests of all rails of the endpoint.
+ *
+ * Each rail is drained independently, so a rail returning FI_EAGAIN does
+ * not block requests queued on other rails.
+ *
+ * @return zero on success, negative errno value on non-success.
+ */
+static int process_pending_reqs(nccl_net_ofi_rdma_ep_t *ep)
+{
+	int rc = 0;
+
+	for (uint16_t rail_id = 0; rail_id < ep->num_control_rails; ++rail_id) {
+		rc = process_pending_reqs_rail(ep, rdma_endpoint_get_control_rail(ep, rail_id));
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
+	for (uint16_t rail_id = 0; rail_id < ep->num_rails; ++rail_id) {
+		rc = process_pending_reqs_rail(ep, rdma_endpoint_get_rail(ep, rail_id));
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
+	return rc;
+}
+
 
 static inline int rdma_process_error_entry(struct fi_cq_err_entry *err_entry, struct fid_cq *cq,
 					   uint16_t rail_id)
@@ -2009,16 +3350,50 @@ static inline int rdma_process_error_entry(struct fi_cq_err_entry *err_entry, st
 }
 
 
-static int ofi_process_cq_rail(nccl_net_ofi_rdma_device_t *device, nccl_net_ofi_rdma_domain_rail_t *rail)
+/*
+ * @brief	Adapt the CQ read batch size of a domain rail to the
+ *		number of entries returned by the last fi_cq_read()
+ *
+ * The batch size is doubled when a read fills the whole batch and
+ * halved when a read returns less than half of it, within
+ * [1, cq_read_count_max].
+ *
+ * Caller must hold the CQ lock of the rail.
+ */
+static inline void rdma_domain_rail_adapt_cq_read_count(nccl_net_ofi_rdma_domain_rail_t *rail,
+							size_t num_read)
+{
+	if (num_read == rail->cq_read_count) {
+		rail->cq_read_count = std::min(rail->cq_read_count * 2, rail->cq_read_count_max);
+	} else if (num_read < rail->cq_read_count / 2) {
+		rail->cq_read_count = std::max(rail->cq_read_count / 2, (size_t)1);
+	}
+}
+
+static int ofi_process_cq_rail(nccl_net_ofi_rdma_device_t *device, nccl_net_ofi_rdma_domain_rail_t *rail,
+			       size_t *num_cqes)
 {
-	struct fi_cq_data_entry cqe_buffers[cq_read_count];
+	struct fi_cq_data_entry *cqe_buffers = rail->cqe_buffers;
 	ssize_t rc = 0;
 	int ret = 0;
 
+	/* Another thread is already draining this CQ. Completions it
+	 * reads are processed the same way as ours would be. */
+	ret = nccl_net_ofi_mutex_trylock(&rail->cq_lock);
+	if (ret != 0) {
+		return 0;
+	}
+
 	while (true) {
 		/* Receive completions for the given endpoint */
-		rc = fi_cq_read(rail->cq, cqe_buffers, cq_read_count);
+		rc = fi_cq_read(rail->cq, cqe_buffers, rail->cq_read_count);
+		rdma_domain_rail_adapt_cq_read_count(rail, (rc > 0) ? (size_t)rc : 0);
+		rail->num_cq_reads++;
 		if (rc > 0) {
+			__atomic_store_n(&rail->cq_activity, RDMA_CQ_ACTIVE_POLLS, __ATOMIC_RELAXED);
+			rail->num_cq_entries += rc;
+			*num_cqes += rc;
+
 			ret = rdma_process_completions(cqe_buffers, rc, device, rail->rail_id);
 			if (OFI_UNLIKELY(ret != 0))
 				goto exit;
@@ -2044,12 +3419,21 @@ static int ofi_process_cq_rail(nccl_net_ofi_rdma_device_t *device, nccl_net_ofi_
 				goto exit;
 			}
 
+			__atomic_store_n(&rail->cq_activity, RDMA_CQ_ACTIVE_POLLS, __ATOMIC_RELAXED);
+			rail->num_cq_entries++;
+			(*num_cqes)++;
+
 			ret = rdma_process_error_entry(&err_entry, rail->cq, rail->rail_id);
 			if (ret != 0) {
 				goto exit;
 			}
 		} else if (rc == -FI_EAGAIN) {
-			/* No completions to process */
+			/* No completions to process. Only the thread
+			 * holding the CQ lock decays the activity, so
+			 * the counter cannot underflow. */
+			if (__atomic_load_n(&rail->cq_activity, __ATOMIC_RELAXED) > 0) {
+				__atomic_fetch_sub(&rail->cq_activity, 1, __ATOMIC_RELAXED);
+			}
 			break;
 		} else {
 			NCCL_OFI_WARN("Unable to retrieve completion queue entries. RC: %zd, ERROR: %s",
@@ -2060,6 +3444,7 @@ static int ofi_process_cq_rail(nccl_net_ofi_rdma_device_t *device, nccl_net_ofi_
 	}
 
 exit:
+	nccl_net_ofi_mutex_unlock(&rail->cq_lock);
 	return ret;
 }
 
@@ -2076,26 +3461,299 @@ static int ofi_process_cq(nccl_net_ofi_rdma_ep_t *ep)
 
 	nccl_net_ofi_rdma_domain_t *domain = rdma_endpoint_get_domain(ep);
 	nccl_net_ofi_rdma_device_t *device = rdma_domain_get_device(domain);
+	uint64_t idle_poll_interval = ofi_nccl_cq_idle_poll_interval();
+	bool poll_idle_rails = true;
+	size_t num_cqes = 0;
+
+	if (idle_poll_interval > 1) {
+		uint64_t poll_count = __atomic_fetch_add(&domain->cq_poll_count, 1,
+							 __ATOMIC_RELAXED);
+		poll_idle_rails = (poll_count % idle_poll_interval) == 0;
+	}
 
 	for (uint16_t rail_id = 0; rail_id != domain->num_rails; ++rail_id) {
 		nccl_net_ofi_rdma_domain_rail_t *rail = rdma_domain_get_rail(domain, rail_id);
 
-		ret = ofi_process_cq_rail(device, rail);
+		/* Skip rails that saw neither a completion nor a post
+		 * within their last RDMA_CQ_ACTIVE_POLLS reads, unless
+		 * it is time to look for remotely initiated completions
+		 * on idle rails */
+		if (!poll_idle_rails &&
+		    __atomic_load_n(&rail->cq_activity, __ATOMIC_RELAXED) == 0) {
+			continue;
+		}
+
+		ret = ofi_process_cq_rail(device, rail, &num_cqes);
 		if (ret != 0) {
 			goto exit;
 		}
 	}
 
+	/* Let a blocking progress thread know that the CQs were not idle */
+	if (domain->cq_epoll_fd >= 0 && num_cqes > 0) {
+		__atomic_fetch_add(&domain->num_cqes_read, num_cqes, __ATOMIC_RELAXED);
+	}
+
 	/* Process any pending requests */
 	ret = process_pending_reqs(ep);
 	if (OFI_UNLIKELY(ret != 0 && ret != -FI_EAGAIN)) {
 		NCCL_OFI_WARN("Failed call to process_pending_reqs: %d", ret);
 	}
 
+	/* Rx buffer reposts that failed with EAGAIN are queued on the
+	   shared rx endpoint */
+	if (domain->shared_rx_ep != NULL && (ret == 0 || ret == -FI_EAGAIN)) {
+		ret = process_pending_reqs(domain->shared_rx_ep);
+		if (OFI_UNLIKELY(ret != 0 && ret != -FI_EAGAIN)) {
+			NCCL_OFI_WARN("Failed call to process_pending_reqs: %d", ret);
+		}
+	}
+
  exit:
 	return ret;
 }
 
+/*
+ * @brief	Block until a completion is available on any rail CQ of
+ *		the domain, or until RDMA_PROGRESS_WAIT_TIMEOUT_MS elapsed
+ *
+ * @return	0, on success (including timeout and pending completions)
+ *		error, on others
+ */
+static int rdma_domain_progress_wait(nccl_net_ofi_rdma_domain_t *domain)
+{
+	nccl_net_ofi_rdma_device_t *device = rdma_domain_get_device(domain);
+	struct epoll_event events[MAX_NUM_RAILS + 1];
+	struct fid *cq_fids[MAX_NUM_RAILS];
+	bool tried[MAX_NUM_RAILS] = {};
+	eventfd_t wake_count;
+	int ret;
+
+	/* fi_trywait() must succeed on all CQs before it is safe to
+	 * block on their wait fds. The CQs are passed all at once to
+	 * fi_trywait(), one call per fabric the rails belong to. */
+	for (uint16_t rail_id = 0; rail_id != domain->num_rails; ++rail_id) {
+		if (tried[rail_id]) {
+			continue;
+		}
+
+		struct fid_fabric *fabric = rdma_device_get_rail(device, rail_id)->fabric;
+		size_t num_fids = 0;
+		for (uint16_t other_id = rail_id; other_id != domain->num_rails; ++other_id) {
+			if (rdma_device_get_rail(device, other_id)->fabric == fabric) {
+				cq_fids[num_fids++] = &rdma_domain_get_rail(domain, other_id)->cq->fid;
+				tried[other_id] = true;
+			}
+		}
+
+		ret = fi_trywait(fabric, cq_fids, num_fids);
+		if (ret == -FI_EAGAIN) {
+			/* Completions are ready */
+			return 0;
+		} else if (ret != 0) {
+			NCCL_OFI_WARN("fi_trywait failed. RC: %d, ERROR: %s",
+				      ret, fi_strerror(-ret));
+			return ret;
+		}
+	}
+
+	domain->progress_wait_histogram->start_timer();
+	ret = epoll_wait(domain->cq_epoll_fd, events, MAX_NUM_RAILS + 1,
+			 RDMA_PROGRESS_WAIT_TIMEOUT_MS);
+	domain->progress_wait_histogram->stop_timer();
+	if (ret < 0 && errno != EINTR) {
+		ret = -errno;
+		NCCL_OFI_WARN("epoll_wait on CQ wait fds failed: %s", strerror(-ret));
+		return ret;
+	}
+
+	/* Reset the wake-up signal. Pending requests added from now on
+	 * signal it again, and the caller checks the pending queues
+	 * before blocking again. */
+	(void)eventfd_read(domain->progress_wake_fd, &wake_count);
+
+	return 0;
+}
+
+/*
+ * @brief	Main loop of the progress thread of a domain
+ *
+ * Progresses the endpoint of the domain until the thread is asked to
+ * stop. The thread is started once the endpoint of the domain is
+ * created (see nccl_net_ofi_rdma_domain_create_endpoint()). The
+ * domain lock is held while progressing so that the endpoint cannot
+ * be released underneath the thread.
+ *
+ * Per-communicator endpoints (see ENDPOINT_PER_COMM) are not tracked
+ * by the domain and are not progressed by this thread. Since the CQs
+ * are shared by all endpoints of the domain, the thread still reads
+ * their completions, but their pending requests are retried by the
+ * application threads calling test() on their communicators, see
+ * rdma_ep_has_progress_thread().
+ *
+ * After CQ_WAIT_SPIN_USEC without completions or pending requests,
+ * the thread blocks on the CQ wait objects until the next completion
+ * arrives. If the CQs have no wait objects, it sleeps for
+ * RDMA_PROGRESS_POLL_BACKOFF_US between polls instead.
+ */
+static void *rdma_domain_progress_thread_main(void *arg)
+{
+	nccl_net_ofi_rdma_domain_t *domain = (nccl_net_ofi_rdma_domain_t *)arg;
+	const bool can_block = (domain->cq_epoll_fd >= 0);
+	const bool can_idle = (ofi_nccl_cq_wait_spin_usec() >= 0);
+	const auto spin_budget = std::chrono::microseconds(ofi_nccl_cq_wait_spin_usec());
+	auto last_activity = std::chrono::steady_clock::now();
+	uint64_t last_num_cqes = 0;
+	int ret = 0;
+
+	while (!__atomic_load_n(&domain->progress_thread_stop, __ATOMIC_ACQUIRE)) {
+		bool has_pending_reqs = false;
+
+		nccl_net_ofi_mutex_lock(&domain->base.domain_lock);
+		nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)domain->base.endpoint;
+		if (ep != NULL) {
+			assert(!ep->is_endpoint_per_communicator_ep);
+			ret = ofi_process_cq(ep);
+			has_pending_reqs = rdma_ep_has_pending_reqs(ep);
+		}
+		nccl_net_ofi_mutex_unlock(&domain->base.domain_lock);
+
+		if (ep == NULL) {
+			/* The endpoint of the domain is being released
+			 * or recreated. Nothing to progress. */
+			usleep(RDMA_PROGRESS_IDLE_SLEEP_US);
+			continue;
+		}
+
+		if (OFI_UNLIKELY(ret != 0 && ret != -FI_EAGAIN)) {
+			NCCL_OFI_WARN("Progress thread of domain %p failed: %d", domain, ret);
+			__atomic_store_n(&domain->progress_thread_error, ret, __ATOMIC_RELEASE);
+			break;
+		}
+		ret = 0;
+
+		if (can_idle) {
+			uint64_t num_cqes = __atomic_load_n(&domain->num_cqes_read, __ATOMIC_RELAXED);
+			auto now = std::chrono::steady_clock::now();
+
+			if (num_cqes != last_num_cqes || has_pending_reqs) {
+				last_num_cqes = num_cqes;
+				last_activity = now;
+			} else if (now - last_activity >= spin_budget) {
+				if (!can_block) {
+					/* Poll at a lower rate to leave the
+					 * core and the domain lock to the
+					 * application */
+					usleep(RDMA_PROGRESS_POLL_BACKOFF_US);
+					continue;
+				}
+
+				ret = rdma_domain_progress_wait(domain);
+				if (OFI_UNLIKELY(ret != 0)) {
+					__atomic_store_n(&domain->progress_thread_error, ret,
+							 __ATOMIC_RELEASE);
+					break;
+				}
+				last_activity = std::chrono::steady_clock::now();
+				continue;
+			}
+		}
+
+		/* Let connection establishment and endpoint release
+		 * take the domain lock */
+		sched_yield();
+	}
+
+	if (can_block) {
+		domain->progress_wait_histogram->print_stats();
+	}
+
+	return NULL;
+}
+
+/*
+ * @brief	Start the progress thread of a domain
+ *
+ * The thread is pinned to the cores local to the NICs of the device,
+ * if known. Failing to pin the thread is not fatal.
+ */
+static int rdma_domain_start_progress_thread(nccl_net_ofi_rdma_domain_t *domain,
+					     nccl_net_ofi_rdma_device_t *device)
+{
+	int ret;
+
+	domain->progress_thread_stop = false;
+	domain->progress_thread_error = 0;
+
+	ret = pthread_create(&domain->progress_thread, NULL,
+			     rdma_domain_progress_thread_main, domain);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Unable to create progress thread: %s", strerror(ret));
+		return -ret;
+	}
+	domain->progress_thread_started = true;
+
+	if (device->has_local_cpuset) {
+		ret = pthread_setaffinity_np(domain->progress_thread, sizeof(cpu_set_t),
+					     &device->local_cpuset);
+		if (ret != 0) {
+			NCCL_OFI_INFO(NCCL_NET, "Unable to pin progress thread of dev %d: %s",
+				      device->base.dev_id, strerror(ret));
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * @brief	Stop and join the progress thread of a domain, if started
+ */
+static void rdma_domain_stop_progress_thread(nccl_net_ofi_rdma_domain_t *domain)
+{
+	if (!domain->progress_thread_started) {
+		return;
+	}
+
+	__atomic_store_n(&domain->progress_thread_stop, true, __ATOMIC_RELEASE);
+	pthread_join(domain->progress_thread, NULL);
+	domain->progress_thread_started = false;
+}
+
+/*
+ * @brief	Return true if completions of endpoint `ep' are
+ *		progressed by the progress thread of its domain
+ *
+ * The progress thread only progresses the endpoint of the domain.
+ * Per-communicator endpoints keep being progressed by the application
+ * threads polling their communicators.
+ */
+static inline bool rdma_ep_has_progress_thread(nccl_net_ofi_rdma_ep_t *ep)
+{
+	return rdma_endpoint_get_domain(ep)->progress_thread_started &&
+		!ep->is_endpoint_per_communicator_ep;
+}
+
+/*
+ * @brief	Progress endpoint `ep' from an application thread
+ *
+ * Endpoints progressed by the progress thread of their domain are
+ * not polled, so that application threads do not compete with the
+ * progress thread for the CQs. The error of the progress thread, if
+ * any, is reported instead.
+ *
+ * @return	0, on success
+ *		error, on others
+ */
+static inline int rdma_ep_progress(nccl_net_ofi_rdma_ep_t *ep)
+{
+	if (rdma_ep_has_progress_thread(ep)) {
+		return __atomic_load_n(&rdma_endpoint_get_domain(ep)->progress_thread_error,
+				       __ATOMIC_ACQUIRE);
+	}
+
+	return ofi_process_cq(ep);
+}
+
 /*
  * @brief	Zero out rdma request
  */
@@ -2153,6 +3811,24 @@ static inline int free_base_req(uint64_t *num_inflight_reqs,
 	return ret;
 }
 
+/*
+ * @brief	Free communicator request by returning it to the request
+ *		freelist of the endpoint
+ */
+static inline int free_comm_req(uint64_t *num_inflight_reqs,
+				nccl_net_ofi_rdma_comm_reqs_t *reqs,
+				nccl_net_ofi_rdma_req_t *req,
+				bool dec_inflight_reqs)
+{
+	int ret = free_base_req(num_inflight_reqs, reqs->fl, req, dec_inflight_reqs);
+	if (OFI_LIKELY(ret == 0)) {
+		assert(reqs->num_allocated > 0);
+		__atomic_fetch_sub(&reqs->num_allocated, 1, __ATOMIC_RELAXED);
+	}
+
+	return ret;
+}
+
 /*
  * @brief	Free write request
  */
@@ -2162,7 +3838,7 @@ static inline int free_write_req(nccl_net_ofi_rdma_req_t *req,
 	assert(req->type == NCCL_OFI_RDMA_WRITE);
 	nccl_net_ofi_rdma_send_comm_t *s_comm =
 		(nccl_net_ofi_rdma_send_comm_t *)req->comm;
-	return free_base_req(&s_comm->num_inflight_reqs, s_comm->nccl_ofi_reqs_fl,
+	return free_comm_req(&s_comm->num_inflight_reqs, &s_comm->reqs,
 			req, dec_inflight_reqs);
 }
 
@@ -2175,8 +3851,18 @@ static inline int free_read_req(nccl_net_ofi_rdma_req_t *req,
 	assert(req->type == NCCL_OFI_RDMA_READ);
 	nccl_net_ofi_rdma_recv_comm_t *r_comm =
 		(nccl_net_ofi_rdma_recv_comm_t *)req->comm;
+	rdma_req_rma_op_data_t *rma_op_data = req_get_rma_op_data(req, NCCL_OFI_RDMA_READ);
+
+	if (rma_op_data->schedule) {
+		nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
+		assert(ep != NULL);
+		nccl_net_ofi_rdma_domain_t *domain = rdma_endpoint_get_domain(ep);
+		assert(domain != NULL);
+		nccl_net_ofi_release_schedule(domain->scheduler, rma_op_data->schedule);
+		rma_op_data->schedule = NULL;
+	}
 
-	return free_base_req(&r_comm->num_inflight_reqs, r_comm->nccl_ofi_reqs_fl,
+	return free_comm_req(&r_comm->num_inflight_reqs, &r_comm->reqs,
 			req, dec_inflight_reqs);
 }
 
@@ -2214,7 +3900,7 @@ static inline int free_send_req(nccl_net_ofi_rdma_req_t *req,
 		send_data->schedule = NULL;
 	}
 
-	return free_base_req(&s_comm->num_inflight_reqs, s_comm->nccl_ofi_reqs_fl,
+	return free_comm_req(&s_comm->num_inflight_reqs, &s_comm->reqs,
 			req, dec_inflight_reqs);
 }
 
@@ -2232,6 +3918,7 @@ static inline int free_recv_req(nccl_net_ofi_rdma_req_t *req,
 	nccl_net_ofi_rdma_req_t *send_ctrl_req = recv_data->send_ctrl_req;
 	nccl_net_ofi_rdma_req_t *recv_segms_req = recv_data->recv_segms_req;
 	nccl_net_ofi_rdma_req_t *eager_copy_req = recv_data->eager_copy_req;
+	nccl_net_ofi_rdma_req_t *pull_read_req = recv_data->pull_read_req;
 
 	if (send_ctrl_req) {
 		ret = send_ctrl_req->free(send_ctrl_req, false);
@@ -2257,7 +3944,15 @@ static inline int free_recv_req(nccl_net_ofi_rdma_req_t *req,
 		}
 	}
 
-	return free_base_req(&r_comm->num_inflight_reqs, r_comm->nccl_ofi_reqs_fl,
+	if (pull_read_req) {
+		ret = pull_read_req->free(pull_read_req, false);
+		if (ret) {
+			NCCL_OFI_WARN("Failed to free receive request");
+			return ret;
+		}
+	}
+
+	return free_comm_req(&r_comm->num_inflight_reqs, &r_comm->reqs,
 			     req, dec_inflight_reqs);
 }
 
@@ -2271,7 +3966,7 @@ static inline int free_recv_segms_req(nccl_net_ofi_rdma_req_t *req,
 	nccl_net_ofi_rdma_recv_comm_t *r_comm =
 		(nccl_net_ofi_rdma_recv_comm_t *)req->comm;
 
-	return free_base_req(&r_comm->num_inflight_reqs, r_comm->nccl_ofi_reqs_fl,
+	return free_comm_req(&r_comm->num_inflight_reqs, &r_comm->reqs,
 			     req, dec_inflight_reqs);
 }
 
@@ -2300,7 +3995,7 @@ static inline int free_send_ctrl_req(nccl_net_ofi_rdma_req_t *req,
 		send_ctrl_data->ctrl_fl_elem = NULL;
 	}
 
-	return free_base_req(&r_comm->num_inflight_reqs, r_comm->nccl_ofi_reqs_fl,
+	return free_comm_req(&r_comm->num_inflight_reqs, &r_comm->reqs,
 			     req, dec_inflight_reqs);
 }
 
@@ -2329,7 +4024,7 @@ static inline int free_send_close_req(nccl_net_ofi_rdma_req_t *req,
 		send_close_data->ctrl_fl_elem = NULL;
 	}
 
-	return free_base_req(&r_comm->num_inflight_reqs, r_comm->nccl_ofi_reqs_fl,
+	return free_comm_req(&r_comm->num_inflight_reqs, &r_comm->reqs,
 			     req, dec_inflight_reqs);
 }
 
@@ -2343,7 +4038,7 @@ static inline int free_send_comm_connection_req(nccl_net_ofi_rdma_req_t *req,
 	nccl_net_ofi_rdma_send_comm_t *s_comm =
 		(nccl_net_ofi_rdma_send_comm_t *)req->comm;
 
-	return free_base_req(&s_comm->num_inflight_reqs, s_comm->nccl_ofi_reqs_fl,
+	return free_comm_req(&s_comm->num_inflight_reqs, &s_comm->reqs,
 			     req, dec_inflight_reqs);
 }
 
@@ -2357,7 +4052,7 @@ static inline int free_flush_req(nccl_net_ofi_rdma_req_t *req,
 	nccl_net_ofi_rdma_recv_comm_t *r_comm =
 		(nccl_net_ofi_rdma_recv_comm_t *)req->comm;
 
-	return free_base_req(&r_comm->num_inflight_reqs, r_comm->nccl_ofi_reqs_fl,
+	return free_comm_req(&r_comm->num_inflight_reqs, &r_comm->reqs,
 			req, dec_inflight_reqs);
 }
 
@@ -2414,7 +4109,11 @@ static inline nccl_net_ofi_rdma_req_t *eager_rx_buff_req_alloc(nccl_net_ofi_rdma
 	assert(NCCL_OFI_IS_PTR_ALIGNED(rx_buff_fl_elem->ptr, EAGER_RX_BUFFER_ALIGNMENT));
 
 	rx_buff_data->rx_buff_fl_elem = rx_buff_fl_elem;
-	rx_buff_data->buff_len = ep->eager_rx_buff_size;
+	rx_buff_data->buff = rx_buff_fl_elem->ptr;
+	rx_buff_data->buff_len = rdma_ep_rx_buff_alloc_size(ep, ep->eager_rx_buff_size);
+	rx_buff_data->multi_recv = (ep->multi_recv_msgs > 0);
+	rx_buff_data->slab_refcnt = 0;
+	rx_buff_data->slab_req = NULL;
 	rx_buff_data->rail = rail;
 	rx_buff_data->ep = ep;
 	return req;
@@ -2455,7 +4154,11 @@ static inline nccl_net_ofi_rdma_req_t *ctrl_rx_buff_req_alloc(nccl_net_ofi_rdma_
 	}
 
 	rx_buff_data->rx_buff_fl_elem = rx_buff_fl_elem;
-	rx_buff_data->buff_len = ep->ctrl_rx_buff_size;
+	rx_buff_data->buff = rx_buff_fl_elem->ptr;
+	rx_buff_data->buff_len = rdma_ep_rx_buff_alloc_size(ep, ep->ctrl_rx_buff_size);
+	rx_buff_data->multi_recv = (ep->multi_recv_msgs > 0);
+	rx_buff_data->slab_refcnt = 0;
+	rx_buff_data->slab_req = NULL;
 	rx_buff_data->rail = rail;
 	rx_buff_data->ep = ep;
 	return req;
@@ -2466,15 +4169,14 @@ static inline int handle_rx_eagain(nccl_net_ofi_rdma_ep_t *ep,
 				       nccl_net_ofi_rdma_req_t *req, size_t num_buffs_failed)
 {
 	/* Add to pending reqs queue */
-	nccl_net_ofi_mutex_lock(&ep->pending_reqs_lock);
-	ep->pending_reqs_queue->push_back(req);
-	nccl_net_ofi_mutex_unlock(&ep->pending_reqs_lock);
+	rdma_ep_add_pending_req(ep, req);
 	NCCL_OFI_TRACE_PENDING_INSERT(req);
 
 	nccl_net_ofi_mutex_lock(&rail->rx_buff_mutex);
 
 	assert(rail->num_rx_buff_posted >= num_buffs_failed);
 	rail->num_rx_buff_posted -= num_buffs_failed;
+	rdma_rail_rx_buff_shortage(rail);
 
 	nccl_net_ofi_mutex_unlock(&rail->rx_buff_mutex);
 
@@ -2488,9 +4190,13 @@ static inline int post_rx_buffs_on_rail(nccl_net_ofi_rdma_ep_t *ep,
 
 	nccl_net_ofi_mutex_lock(&rail->rx_buff_mutex);
 
-	size_t buffers_needed = rail->max_rx_buff_posted -
-				rail->num_rx_buff_posted;
-	rail->num_rx_buff_posted = rail->max_rx_buff_posted;
+	rdma_rail_tune_rx_buff(rail);
+
+	size_t buffers_needed = 0;
+	if (rail->num_rx_buff_posted < rail->target_rx_buff_posted) {
+		buffers_needed = rail->target_rx_buff_posted - rail->num_rx_buff_posted;
+		rail->num_rx_buff_posted = rail->target_rx_buff_posted;
+	}
 
 	nccl_net_ofi_mutex_unlock(&rail->rx_buff_mutex);
 
@@ -2557,13 +4263,38 @@ static inline int post_rx_buffs(nccl_net_ofi_rdma_ep_t *ep)
 	return ret;
 }
 
+/*
+ * @brief	Copy the data rail endpoint names of a connect message, to
+ *		be kept for data rails that are brought up lazily
+ *
+ * @return	Array of `conn_msg->num_rails' endpoint names, on success
+ *		NULL, on allocation failure
+ */
+static nccl_ofi_rdma_ep_name_t *rdma_connection_info_copy_ep_names(nccl_ofi_rdma_connection_info_t *conn_msg)
+{
+	nccl_ofi_rdma_ep_name_t *ep_names = (nccl_ofi_rdma_ep_name_t *)
+		calloc(conn_msg->num_rails, sizeof(nccl_ofi_rdma_ep_name_t));
+	if (OFI_UNLIKELY(ep_names == NULL)) {
+		return NULL;
+	}
+
+	for (uint16_t rail_id = 0; rail_id < conn_msg->num_rails; ++rail_id) {
+		memcpy(ep_names[rail_id].ep_name,
+		       nccl_ofi_rdma_connection_info_ep_name(conn_msg, rail_id),
+		       conn_msg->ep_name_len);
+		ep_names[rail_id].ep_name_len = conn_msg->ep_name_len;
+	}
+
+	return ep_names;
+}
+
 /*
  * @brief	Initialize communicator rails of send communicator
  *
  * This function initializes communicator rail of the send
- * communicator using remote endpoint information provided by a remote
- * endpoint names array. Only communicator rails that have not been
- * initialized yet are initialized.
+ * communicator using remote endpoint information provided by the
+ * connect response message. Only communicator rails that have not
+ * been initialized yet are initialized.
  *
  * @param	s_comm
  *		Send communicator
@@ -2571,27 +4302,22 @@ static inline int post_rx_buffs(nccl_net_ofi_rdma_ep_t *ep)
  *		Valid endpoint
  * @param	dev_id
  *		Device ID
- * @param	remote_ep_names
- *		Array of `num_remote_rails` libfabric endpoint names of remote
- * @param	num_remote_rails
- *		Number of libfabric endpoint names of remote.
- *		The number of remote rails is expected to match the number of
- *		communicator rails of the send communicator.
+ * @param	conn_resp
+ *		Connect response message. The number of remote rails is
+ *		expected to match the number of communicator rails of the
+ *		send communicator.
  *
  * @return	0, success
  * 		error, others
  */
 static int init_send_comm_rails(nccl_net_ofi_rdma_send_comm_t *s_comm,
 					 nccl_net_ofi_rdma_ep_t *ep, int dev_id,
-					 nccl_ofi_rdma_ep_name_t *remote_ep_names,
-					 int num_remote_rails,
-					 nccl_ofi_rdma_ep_name_t *remote_control_ep_names,
-					 int num_remote_control_rails)
+					 nccl_ofi_rdma_connection_info_t *conn_resp)
 {
 	int ret = 0;
 	nccl_net_ofi_rdma_send_comm_rail_t *comm_rail;
 	nccl_net_ofi_ep_rail_t *ep_rail;
-	nccl_ofi_rdma_ep_name_t *remote_rdma_ep_name;
+	const char *remote_ep_name;
 
 	/**
 	 * In ENDPOINT_PER_COMM config, the ep address in the handle is not
@@ -2608,37 +4334,36 @@ static int init_send_comm_rails(nccl_net_ofi_rdma_send_comm_t *s_comm,
 	for (uint16_t rail_id = s_comm->num_init_control_rails; rail_id < s_comm->num_control_rails; ++rail_id) {
 		comm_rail = &s_comm->control_rails[rail_id];
 		ep_rail = &ep->control_rails[rail_id];
-		remote_rdma_ep_name = &remote_control_ep_names[rail_id];
+		remote_ep_name = nccl_ofi_rdma_connection_info_control_ep_name(conn_resp, rail_id);
 
 		comm_rail->local_ep = ep_rail->ofi_ep;
 
-		/* Insert remote EP address to AV */
-		ret = fi_av_insert(ep_rail->av, (void *)remote_rdma_ep_name->ep_name, 1,
-				   &comm_rail->remote_addr, 0, NULL);
-		if (OFI_UNLIKELY(ret != 1)) {
-			NCCL_OFI_WARN("Unable to insert remote address into address vector "
-				      "for device %d. RC: %s",
-				      dev_id, fi_strerror(-ret));
-			return -EINVAL;
+		/* Resolve remote EP address */
+		ret = rdma_ep_rail_av_insert(ep_rail, remote_ep_name, 1,
+					     &comm_rail->remote_addr, dev_id);
+		if (OFI_UNLIKELY(ret != 0)) {
+			return ret;
 		}
 		++(s_comm->num_init_control_rails);
 	}
 
-	for (uint16_t rail_id = 0; rail_id < s_comm->num_rails; ++rail_id) {
-		comm_rail = &s_comm->rails[rail_id];
-		ep_rail = &ep->rails[rail_id];
-		remote_rdma_ep_name = &remote_ep_names[rail_id];
-
-		comm_rail->local_ep = ep_rail->ofi_ep;
+	/* With lazy data rails, only the first data rail is brought
+	 * up here. The endpoint names of the others are kept until the
+	 * first transfer that is striped across rails. */
+	if (s_comm->num_active_rails < s_comm->num_rails) {
+		s_comm->lazy_remote_ep_names = rdma_connection_info_copy_ep_names(conn_resp);
+		if (OFI_UNLIKELY(s_comm->lazy_remote_ep_names == NULL)) {
+			NCCL_OFI_WARN("Unable to allocate remote endpoint names for device %d",
+				      dev_id);
+			return -ENOMEM;
+		}
+	}
 
-		/* Insert remote EP address to AV */
-		ret = fi_av_insert(ep_rail->av, (void *)remote_rdma_ep_name->ep_name, 1,
-				   &comm_rail->remote_addr, 0, NULL);
-		if (OFI_UNLIKELY(ret != 1)) {
-			NCCL_OFI_WARN("Unable to insert remote address into address vector "
-				      "for device %d. RC: %s",
-				      dev_id, fi_strerror(-ret));
-			return -EINVAL;
+	for (uint16_t rail_id = 0; rail_id < s_comm->num_active_rails; ++rail_id) {
+		ret = rdma_send_comm_init_rail(s_comm, ep, rail_id,
+					       nccl_ofi_rdma_connection_info_ep_name(conn_resp, rail_id));
+		if (OFI_UNLIKELY(ret != 0)) {
+			return ret;
 		}
 	}
 
@@ -2691,6 +4416,11 @@ static int finish_connect(nccl_net_ofi_rdma_send_comm_t *s_comm)
 	}
 	dev_id = device->base.dev_id;
 
+	ret = rdma_connection_info_check_version(conn_resp, dev_id);
+	if (ret != 0) {
+		return ret;
+	}
+
 	if (conn_resp->num_rails != ep->num_rails) {
 		NCCL_OFI_WARN("Unexpected number of remote rails for dev %d. Expected %i but got %i",
 			      dev_id, ep->num_rails,
@@ -2706,7 +4436,9 @@ static int finish_connect(nccl_net_ofi_rdma_send_comm_t *s_comm)
 	}
 
 	/* Validate received comm ID */
-	if (OFI_UNLIKELY(conn_resp->local_comm_id >= device->num_comm_ids)) {
+	if (OFI_UNLIKELY(conn_resp->local_comm_id >= NCCL_OFI_RDMA_MAX_REMOTE_COMMS ||
+			 (conn_resp->version >= NCCL_OFI_RDMA_PROTOCOL_VERSION_WIDE_SEGMS &&
+			  conn_resp->local_comm_id >= NCCL_OFI_RDMA_MAX_COMMS))) {
 		NCCL_OFI_WARN("Received an invalid communicator ID %u for device %d", conn_resp->local_comm_id,
 						dev_id);
 		return -EINVAL;
@@ -2715,12 +4447,16 @@ static int finish_connect(nccl_net_ofi_rdma_send_comm_t *s_comm)
 	/* Set remote comm ID to remote recv comm ID */
 	s_comm->remote_comm_id = conn_resp->local_comm_id;
 
+	/* Receivers speaking protocol version 1 decode a 4-bit
+	   segment count from the immediate data */
+	s_comm->max_num_segms = (conn_resp->version >= NCCL_OFI_RDMA_PROTOCOL_VERSION_WIDE_SEGMS) ?
+		NCCL_OFI_RDMA_MAX_NUM_SEGMS : NCCL_OFI_RDMA_MAX_NUM_SEGMS_V1;
+
+	/* The receiver decides whether data rails are brought up lazily */
+	s_comm->num_active_rails = conn_resp->lazy_data_rails ? 1 : s_comm->num_rails;
+
 	/* Initialize rails `1...num_rails-1' */
-	ret = init_send_comm_rails(s_comm, ep, dev_id,
-				   conn_resp->ep_names,
-				   conn_resp->num_rails,
-				   conn_resp->control_ep_names,
-				   conn_resp->num_control_rails);
+	ret = init_send_comm_rails(s_comm, ep, dev_id, conn_resp);
 	if (ret != 0) {
 		return ret;
 	}
@@ -2736,10 +4472,60 @@ static int finish_connect(nccl_net_ofi_rdma_send_comm_t *s_comm)
 
 #define __compiler_barrier() do { asm volatile ("" : : : "memory"); } while(0)
 
+/*
+ * @brief	Remove `buff' from the eager-copied buffers of `r_comm'
+ *
+ * Caller must hold r_comm->flush_lock.
+ *
+ * @return	true, if `buff' was an eager-copied buffer
+ */
+static inline bool rdma_recv_comm_take_eager_copied_buff(nccl_net_ofi_rdma_recv_comm_t *r_comm,
+							 void *buff)
+{
+	return r_comm->eager_copied_buffs->erase(buff) != 0;
+}
+
+/*
+ * @brief	Record the completion of receive request `req' being
+ *		reported to NCCL, which may flush it afterwards
+ *
+ * At most NCCL_OFI_MAX_REQUESTS eager-copied buffers are tracked.
+ * Beyond that, the buffer is not recorded and its flush issues a read
+ * instead of being elided.
+ */
+static inline void rdma_recv_comm_note_recv_done(nccl_net_ofi_rdma_recv_comm_t *r_comm,
+						 nccl_net_ofi_rdma_req_t *req)
+{
+	rdma_req_recv_data_t *recv_data = get_recv_data(req);
+
+	r_comm->num_recvs_completed++;
+
+	if (ofi_nccl_rdma_flush_coalesce() == 0) {
+		return;
+	}
+
+	nccl_net_ofi_mutex_lock(&r_comm->flush_lock);
+	r_comm->flush_seq_at_last_recv = r_comm->num_flush_reads;
+	/* The buffer may have been eager-copied by an earlier receive
+	 * that was never flushed */
+	rdma_recv_comm_take_eager_copied_buff(r_comm, recv_data->dst_buff);
+	if (recv_data->eager_copy_req != NULL) {
+		if (r_comm->eager_copied_buffs->size() < NCCL_OFI_MAX_REQUESTS) {
+			r_comm->eager_copied_buffs->insert(recv_data->dst_buff);
+		} else {
+			r_comm->num_flush_elisions_skipped++;
+			NCCL_OFI_TRACE(NCCL_NET, "Receive comm %p tracks too many eager-copied buffers. Flush of buffer %p will not be elided",
+				       r_comm, recv_data->dst_buff);
+		}
+	}
+	nccl_net_ofi_mutex_unlock(&r_comm->flush_lock);
+}
+
 static int test(nccl_net_ofi_req_t *base_req, int *done, int *size)
 {
 	int ret = 0;
 	nccl_net_ofi_rdma_req_t *req = (nccl_net_ofi_rdma_req_t *)base_req;
+	nccl_net_ofi_rdma_req_state_t state;
 	*done = 0;
 	assert(req->type == NCCL_OFI_RDMA_WRITE ||
 	       req->type == NCCL_OFI_RDMA_READ ||
@@ -2757,25 +4543,21 @@ static int test(nccl_net_ofi_req_t *base_req, int *done, int *size)
 
 	/* Process more completions unless the current request is
 	 * completed */
-	if (req->state != NCCL_OFI_RDMA_REQ_COMPLETED
-		&& OFI_LIKELY(req->state != NCCL_OFI_RDMA_REQ_ERROR)) {
-		ret = ofi_process_cq(ep);
+	state = rdma_req_get_state(req);
+	if (state != NCCL_OFI_RDMA_REQ_COMPLETED
+		&& OFI_LIKELY(state != NCCL_OFI_RDMA_REQ_ERROR)) {
+		ret = rdma_ep_progress(ep);
 		if (OFI_UNLIKELY(ret != 0))
 			goto exit;
+		state = rdma_req_get_state(req);
 	}
 
 	/* Determine whether the request has finished without error and free if done */
-	if (OFI_LIKELY(req->state == NCCL_OFI_RDMA_REQ_COMPLETED)) {
-
-		size_t req_size;
-		nccl_net_ofi_mutex_lock(&req->req_lock);
-
-		req_size = req->size;
-
-		nccl_net_ofi_mutex_unlock(&req->req_lock);
-
+	if (OFI_LIKELY(state == NCCL_OFI_RDMA_REQ_COMPLETED)) {
+		/* The acquire load of the state orders this read
+		 * after all completion updates of the request */
 		if (size)
-			*size = req_size;
+			*size = __atomic_load_n(&req->size, __ATOMIC_RELAXED);
 		/* Mark as done */
 		*done = 1;
 
@@ -2805,11 +4587,12 @@ static int test(nccl_net_ofi_req_t *base_req, int *done, int *size)
 			NCCL_OFI_TRACE_SEND_END(req->dev_id, base_comm, req);
 		} else if (req->type == NCCL_OFI_RDMA_RECV) {
 			NCCL_OFI_TRACE_RECV_END(req->dev_id, base_comm, req);
+			rdma_recv_comm_note_recv_done((nccl_net_ofi_rdma_recv_comm_t *)base_comm, req);
 		}
 
 		assert(req->free);
 		req->free(req, true);
-	} else if (OFI_UNLIKELY(req->state == NCCL_OFI_RDMA_REQ_ERROR)) {
+	} else if (OFI_UNLIKELY(state == NCCL_OFI_RDMA_REQ_ERROR)) {
 		ret = -EINVAL;
 		goto exit;
 	}
@@ -2819,62 +4602,30 @@ static int test(nccl_net_ofi_req_t *base_req, int *done, int *size)
 }
 
 /*
- * @brief	Reset send connect request of listen communicator
- *		by recv connect responce request
+ * @brief	Initialize the connect response request of a connection
+ *		being accepted
  *
  * @param	l_comm
- *		Valid listen communicator that stores a request of type
- *		`NCCL_OFI_RDMA_SEND_CONN_RESP'
+ *		Valid listen communicator that received the connection
+ * @param	conn
+ *		Connection being accepted
  */
-static void prepare_send_conn_resp_req(nccl_net_ofi_rdma_listen_comm_t *l_comm)
+static void prepare_send_conn_resp_req(nccl_net_ofi_rdma_listen_comm_t *l_comm,
+				       nccl_net_ofi_rdma_listen_conn_t *conn)
 {
-	nccl_net_ofi_rdma_req_t *req = &l_comm->req;
-	assert(req->type == NCCL_OFI_RDMA_RECV_CONN);
+	nccl_net_ofi_rdma_req_t *req = &conn->req;
 
 	req->type = NCCL_OFI_RDMA_SEND_CONN_RESP;
 	req->free = free_invalid;
-	req->size = 0;
-	req->ncompls = 0;
-
-	req->state = NCCL_OFI_RDMA_REQ_CREATED;
-}
-
-
-static inline void rdma_req_init_ctx(nccl_net_ofi_rdma_req_t *req)
-{
-	for (uint16_t i = 0; i < MAX_NUM_RAILS; ++i) {
-		req->ctx[i].handle_cq_entry = rdma_req_handle_cq_entry;
-		req->ctx[i].handle_error_entry = rdma_req_handle_error_entry;
-	}
-}
-
-
-/*
- * @brief	Initialize request of listen communicator
- *
- * @param	Valid listen communicator object
- */
-static int prepare_recv_conn_req(nccl_net_ofi_rdma_listen_comm_t *l_comm)
-{
-	int ret;
-	nccl_net_ofi_rdma_req_t *req = &l_comm->req;
-
-	req->type = NCCL_OFI_RDMA_RECV_CONN;
-	req->free = free_invalid;
 	req->base.test = test;
-	req->state = NCCL_OFI_RDMA_REQ_PENDING;
 	req->comm = &l_comm->base.base;
 	req->dev_id = l_comm->base.base.dev_id;
-	/* Initialize mutex for request access */
-	ret = nccl_net_ofi_mutex_init(&req->req_lock, NULL);
-	if (OFI_UNLIKELY(ret != 0)) {
-		NCCL_OFI_WARN("Unable to initialize mutex");
-		return -ret;
-	}
+	req->size = 0;
+	req->ncompls = 0;
 
-	rdma_req_init_ctx(req);
+	req->state = NCCL_OFI_RDMA_REQ_CREATED;
 
-	return 0;
+	rdma_req_init_ofi_contexts(req, MAX_NUM_RAILS);
 }
 
 
@@ -2946,6 +4697,54 @@ static int dereg_mr(nccl_net_ofi_rdma_mr_handle_t *mr_handle,
 }
 
 
+/*
+ * @brief	Cache descriptors and remote keys of all rails of a
+ *		memory registration handle
+ *
+ * Remote keys are stored in both control message encodings, so that
+ * a control message can be built with a single copy.
+ */
+static void rdma_mr_handle_cache_keys(nccl_net_ofi_rdma_mr_handle_t *mr_handle)
+{
+	bool rkeys_valid = true;
+	bool short_rkeys_valid = true;
+
+	for (uint16_t rail_id = 0; rail_id != mr_handle->num_rails; ++rail_id) {
+		mr_handle->desc[rail_id] = fi_mr_desc(mr_handle->mr[rail_id]);
+
+		uint64_t rkey = fi_mr_key(mr_handle->mr[rail_id]);
+		if (rkey == FI_KEY_NOTAVAIL) {
+			rkeys_valid = false;
+			continue;
+		}
+
+		mr_handle->long_rkeys[rail_id] = rkey;
+		if (rkey > (1ULL << (NCCL_NET_OFI_CTRL_MSG_SHORT_KEY_SIZE * 8)) - 1) {
+			short_rkeys_valid = false;
+		} else {
+			mr_handle->short_rkeys[rail_id] = (uint32_t)rkey;
+		}
+	}
+
+	mr_handle->short_rkeys_valid = short_rkeys_valid;
+	mr_handle->rkeys_valid = rkeys_valid;
+}
+
+
+/*
+ * @brief	Return remote key of rail `rail_id' of a memory
+ *		registration, or FI_KEY_NOTAVAIL if not available yet
+ */
+static inline uint64_t rdma_mr_handle_get_rkey(nccl_net_ofi_rdma_mr_handle_t *mr_handle,
+					       uint16_t rail_id)
+{
+	if (OFI_LIKELY(mr_handle->rkeys_valid)) {
+		return mr_handle->long_rkeys[rail_id];
+	}
+	return fi_mr_key(mr_handle->mr[rail_id]);
+}
+
+
 static inline int reg_mr_on_device(nccl_net_ofi_rdma_domain_t *domain,
 				   nccl_ofi_mr_ckey_ref ckey,
 				   int type,
@@ -2993,6 +4792,7 @@ static inline int reg_mr_on_device(nccl_net_ofi_rdma_domain_t *domain,
 	}
 
 	/* Register memory on each rail */
+	assert(num_rails <= MAX_NUM_RAILS);
 	ret_handle->num_rails = num_rails;
 	for (uint16_t rail_id = 0; rail_id != num_rails; ++rail_id) {
 		nccl_net_ofi_rdma_domain_rail_t *domain_rail = rdma_domain_get_rail(domain, rail_id);
@@ -3004,6 +4804,9 @@ static inline int reg_mr_on_device(nccl_net_ofi_rdma_domain_t *domain,
 		}
 	}
 
+	rdma_mr_handle_cache_keys(ret_handle);
+	ret_handle->host_mem = (type == NCCL_PTR_HOST);
+
 	*mhandle = ret_handle;
 	return 0;
 
@@ -3271,6 +5074,29 @@ static inline nccl_net_ofi_rdma_req_t *allocate_req(nccl_ofi_freelist_t *fl)
 	return req;
 }
 
+/*
+ * @brief	Assign a communicator request from the request freelist of
+ *		the endpoint, unless the communicator already holds its
+ *		maximum number of requests
+ */
+static inline nccl_net_ofi_rdma_req_t *allocate_comm_req(nccl_net_ofi_rdma_comm_reqs_t *reqs)
+{
+	if (OFI_UNLIKELY(__atomic_add_fetch(&reqs->num_allocated, 1, __ATOMIC_RELAXED) >
+			 reqs->max_allocated)) {
+		__atomic_fetch_sub(&reqs->num_allocated, 1, __ATOMIC_RELAXED);
+		NCCL_OFI_WARN("Communicator already holds %zu requests", reqs->max_allocated);
+		return NULL;
+	}
+
+	nccl_net_ofi_rdma_req_t *req = allocate_req(reqs->fl);
+	if (OFI_UNLIKELY(req == NULL)) {
+		__atomic_fetch_sub(&reqs->num_allocated, 1, __ATOMIC_RELAXED);
+		NCCL_OFI_WARN("Endpoint request freelist exhausted; see RDMA_EP_MAX_COMMS");
+	}
+
+	return req;
+}
+
 /**
  * @brief	Allocate a new control message that the receiver will
  *		send to the sender describing the recv buffer.
@@ -3288,7 +5114,7 @@ static inline int insert_send_ctrl_req(
 	nccl_net_ofi_rdma_domain_t *domain = rdma_endpoint_get_domain(ep);
 	assert(domain != NULL);
 	nccl_net_ofi_scheduler_t *scheduler = domain->scheduler;
-	nccl_net_ofi_rdma_req_t *send_ctrl_req = allocate_req(r_comm->nccl_ofi_reqs_fl);
+	nccl_net_ofi_rdma_req_t *send_ctrl_req = allocate_comm_req(&r_comm->reqs);
 	if (OFI_UNLIKELY(send_ctrl_req == NULL)) {
 		NCCL_OFI_WARN("Unable to get NCCL OFI send control request for device %d",
 						dev_id);
@@ -3353,25 +5179,28 @@ static inline int insert_send_ctrl_req(
 	ctrl_msg->buff_addr = (uint64_t)buff;
 	ctrl_msg->buff_len = size;
 
-	uint16_t rail_id = 0;
-	for (; rail_id < r_comm->num_rails; rail_id++) {
-		uint64_t rkey = fi_mr_key(buff_mr_handle->mr[rail_id]);
-
-		if (rkey == FI_KEY_NOTAVAIL) {
+	/* Keys that were not available at registration time are
+	 * queried again */
+	if (OFI_UNLIKELY(!buff_mr_handle->rkeys_valid)) {
+		rdma_mr_handle_cache_keys(buff_mr_handle);
+		if (!buff_mr_handle->rkeys_valid) {
 			NCCL_OFI_WARN("RDMA write buffers should be pre-registered");
 			return -ENOENT;
 		}
+	}
 
-		if (ep->use_long_rkeys) {
-			ctrl_msg->long_buff_mr_key[rail_id] = rkey;
-		} else {
-			if (rkey > (1ULL << (NCCL_NET_OFI_CTRL_MSG_SHORT_KEY_SIZE * 8)) - 1) {
-				NCCL_OFI_WARN("Libfabric returned rkey larger than declared rkey size: %" PRIu64,
-					      rkey);
-				return -ENOTSUP;
-			}
-			ctrl_msg->short_buff_mr_key[rail_id] = rkey;
+	assert(r_comm->num_rails == buff_mr_handle->num_rails);
+	if (ep->use_long_rkeys) {
+		memcpy(ctrl_msg->long_buff_mr_key, buff_mr_handle->long_rkeys,
+		       r_comm->num_rails * NCCL_NET_OFI_CTRL_MSG_LONG_KEY_SIZE);
+	} else {
+		if (OFI_UNLIKELY(!buff_mr_handle->short_rkeys_valid)) {
+			NCCL_OFI_WARN("Libfabric returned rkey larger than declared rkey size: %zu bytes",
+				      NCCL_NET_OFI_CTRL_MSG_SHORT_KEY_SIZE);
+			return -ENOTSUP;
 		}
+		memcpy(ctrl_msg->short_buff_mr_key, buff_mr_handle->short_rkeys,
+		       r_comm->num_rails * NCCL_NET_OFI_CTRL_MSG_SHORT_KEY_SIZE);
 	}
 
 	rdma_req_recv_data_t *recv_data = get_recv_data(recv_req);
@@ -3391,7 +5220,7 @@ static inline int insert_recv_segms_req(
 				nccl_net_ofi_rdma_req_t *recv_req)
 {
 	/* Allocate recv segms request */
-	nccl_net_ofi_rdma_req_t *recv_segms_req = allocate_req(r_comm->nccl_ofi_reqs_fl);
+	nccl_net_ofi_rdma_req_t *recv_segms_req = allocate_comm_req(&r_comm->reqs);
 	if (OFI_UNLIKELY(recv_segms_req == NULL)) {
 		NCCL_OFI_WARN("Unable to get NCCL OFI receive segments request for device %d",
 						dev_id);
@@ -3430,7 +5259,7 @@ static inline int allocate_rdma_recv_req(
 	rdma_req_recv_data_t *recv_data;
 
 	/* Allocate receive request */
-	nccl_net_ofi_rdma_req_t *req = allocate_req(r_comm->nccl_ofi_reqs_fl);
+	nccl_net_ofi_rdma_req_t *req = allocate_comm_req(&r_comm->reqs);
 	if (OFI_UNLIKELY(req == NULL)) {
 		NCCL_OFI_WARN("Unable to get NCCL OFI receive request for device %d",
 						dev_id);
@@ -3448,6 +5277,7 @@ static inline int allocate_rdma_recv_req(
 	/* In the case of early completion, only expect the completion for control msg itself */
 	recv_data->total_num_compls = recv_completion_optional ? 1 : 2;
 	recv_data->eager_copy_req = NULL;
+	recv_data->pull_read_req = NULL;
 	recv_data->dst_buff = buff;
 	recv_data->dst_len = size;
 	recv_data->dest_mr_handle = buff_mr_handle;
@@ -3470,6 +5300,82 @@ static inline int allocate_rdma_recv_req(
 	return 0;
 }
 
+static int alloc_rdma_read_req(nccl_net_ofi_rdma_recv_comm_t *r_comm,
+			       nccl_net_ofi_rdma_ep_t *ep,
+			       void *buff, size_t size,
+			       nccl_net_ofi_rdma_mr_handle_t *buff_mr_handle,
+			       uint64_t remote_buff,
+			       uint64_t remote_mr_key,
+			       nccl_net_ofi_rdma_req_t **ret_req);
+
+/**
+ * @brief	Prepare receive request `recv_req' to pull the message
+ *		advertised by the pull message in `rx_buff_req'
+ *
+ * The ctrl message of the receive request is turned into the
+ * PULL_DONE message, which is sent once the data has been read. The
+ * read is striped across the active rails like a send would be. No
+ * read request is allocated if there is no data to read.
+ */
+static int alloc_pull_read_req(nccl_net_ofi_rdma_req_t *recv_req,
+			       nccl_net_ofi_rdma_recv_comm_t *r_comm,
+			       nccl_net_ofi_rdma_req_t *rx_buff_req)
+{
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
+	nccl_net_ofi_rdma_domain_t *domain = rdma_endpoint_get_domain(ep);
+	assert(domain != NULL);
+	nccl_net_ofi_scheduler_t *scheduler = domain->scheduler;
+	rdma_req_recv_data_t *recv_data = get_recv_data(recv_req);
+	nccl_net_ofi_rdma_ctrl_msg_t *pull_msg = get_rx_ctrl_msg(get_rx_buff_data(rx_buff_req));
+	size_t read_len = std::min((size_t)pull_msg->buff_len, recv_data->dst_len);
+
+	/* The sender waits for the PULL_DONE message, so its send
+	 * completion is expected even if the receive completion is
+	 * optional */
+	recv_data->total_num_compls = 2;
+
+	nccl_net_ofi_rdma_ctrl_msg_t *done_msg =
+		rdma_send_ctrl_get_msg(get_send_ctrl_data(recv_data->send_ctrl_req));
+	done_msg->type = NCCL_OFI_RDMA_MSG_PULL_DONE;
+	done_msg->buff_len = read_len;
+
+	if (read_len == 0) {
+		return 0;
+	}
+
+	nccl_net_ofi_rdma_req_t *read_req = NULL;
+	int ret = alloc_rdma_read_req(r_comm, ep, recv_data->dst_buff, read_len,
+				      recv_data->dest_mr_handle, pull_msg->buff_addr, 0, &read_req);
+	if (OFI_UNLIKELY(ret != 0)) {
+		return ret;
+	}
+	read_req->msg_seq_num = recv_req->msg_seq_num;
+
+	rdma_req_rma_op_data_t *rma_op_data = req_get_rma_op_data(read_req, NCCL_OFI_RDMA_READ);
+	rma_op_data->recv_req = recv_req;
+	rma_op_data->pull_rx_buff_req = rx_buff_req;
+	/* Stripe large reads across all data rails */
+	if (read_len > ofi_nccl_min_stripe_size()) {
+		ret = rdma_recv_comm_activate_rails(r_comm);
+		if (OFI_UNLIKELY(ret != 0)) {
+			read_req->free(read_req, false);
+			return ret;
+		}
+	}
+	rma_op_data->schedule = scheduler->get_schedule(scheduler, read_len,
+							__atomic_load_n(&r_comm->num_active_rails,
+									__ATOMIC_ACQUIRE));
+	if (OFI_UNLIKELY(rma_op_data->schedule == NULL)) {
+		read_req->free(read_req, false);
+		return -EINVAL;
+	}
+	rma_op_data->total_num_compls = rma_op_data->schedule->num_xfer_infos;
+
+	recv_data->pull_read_req = read_req;
+
+	return 0;
+}
+
 static inline int insert_rdma_recv_req_into_msgbuff(nccl_net_ofi_rdma_recv_comm_t *r_comm,
 	bool eager, nccl_net_ofi_rdma_req_t **ret_req)
 {
@@ -3521,18 +5427,12 @@ static inline int insert_rdma_recv_req_into_msgbuff(nccl_net_ofi_rdma_recv_comm_
 static int process_cq_if_pending(nccl_net_ofi_rdma_ep_t *ep)
 {
 	/* Process the CQ if there are any pending requests */
-	nccl_net_ofi_mutex_lock(&ep->pending_reqs_lock);
-	bool is_deque_empty = ep->pending_reqs_queue->empty();
-	nccl_net_ofi_mutex_unlock(&ep->pending_reqs_lock);
-	if (!is_deque_empty) {
-		int ret = ofi_process_cq(ep);
+	if (rdma_ep_has_pending_reqs(ep)) {
+		int ret = rdma_ep_progress(ep);
 		if (ret != 0) {
 			return ret;
 		}
-		nccl_net_ofi_mutex_lock(&ep->pending_reqs_lock);
-		is_deque_empty = ep->pending_reqs_queue->empty();
-		nccl_net_ofi_mutex_unlock(&ep->pending_reqs_lock);
-		if (!is_deque_empty) {
+		if (rdma_ep_has_pending_reqs(ep)) {
 			/* Network is still busy. */
 			return -EAGAIN;
 		}
@@ -3555,6 +5455,7 @@ static int recv(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 	nccl_net_ofi_rdma_mr_handle_t **mr_handles = (nccl_net_ofi_rdma_mr_handle_t **)mhandles;
 	uint16_t msg_seq_num = 0;
 	bool eager = false;
+	bool pull = false;
 	int i;
 	bool recv_completion_optional = false;
 
@@ -3617,8 +5518,13 @@ static int recv(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 			ret = -EINVAL;
 			goto error;
 		} else if (OFI_LIKELY(type == NCCL_OFI_MSGBUFF_BUFF)) {
-			/* This is an eager message */
-			eager = true;
+			/* This is an eager message, or a pull message if it
+			   was received into a ctrl rx buffer */
+			if (((nccl_net_ofi_rdma_req_t *)elem)->type == NCCL_OFI_RDMA_CTRL_RX_BUFF) {
+				pull = true;
+			} else {
+				eager = true;
+			}
 		} else {
 			NCCL_OFI_WARN("Invalid type in msg buff");
 			ret = -EINVAL;
@@ -3661,7 +5567,12 @@ static int recv(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 
 	recv_data = get_recv_data(req);
 
-	if (eager) {
+	if (pull) {
+		ret = alloc_pull_read_req(req, r_comm, (nccl_net_ofi_rdma_req_t *)elem);
+		if (ret != 0) {
+			goto error;
+		}
+	} else if (eager) {
 		nccl_net_ofi_rdma_req_t *rx_buff_req = (nccl_net_ofi_rdma_req_t *)elem;
 		rdma_req_rx_buff_data_t *rx_buff_data = get_rx_buff_data(rx_buff_req);
 		if (rx_buff_data->recv_len == 0) {
@@ -3680,7 +5591,7 @@ static int recv(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 		}
 	}
 
-	ret = insert_rdma_recv_req_into_msgbuff(r_comm, eager, &req);
+	ret = insert_rdma_recv_req_into_msgbuff(r_comm, eager || pull, &req);
 	if (ret != 0 || req == NULL) {
 		goto free_req;
 	}
@@ -3690,30 +5601,45 @@ static int recv(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 
 	NCCL_OFI_TRACE_RECV(dev_id, r_comm, sizes[0], req, base_req);
 
-	/* Send ctrl msg */
-	nccl_net_ofi_mutex_lock(&r_comm->ctrl_counter_lock);
-	r_comm->n_ctrl_sent += 1;
-	nccl_net_ofi_mutex_unlock(&r_comm->ctrl_counter_lock);
-	ret = receive_progress(recv_data->send_ctrl_req, true);
-	if (OFI_UNLIKELY(ret != 0)) {
-		/* TODO: Remove req from message buffer */
-		goto error;
-	}
-
-	if (eager) {
-		if (recv_data->eager_copy_req == NULL) {
-			/* If we don't need to do eager copy, this recv is already complete */
-			ret = inc_req_completion(req, 0, recv_data->total_num_compls);
-			if (ret != 0) {
-				goto error;
-			}
+	if (pull) {
+		/* Read the data. The ctrl msg (PULL_DONE) is sent once
+		   the reads completed. */
+		if (recv_data->pull_read_req == NULL) {
+			ret = finish_pull_recv(req, (nccl_net_ofi_rdma_req_t *)elem, 0);
 		} else {
-			/* Post eager copy */
-			ret = receive_progress(recv_data->eager_copy_req, true);
-			if (ret != 0) {
-				NCCL_OFI_WARN("Failed to issue eager read");
-				/* TODO: Remove req from message buffer */
-				goto error;
+			ret = receive_progress(recv_data->pull_read_req, true);
+		}
+		if (OFI_UNLIKELY(ret != 0)) {
+			NCCL_OFI_WARN("Failed to issue pull read");
+			/* TODO: Remove req from message buffer */
+			goto error;
+		}
+	} else {
+		/* Send ctrl msg */
+		nccl_net_ofi_mutex_lock(&r_comm->ctrl_counter_lock);
+		r_comm->n_ctrl_sent += 1;
+		nccl_net_ofi_mutex_unlock(&r_comm->ctrl_counter_lock);
+		ret = receive_progress(recv_data->send_ctrl_req, true);
+		if (OFI_UNLIKELY(ret != 0)) {
+			/* TODO: Remove req from message buffer */
+			goto error;
+		}
+
+		if (eager) {
+			if (recv_data->eager_copy_req == NULL) {
+				/* If we don't need to do eager copy, this recv is already complete */
+				ret = inc_req_completion(req, 0, recv_data->total_num_compls);
+				if (ret != 0) {
+					goto error;
+				}
+			} else {
+				/* Post eager copy */
+				ret = receive_progress(recv_data->eager_copy_req, true);
+				if (ret != 0) {
+					NCCL_OFI_WARN("Failed to issue eager read");
+					/* TODO: Remove req from message buffer */
+					goto error;
+				}
 			}
 		}
 	}
@@ -3833,6 +5759,8 @@ static inline void free_rdma_recv_comm(nccl_net_ofi_rdma_recv_comm_t *r_comm) {
         if (r_comm->rails) {
             free(r_comm->rails);
         }
+        free(r_comm->lazy_remote_ep_names);
+        delete r_comm->eager_copied_buffs;
         free(r_comm);
     }
 }
@@ -3866,12 +5794,6 @@ static int recv_comm_destroy(nccl_net_ofi_rdma_recv_comm_t *r_comm)
 		return ret;
 	}
 
-	ret = nccl_ofi_freelist_fini(r_comm->nccl_ofi_reqs_fl);
-	if (ret != 0) {
-		NCCL_OFI_WARN("Call to nccl_ofi_freelist_fini failed: %d", ret);
-		return ret;
-	}
-
 	if (!nccl_ofi_msgbuff_destroy(r_comm->msgbuff)) {
 		NCCL_OFI_WARN("Failed to destroy msgbuff (r_comm)");
 		ret = -EINVAL;
@@ -3896,6 +5818,23 @@ static int recv_comm_destroy(nccl_net_ofi_rdma_recv_comm_t *r_comm)
 		return ret;
 	}
 
+	if (r_comm->num_recvs_completed > 0) {
+		NCCL_OFI_INFO(NCCL_NET, "Receive communicator %p: %lu flush reads for %lu received messages (%lu flushes coalesced, %lu elided, %lu not elided for lack of tracking space)",
+			      r_comm, r_comm->num_flush_reads, r_comm->num_recvs_completed,
+			      r_comm->num_flushes_coalesced, r_comm->num_flushes_elided,
+			      r_comm->num_flush_elisions_skipped);
+	}
+
+	ret = nccl_net_ofi_mutex_destroy(&r_comm->flush_lock);
+	if (ret != 0) {
+		return ret;
+	}
+
+	ret = nccl_net_ofi_mutex_destroy(&r_comm->rails_lock);
+	if (ret != 0) {
+		return ret;
+	}
+
 	free_rdma_recv_comm(r_comm);
 
 	ret = ep->base.release_ep(&ep->base, false, false);
@@ -3909,7 +5848,7 @@ static int recv_comm_destroy(nccl_net_ofi_rdma_recv_comm_t *r_comm)
  */
 static inline int recv_comm_insert_send_close_req(nccl_net_ofi_rdma_recv_comm_t *r_comm)
 {
-	nccl_net_ofi_rdma_req_t *send_close_req = allocate_req(r_comm->nccl_ofi_reqs_fl);
+	nccl_net_ofi_rdma_req_t *send_close_req = allocate_comm_req(&r_comm->reqs);
 	if (OFI_UNLIKELY(send_close_req == NULL)) {
 		return -ENOMEM;
 	}
@@ -3990,9 +5929,7 @@ static inline int progress_closing_recv_comm(nccl_net_ofi_rdma_recv_comm_t *r_co
 	} else /* (r_comm->send_close_req != NULL) */ {
 
 		/* Waiting for close message delivery */
-		nccl_net_ofi_mutex_lock(&r_comm->send_close_req->req_lock);
-		nccl_net_ofi_rdma_req_state_t state = r_comm->send_close_req->state;
-		nccl_net_ofi_mutex_unlock(&r_comm->send_close_req->req_lock);
+		nccl_net_ofi_rdma_req_state_t state = rdma_req_get_state(r_comm->send_close_req);
 
 		if (state == NCCL_OFI_RDMA_REQ_ERROR) {
 			NCCL_OFI_WARN("Send close message complete with error");
@@ -4000,58 +5937,14 @@ static inline int progress_closing_recv_comm(nccl_net_ofi_rdma_recv_comm_t *r_co
 
 		} else if (state == NCCL_OFI_RDMA_REQ_COMPLETED) {
 			/* Ready to destroy */
-			return 1;
-		}
-	}
-
-	return 0;
-}
-
-
-/**
- * Iterate the list of r_comm's that are pending cleanup, make progress
- * on each one, and destroy resources if the close message and required
- * control messages have been delivered.
- *
- * This function is non-blocking.
- *
- * Note: caller must own the comm_cleanup_list_lock when calling
- * this function
- */
-static int recv_comm_process_all_finalizing(void)
-{
-	int ret = 0;
-
-	for (auto it = r_comm_cleanup_list->begin(); it != r_comm_cleanup_list->end();) {
-
-		nccl_net_ofi_rdma_recv_comm_t *r_comm = *it;
-
-		nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)
-			r_comm->base.base.ep;
-		ret = ofi_process_cq(ep);
-		if (ret != 0) {
-			goto exit;
-		}
-
-		ret = progress_closing_recv_comm(r_comm);
-		if (ret < 0) {
-			goto exit;
-		}
-		if (ret == 1) {
-			it = r_comm_cleanup_list->erase(it);
-			ret = recv_comm_destroy(r_comm);
-			if (ret != 0) {
-				goto exit;
-			}
-		} else {
-			++it;
+			return 1;
 		}
 	}
 
-exit:
-	return ret;
+	return 0;
 }
 
+
 static inline void free_rdma_send_comm(nccl_net_ofi_rdma_send_comm_t *s_comm) {
     if (s_comm) {
         if (s_comm->control_rails) {
@@ -4060,6 +5953,7 @@ static inline void free_rdma_send_comm(nccl_net_ofi_rdma_send_comm_t *s_comm) {
         if (s_comm->rails) {
             free(s_comm->rails);
         }
+        free(s_comm->lazy_remote_ep_names);
         free(s_comm);
     }
 }
@@ -4074,13 +5968,6 @@ static int send_comm_destroy(nccl_net_ofi_rdma_send_comm_t *s_comm)
 		req->free(req, false);
 	}
 
-	/* Release request freelist */
-	ret = nccl_ofi_freelist_fini(s_comm->nccl_ofi_reqs_fl);
-	if (ret != 0) {
-		NCCL_OFI_WARN("Call to nccl_ofi_freelist_fini failed: %d", ret);
-		return ret;
-	}
-
 	if (!nccl_ofi_msgbuff_destroy(s_comm->msgbuff)) {
 		NCCL_OFI_WARN("Failed to destroy msgbuff (s_comm)");
 		ret = -EINVAL;
@@ -4114,64 +6001,138 @@ static int send_comm_destroy(nccl_net_ofi_rdma_send_comm_t *s_comm)
 }
 
 /**
- * Iterate the list of s_comm's that are pending cleanup, make progress
- * on each one, and destroy resources if the close message and required
- * control messages have been received.
+ * Return true if a closing send communicator is safe to destroy.
+ */
+static inline bool send_comm_ready_to_destroy(nccl_net_ofi_rdma_send_comm_t *s_comm)
+{
+	nccl_net_ofi_mutex_lock(&s_comm->ctrl_recv_lock);
+
+	/**
+	 * We claim the send communicator is safe to destroy if one of
+	 * the following is true:
+	 *
+	 * 1. We have received the close message from the receiver, and
+	 *    have received all control messages that were sent by the
+	 *    receiver
+	 * 2. We did not receive any control messages from the receiver.
+	 *    In this case, we assume that the receive communicator was
+	 *    never established, and we will never receive a close
+	 *    message.
+	 */
+	bool ready_to_destroy = (s_comm->received_close_message) ?
+				(s_comm->n_ctrl_received == s_comm->n_ctrl_expected) :
+				(s_comm->n_ctrl_received == 0);
+
+	nccl_net_ofi_mutex_unlock(&s_comm->ctrl_recv_lock);
+
+	return ready_to_destroy;
+}
+
+/**
+ * Add a closed communicator to the closing queue of its endpoint, and
+ * the endpoint to the list of closing endpoints if needed.
+ *
+ * Note: caller must own the comm_cleanup_list_lock when calling
+ * this function
+ */
+static void rdma_ep_add_closing_comm(nccl_net_ofi_rdma_ep_t *ep,
+				     nccl_net_ofi_rdma_send_comm_t *s_comm,
+				     nccl_net_ofi_rdma_recv_comm_t *r_comm)
+{
+	if (ep->closing_s_comms == NULL) {
+		assert(ep->closing_r_comms == NULL);
+		ep->closing_s_comms = new std::deque<nccl_net_ofi_rdma_send_comm_t *>;
+		ep->closing_r_comms = new std::deque<nccl_net_ofi_rdma_recv_comm_t *>;
+		closing_ep_list->push_back(ep);
+	}
+
+	if (s_comm != NULL) {
+		ep->closing_s_comms->push_back(s_comm);
+	}
+	if (r_comm != NULL) {
+		ep->closing_r_comms->push_back(r_comm);
+	}
+}
+
+/**
+ * Make progress on the closing comms of an endpoint, and destroy the
+ * comms whose close message and required control messages have been
+ * delivered. The CQs of the endpoint are polled once for all of its
+ * closing comms.
+ *
+ * Destroying the last comm of the endpoint may release the endpoint,
+ * so it is not accessed after the ready comms are destroyed.
  *
  * This function is non-blocking.
  *
+ * @param	ep_iter
+ *		Position of the endpoint in closing_ep_list. Advanced
+ *		past the endpoint on return.
+ *
  * Note: caller must own the comm_cleanup_list_lock when calling
  * this function
  */
-static int send_comm_process_all_finalizing(void)
+static int rdma_ep_process_closing_comms(std::deque<nccl_net_ofi_rdma_ep_t *>::iterator &ep_iter)
 {
+	nccl_net_ofi_rdma_ep_t *ep = *ep_iter;
+	std::vector<nccl_net_ofi_rdma_recv_comm_t *> ready_r_comms;
+	std::vector<nccl_net_ofi_rdma_send_comm_t *> ready_s_comms;
 	int ret = 0;
 
-	for (auto it = s_comm_cleanup_list->begin(); it != s_comm_cleanup_list->end();) {
-
-		nccl_net_ofi_rdma_send_comm_t *s_comm = *it;
+	ret = rdma_ep_progress(ep);
+	if (ret != 0) {
+		++ep_iter;
+		return ret;
+	}
 
-		nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)
-			s_comm->base.base.ep;
-		ret = ofi_process_cq(ep);
-		if (ret != 0) {
-			goto exit;
+	for (auto it = ep->closing_r_comms->begin(); it != ep->closing_r_comms->end();) {
+		ret = progress_closing_recv_comm(*it);
+		if (ret < 0) {
+			++ep_iter;
+			return ret;
 		}
+		if (ret == 1) {
+			ready_r_comms.push_back(*it);
+			it = ep->closing_r_comms->erase(it);
+		} else {
+			++it;
+		}
+	}
+	ret = 0;
 
-		nccl_net_ofi_mutex_lock(&s_comm->ctrl_recv_lock);
-
-		/**
-		 * We claim the send communicator is safe to destroy if one of
-		 * the following is true:
-		 *
-		 * 1. We have received the close message from the receiver, and
-		 *    have received all control messages that were sent by the
-		 *    receiver
-		 * 2. We did not receive any control messages from the receiver.
-		 *    In this case, we assume that the receive communicator was
-		 *    never established, and we will never receive a close
-		 *    message.
-		 */
-		bool ready_to_destroy = (s_comm->received_close_message) ?
-					(s_comm->n_ctrl_received == s_comm->n_ctrl_expected) :
-					(s_comm->n_ctrl_received == 0);
-
-		nccl_net_ofi_mutex_unlock(&s_comm->ctrl_recv_lock);
-
-		if (ready_to_destroy) {
-			it = s_comm_cleanup_list->erase(it);
-
-			ret = send_comm_destroy(s_comm);
-			if (ret != 0) {
-				goto exit;
-			}
+	for (auto it = ep->closing_s_comms->begin(); it != ep->closing_s_comms->end();) {
+		if (send_comm_ready_to_destroy(*it)) {
+			ready_s_comms.push_back(*it);
+			it = ep->closing_s_comms->erase(it);
 		} else {
 			++it;
 		}
+	}
 
+	if (ep->closing_r_comms->empty() && ep->closing_s_comms->empty()) {
+		delete ep->closing_r_comms;
+		delete ep->closing_s_comms;
+		ep->closing_r_comms = NULL;
+		ep->closing_s_comms = NULL;
+		ep_iter = closing_ep_list->erase(ep_iter);
+	} else {
+		++ep_iter;
+	}
+
+	for (nccl_net_ofi_rdma_recv_comm_t *r_comm : ready_r_comms) {
+		ret = recv_comm_destroy(r_comm);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	for (nccl_net_ofi_rdma_send_comm_t *s_comm : ready_s_comms) {
+		ret = send_comm_destroy(s_comm);
+		if (ret != 0) {
+			return ret;
+		}
 	}
 
-exit:
 	return ret;
 }
 
@@ -4186,17 +6147,13 @@ static int comm_close_handler(void)
 {
 	int ret = 0;
 
-	while (!(s_comm_cleanup_list->empty()) ||
-	       !(r_comm_cleanup_list->empty())) {
-
-		ret = recv_comm_process_all_finalizing();
-		if (ret != 0) {
-			return ret;
-		}
+	while (!closing_ep_list->empty()) {
 
-		ret = send_comm_process_all_finalizing();
-		if (ret != 0) {
-			return ret;
+		for (auto it = closing_ep_list->begin(); it != closing_ep_list->end();) {
+			ret = rdma_ep_process_closing_comms(it);
+			if (ret != 0) {
+				return ret;
+			}
 		}
 
 		/* This function is only blocking on last comm close */
@@ -4238,7 +6195,7 @@ static int recv_close_deferred(nccl_net_ofi_recv_comm_t *recv_comm)
 
 	/* Defer cleanup until we deliver all outstanding control messages
 	   and deliver the close message */
-	r_comm_cleanup_list->push_back(r_comm);
+	rdma_ep_add_closing_comm((nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep, NULL, r_comm);
 
 	assert(num_open_comms > 0);
 	num_open_comms--;
@@ -4255,13 +6212,12 @@ static int rdma_comm_alloc_flush_req(nccl_net_ofi_rdma_recv_comm_t *r_comm,
 					nccl_net_ofi_rdma_mr_handle_t *buff_mr_handle,
 					nccl_net_ofi_rdma_req_t **ret_req)
 {
-	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
 	int dev_id = r_comm->base.base.dev_id;
 	rdma_req_flush_data_t *flush_data = NULL;
 	*ret_req = NULL;
 
 	/* Allocate NCCL OFI request */
-	nccl_net_ofi_rdma_req_t *req = allocate_req(r_comm->nccl_ofi_reqs_fl);
+	nccl_net_ofi_rdma_req_t *req = allocate_comm_req(&r_comm->reqs);
 	if (OFI_UNLIKELY(req == NULL)) {
 		NCCL_OFI_WARN("Unable to get NCCL OFI request for device %d",
 			      dev_id);
@@ -4275,7 +6231,11 @@ static int rdma_comm_alloc_flush_req(nccl_net_ofi_rdma_recv_comm_t *r_comm,
 	flush_data = get_flush_data(req);
 	flush_data->data = buff;
 	flush_data->mr_handle = buff_mr_handle;
-	flush_data->total_num_compls = ep->num_rails;
+	/* One flush read per data rail the sender may have written on */
+	flush_data->total_num_compls = __atomic_load_n(&r_comm->num_active_rails, __ATOMIC_ACQUIRE);
+	flush_data->seq = 0;
+	flush_data->joined_head = NULL;
+	flush_data->joined_next = NULL;
 
 	*ret_req = req;
 
@@ -4352,6 +6312,23 @@ static int flush(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 		goto exit;
 	}
 
+	if (ofi_nccl_rdma_flush_coalesce() != 0) {
+		nccl_net_ofi_mutex_lock(&r_comm->flush_lock);
+		bool eager_copied = rdma_recv_comm_take_eager_copied_buff(r_comm, buffers[flush_n]);
+		nccl_net_ofi_mutex_unlock(&r_comm->flush_lock);
+
+		if (eager_copied) {
+			/* The data was copied into the buffer by a NIC
+			 * read, which already orders it like a flush
+			 * read would */
+			r_comm->num_flushes_elided++;
+			NCCL_OFI_TRACE(NCCL_NET, "Flush of receive comm %p buffer %p elided (%" PRIu64 " flush reads for %" PRIu64 " received messages)",
+				       r_comm, buffers[flush_n], r_comm->num_flush_reads,
+				       r_comm->num_recvs_completed);
+			goto exit;
+		}
+	}
+
 	ret = rdma_comm_alloc_flush_req(r_comm, buffers[flush_n], mr_handles[flush_n], &req);
 	if (OFI_UNLIKELY(ret != 0)) {
 		goto error;
@@ -4359,6 +6336,32 @@ static int flush(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 
 	NCCL_OFI_TRACE_FLUSH(req, base_req);
 
+	nccl_net_ofi_mutex_lock(&r_comm->flush_lock);
+	if (ofi_nccl_rdma_flush_coalesce() != 0 && r_comm->inflight_flush != NULL &&
+	    get_flush_data(r_comm->inflight_flush)->seq > r_comm->flush_seq_at_last_recv) {
+		/* The in-flight read started after the data of this
+		 * receive arrived, so its completion covers it */
+		rdma_req_flush_data_t *inflight_data = get_flush_data(r_comm->inflight_flush);
+		get_flush_data(req)->joined_next = inflight_data->joined_head;
+		inflight_data->joined_head = req;
+		r_comm->num_flushes_coalesced++;
+		NCCL_OFI_TRACE(NCCL_NET, "Flush of receive comm %p buffer %p joined flush read %p (%" PRIu64 " flush reads for %" PRIu64 " received messages)",
+			       r_comm, buffers[flush_n], r_comm->inflight_flush,
+			       r_comm->num_flush_reads, r_comm->num_recvs_completed);
+		nccl_net_ofi_mutex_unlock(&r_comm->flush_lock);
+
+		(r_comm->num_inflight_reqs)++;
+		*base_req = &req->base;
+		return 0;
+	}
+	get_flush_data(req)->seq = ++(r_comm->num_flush_reads);
+	r_comm->inflight_flush = req;
+	nccl_net_ofi_mutex_unlock(&r_comm->flush_lock);
+
+	NCCL_OFI_TRACE(NCCL_NET, "Flush of receive comm %p buffer %p issues flush read %p (%" PRIu64 " flush reads for %" PRIu64 " received messages)",
+		       r_comm, buffers[flush_n], req, r_comm->num_flush_reads,
+		       r_comm->num_recvs_completed);
+
 	if (!network_busy) {
 		rc = receive_progress(req, true);
 		if (OFI_UNLIKELY(rc != 0)) {
@@ -4368,9 +6371,7 @@ static int flush(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 		}
 	} else {
 		/* Add to pending reqs queue */
-		nccl_net_ofi_mutex_lock(&ep->pending_reqs_lock);
-		ep->pending_reqs_queue->push_back(req);
-		nccl_net_ofi_mutex_unlock(&ep->pending_reqs_lock);
+		rdma_ep_add_pending_req(ep, req);
 		ret = 0;
 		NCCL_OFI_TRACE_PENDING_INSERT(req);
 	}
@@ -4382,8 +6383,11 @@ static int flush(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 	return ret;
 
  error:
-	if (req)
+	if (req) {
+		/* Fail the flushes that joined the read in the meantime */
+		rdma_flush_fail_joined(req);
 		req->free(req, false);
+	}
  exit:
 	*base_req = NULL;
 	return ret;
@@ -4427,6 +6431,100 @@ static inline nccl_net_ofi_rdma_recv_comm_t *calloc_rdma_recv_comm(int num_rails
     return NULL;
 }
 
+/*
+ * @brief	Resolve the remote endpoint name and the local endpoint name,
+ *		used for flushing, of a receive communicator rail into
+ *		addresses of the address vector of the endpoint rail
+ *
+ * Both names have the address length of the endpoint rail. Names that
+ * are not cached yet are inserted with a single call.
+ */
+static int rdma_recv_comm_rail_insert_addrs(nccl_net_ofi_rdma_recv_comm_rail_t *comm_rail,
+					    nccl_net_ofi_ep_rail_t *rail,
+					    const char *remote_ep_name, int dev_id)
+{
+	size_t ep_name_len = rail->local_ep_name_len;
+	char ep_names[2 * MAX_EP_ADDR];
+	fi_addr_t addrs[2];
+
+	memcpy(ep_names, remote_ep_name, ep_name_len);
+	memcpy(ep_names + ep_name_len, rail->local_ep_name, ep_name_len);
+
+	int ret = rdma_ep_rail_av_insert(rail, ep_names, 2, addrs, dev_id);
+	if (OFI_UNLIKELY(ret != 0)) {
+		return ret;
+	}
+
+	comm_rail->remote_addr = addrs[0];
+	comm_rail->local_addr = addrs[1];
+
+	return 0;
+}
+
+/*
+ * @brief	Initialize data rail `rail_id' of a receive communicator by
+ *		inserting the remote endpoint name and the local endpoint
+ *		name, used for flushing, into the address vector of the
+ *		corresponding endpoint rail
+ */
+static int rdma_recv_comm_init_rail(nccl_net_ofi_rdma_recv_comm_t *r_comm,
+				    nccl_net_ofi_rdma_ep_t *ep, uint16_t rail_id,
+				    const char *remote_ep_name)
+{
+	nccl_net_ofi_rdma_recv_comm_rail_t *comm_rail = rdma_recv_comm_get_rail(r_comm, rail_id);
+	nccl_net_ofi_ep_rail_t *rail = rdma_endpoint_get_rail(ep, rail_id);
+
+	comm_rail->local_ep = rail->ofi_ep;
+
+	return rdma_recv_comm_rail_insert_addrs(comm_rail, rail, remote_ep_name,
+						r_comm->base.base.dev_id);
+}
+
+/*
+ * @brief	Bring up the data rails of a receive communicator that were
+ *		left uninitialized at connection establishment
+ *
+ * The sender decides from the size of each message whether to stripe
+ * it across its data rails. The receiver follows once it observes
+ * data on a rail other than the first one, or a message striped into
+ * several segments, and before it stripes a pull read itself. This
+ * may be called from completion handlers as well as from
+ * application threads.
+ */
+static int rdma_recv_comm_activate_rails(nccl_net_ofi_rdma_recv_comm_t *r_comm)
+{
+	int ret = 0;
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
+
+	if (OFI_LIKELY(__atomic_load_n(&r_comm->num_active_rails, __ATOMIC_ACQUIRE) ==
+		       r_comm->num_rails)) {
+		return 0;
+	}
+
+	nccl_net_ofi_mutex_lock(&r_comm->rails_lock);
+
+	for (uint16_t rail_id = r_comm->num_active_rails; rail_id < r_comm->num_rails; ++rail_id) {
+		ret = rdma_recv_comm_init_rail(r_comm, ep, rail_id,
+					       r_comm->lazy_remote_ep_names[rail_id].ep_name);
+		if (OFI_UNLIKELY(ret != 0)) {
+			goto unlock;
+		}
+		__atomic_store_n(&r_comm->num_active_rails, rail_id + 1, __ATOMIC_RELEASE);
+	}
+
+	if (r_comm->lazy_remote_ep_names != NULL) {
+		NCCL_OFI_TRACE(NCCL_NET, "Activated %u data rails of recv comm %p",
+			       r_comm->num_rails, r_comm);
+		free(r_comm->lazy_remote_ep_names);
+		r_comm->lazy_remote_ep_names = NULL;
+	}
+
+ unlock:
+	nccl_net_ofi_mutex_unlock(&r_comm->rails_lock);
+
+	return ret;
+}
+
 static void init_rma_op_req(nccl_net_ofi_rdma_req_t *req,
 			    nccl_net_ofi_comm_t *comm,
 			    void *buff, size_t size,
@@ -4449,6 +6547,9 @@ static void init_rma_op_req(nccl_net_ofi_rdma_req_t *req,
 	rma_op_data->buff_len = size;
 	rma_op_data->desc = desc;
 	rma_op_data->flags = flags;
+	rma_op_data->recv_req = NULL;
+	rma_op_data->pull_rx_buff_req = NULL;
+	rma_op_data->schedule = NULL;
 
 	/* Set expected number of completions */
 	rma_op_data->total_num_compls = 1;
@@ -4463,12 +6564,11 @@ static int alloc_rdma_read_req(nccl_net_ofi_rdma_recv_comm_t *r_comm,
 			       nccl_net_ofi_rdma_req_t **ret_req)
 {
 	uint64_t flags = 0;
-	struct fid_mr *rail_mr_handle = buff_mr_handle->mr[0];
-	void *desc = fi_mr_desc(rail_mr_handle);
+	void *desc = buff_mr_handle->desc[0];
 	*ret_req = NULL;
 
 	/* Allocate NCCL OFI request */
-	nccl_net_ofi_rdma_req_t *req = allocate_req(r_comm->nccl_ofi_reqs_fl);
+	nccl_net_ofi_rdma_req_t *req = allocate_comm_req(&r_comm->reqs);
 	if (OFI_UNLIKELY(req == NULL)) {
 		NCCL_OFI_WARN("Unable to get NCCL OFI request for device");
 		return -ENOMEM;
@@ -4559,6 +6659,7 @@ static int rma_read(nccl_net_ofi_recv_comm_t *recv_comm, void* dest, size_t size
 /**
  * Freelist callback to initialize new RDMA request type
  */
+template <uint16_t num_rails>
 static int rdma_fl_req_entry_init(void *entry)
 {
 	auto req = static_cast<nccl_net_ofi_rdma_req_t *>(entry);
@@ -4566,25 +6667,30 @@ static int rdma_fl_req_entry_init(void *entry)
 	zero_nccl_ofi_req(req);
 	req->base.test = test;
 
-	/* Initialize mutex for request access */
-	int ret = nccl_net_ofi_mutex_init(&req->req_lock, NULL);
-	if (ret != 0) {
-		NCCL_OFI_WARN("Unable to initialize mutex");
-		return ret;
-	}
-
-	rdma_req_init_ctx(req);
+	rdma_req_init_ofi_contexts(req, num_rails);
 
-	return ret;
+	return 0;
 }
 
-
-static void rdma_fl_req_entry_fini(void *entry)
+/*
+ * @brief	Return the entry init function of request freelists
+ *		allocating entries of nccl_net_ofi_rdma_req_size(num_rails)
+ */
+static nccl_ofi_freelist_entry_init_fn rdma_fl_req_entry_init_fn(uint16_t num_rails)
 {
-	nccl_net_ofi_rdma_req_t *req = static_cast<nccl_net_ofi_rdma_req_t *>(entry);
-	assert(req);
+	static_assert(MAX_NUM_RAILS == 4, "Update rdma_fl_req_entry_init_fn()");
 
-	nccl_net_ofi_mutex_destroy(&req->req_lock);
+	switch (num_rails) {
+	case 1:
+		return rdma_fl_req_entry_init<1>;
+	case 2:
+		return rdma_fl_req_entry_init<2>;
+	case 3:
+		return rdma_fl_req_entry_init<3>;
+	default:
+		assert(num_rails == 4);
+		return rdma_fl_req_entry_init<4>;
+	}
 }
 
 
@@ -4641,6 +6747,26 @@ static nccl_net_ofi_rdma_recv_comm_t *prepare_recv_comm(nccl_net_ofi_rdma_domain
 		return NULL;
 	}
 
+	ret = nccl_net_ofi_mutex_init(&r_comm->flush_lock, NULL);
+	if (ret != 0) {
+		nccl_net_ofi_mutex_destroy(&r_comm->ctrl_counter_lock);
+		free_rdma_recv_comm(r_comm);
+		return NULL;
+	}
+
+	ret = nccl_net_ofi_mutex_init(&r_comm->rails_lock, NULL);
+	if (ret != 0) {
+		nccl_net_ofi_mutex_destroy(&r_comm->flush_lock);
+		nccl_net_ofi_mutex_destroy(&r_comm->ctrl_counter_lock);
+		free_rdma_recv_comm(r_comm);
+		return NULL;
+	}
+
+	if (ofi_nccl_rdma_flush_coalesce() != 0) {
+		r_comm->eager_copied_buffs = new std::unordered_set<void *>;
+		r_comm->eager_copied_buffs->reserve(NCCL_OFI_MAX_REQUESTS);
+	}
+
 	r_comm->base.base.type = NCCL_NET_OFI_RECV_COMM;
 	r_comm->base.base.dev_id = dev_id;
 	r_comm->base.regMr = reg_mr_recv_comm;
@@ -4665,7 +6791,7 @@ static nccl_net_ofi_rdma_recv_comm_t *prepare_recv_comm(nccl_net_ofi_rdma_domain
 	r_comm->local_comm_id = (uint32_t)comm_id;
 
 	/* Validate received comm ID */
-	if (OFI_UNLIKELY(conn_msg->local_comm_id >= device->num_comm_ids)) {
+	if (OFI_UNLIKELY(conn_msg->local_comm_id >= NCCL_OFI_RDMA_MAX_REMOTE_COMMS)) {
 		NCCL_OFI_WARN("Received an invalid communicator ID %" PRIu32 " for device %d",
 			      conn_msg->local_comm_id, dev_id);
 		goto error;
@@ -4677,10 +6803,10 @@ static nccl_net_ofi_rdma_recv_comm_t *prepare_recv_comm(nccl_net_ofi_rdma_domain
 	/* Find a comm to use, given the remote EP name */
 	if (ofi_nccl_endpoint_per_communicator() != 0)
 	{
-		nccl_ofi_rdma_ep_name_t *remote_rail0_ep_name = &conn_msg->ep_names[0];
+		const char *remote_rail0_ep_name = nccl_ofi_rdma_connection_info_ep_name(conn_msg, 0);
 		nccl_net_ofi_ep_t *ep_for_addr = NULL;
-		ret = domain->ep_addr_list->get(remote_rail0_ep_name->ep_name,
-						remote_rail0_ep_name->ep_name_len, &ep_for_addr);
+		ret = domain->ep_addr_list->get(remote_rail0_ep_name,
+						conn_msg->ep_name_len, &ep_for_addr);
 		if (ret != 0) {
 			goto error;
 		}
@@ -4698,8 +6824,8 @@ static nccl_net_ofi_rdma_recv_comm_t *prepare_recv_comm(nccl_net_ofi_rdma_domain
 
 			ep_for_addr = &new_ep->base;
 
-			ret = domain->ep_addr_list->insert(ep_for_addr, remote_rail0_ep_name->ep_name,
-							   remote_rail0_ep_name->ep_name_len);
+			ret = domain->ep_addr_list->insert(ep_for_addr, remote_rail0_ep_name,
+							   conn_msg->ep_name_len);
 			if (ret != 0) {
 				goto error;
 			}
@@ -4714,7 +6840,10 @@ static nccl_net_ofi_rdma_recv_comm_t *prepare_recv_comm(nccl_net_ofi_rdma_domain
 	ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
 
 	/* Add ourselves to ep's lookup array */
-	rdma_device_set_comm(device, r_comm->local_comm_id, &r_comm->base.base);
+	ret = rdma_device_set_comm(device, r_comm->local_comm_id, &r_comm->base.base);
+	if (OFI_UNLIKELY(ret != 0)) {
+		goto error;
+	}
 
 	/* Allocate array of control communicator rails */
 	r_comm->num_control_rails = num_control_rails;
@@ -4723,26 +6852,13 @@ static nccl_net_ofi_rdma_recv_comm_t *prepare_recv_comm(nccl_net_ofi_rdma_domain
 	for (uint16_t rail_id = 0; rail_id != num_control_rails; ++rail_id) {
 		nccl_net_ofi_rdma_recv_comm_rail_t *comm_rail = rdma_recv_comm_get_control_rail(r_comm, rail_id);
 		nccl_net_ofi_ep_rail_t *rail = rdma_endpoint_get_control_rail(ep, rail_id);
-		nccl_ofi_rdma_ep_name_t *remote_ep_name = &conn_msg->control_ep_names[rail_id];
 
 		comm_rail->local_ep = rail->ofi_ep;
 
-		/* Insert remote EP address to AV */
-		ret = fi_av_insert(rail->av, (void *)remote_ep_name->ep_name, 1,
-				   &comm_rail->remote_addr, 0, NULL);
-		if (OFI_UNLIKELY(ret != 1)) {
-			NCCL_OFI_WARN("Unable to insert remote address into address vector "
-				      "for device %d. RC: %s",
-				      dev_id, fi_strerror(-ret));
-			goto error;
-		}
-
-		ret = fi_av_insert(rail->av, (void *)rail->local_ep_name, 1,
-				   &comm_rail->local_addr, 0, NULL);
-		if (OFI_UNLIKELY(ret != 1)) {
-			NCCL_OFI_WARN("Unable to insert local address into address vector "
-				      "for device %d. RC: %s",
-				      dev_id, fi_strerror(-ret));
+		ret = rdma_recv_comm_rail_insert_addrs(comm_rail, rail,
+						       nccl_ofi_rdma_connection_info_control_ep_name(conn_msg, rail_id),
+						       dev_id);
+		if (OFI_UNLIKELY(ret != 0)) {
 			goto error;
 		}
 	}
@@ -4750,46 +6866,37 @@ static nccl_net_ofi_rdma_recv_comm_t *prepare_recv_comm(nccl_net_ofi_rdma_domain
 	/* Allocate array of communicator rails */
 	r_comm->num_rails = num_rails;
 
-	/* Initialize local and remote endpoint resources for each rail */
-	for (uint16_t rail_id = 0; rail_id != num_rails; ++rail_id) {
-		nccl_net_ofi_rdma_recv_comm_rail_t *comm_rail = rdma_recv_comm_get_rail(r_comm, rail_id);
-		nccl_net_ofi_ep_rail_t *rail = rdma_endpoint_get_rail(ep, rail_id);
-		nccl_ofi_rdma_ep_name_t *remote_ep_name = &conn_msg->ep_names[rail_id];
-
-		comm_rail->local_ep = rail->ofi_ep;
-
-		/* Insert remote EP address to AV */
-		ret = fi_av_insert(rail->av, (void *)remote_ep_name->ep_name, 1,
-				   &comm_rail->remote_addr, 0, NULL);
-		if (OFI_UNLIKELY(ret != 1)) {
-			NCCL_OFI_WARN("Unable to insert remote address into address vector "
-				      "for device %d. RC: %s",
-				      dev_id, fi_strerror(-ret));
+	/* Bring up only the first data rail if both sides asked for
+	 * lazy data rails. The remaining rails are activated once the
+	 * sender starts using them, see
+	 * rdma_recv_comm_activate_rails(). */
+	if (conn_msg->lazy_data_rails && ofi_nccl_rdma_lazy_data_rails() != 0) {
+		r_comm->num_active_rails = 1;
+		r_comm->lazy_remote_ep_names = rdma_connection_info_copy_ep_names(conn_msg);
+		if (OFI_UNLIKELY(r_comm->lazy_remote_ep_names == NULL)) {
+			NCCL_OFI_WARN("Unable to allocate remote endpoint names for device %d",
+				      dev_id);
 			goto error;
 		}
+	} else {
+		r_comm->num_active_rails = num_rails;
+	}
 
-		ret = fi_av_insert(rail->av, (void *)rail->local_ep_name, 1,
-				   &comm_rail->local_addr, 0, NULL);
-		if (OFI_UNLIKELY(ret != 1)) {
-			NCCL_OFI_WARN("Unable to insert local address into address vector "
-				      "for device %d. RC: %s",
-				      dev_id, fi_strerror(-ret));
+	/* Initialize local and remote endpoint resources for each active rail */
+	for (uint16_t rail_id = 0; rail_id != r_comm->num_active_rails; ++rail_id) {
+		ret = rdma_recv_comm_init_rail(r_comm, ep, rail_id,
+					       nccl_ofi_rdma_connection_info_ep_name(conn_msg, rail_id));
+		if (OFI_UNLIKELY(ret != 0)) {
 			goto error;
 		}
 	}
 
-	/* Allocate request freelist */
-	/* Maximum freelist entries is 4*NCCL_OFI_MAX_REQUESTS because each receive request
+	/* Draw requests from the endpoint request freelist */
+	/* Maximum requests is 4*NCCL_OFI_MAX_REQUESTS because each receive request
 	   can have associated reqs for send_ctrl, recv_segms, and eager_copy */
-	ret = nccl_ofi_freelist_init(sizeof(nccl_net_ofi_rdma_req_t), 16, 16,
-				     4 * NCCL_OFI_MAX_REQUESTS,
-				     rdma_fl_req_entry_init, rdma_fl_req_entry_fini,
-				     &r_comm->nccl_ofi_reqs_fl);
-	if (OFI_UNLIKELY(ret != 0)) {
-		NCCL_OFI_WARN("Could not allocate NCCL OFI requests free list for dev %d",
-				  dev_id);
-		goto error;
-	}
+	r_comm->reqs.fl = ep->comm_reqs_fl;
+	r_comm->reqs.num_allocated = 0;
+	r_comm->reqs.max_allocated = 4 * NCCL_OFI_MAX_REQUESTS;
 
 	/* Allocate connect message, will be returned after the
 	   connect response send completion */
@@ -4833,20 +6940,51 @@ static nccl_net_ofi_rdma_recv_comm_t *prepare_recv_comm(nccl_net_ofi_rdma_domain
  error:
 
 	if (r_comm) {
-		if (r_comm->nccl_ofi_reqs_fl)
-			nccl_ofi_freelist_fini(r_comm->nccl_ofi_reqs_fl);
 		if (r_comm->msgbuff)
 			nccl_ofi_msgbuff_destroy(r_comm->msgbuff);
 		if (COMM_ID_INVALID != r_comm->local_comm_id) {
 			device->comm_idpool->free_id(r_comm->local_comm_id);
 		}
 		nccl_net_ofi_mutex_destroy(&r_comm->ctrl_counter_lock);
+		nccl_net_ofi_mutex_destroy(&r_comm->flush_lock);
+		nccl_net_ofi_mutex_destroy(&r_comm->rails_lock);
 		free_rdma_recv_comm(r_comm);
 	}
 
 	return NULL;
 }
 
+/*
+ * @brief	Set the endpoint names of all rails of `ep' in a connect or
+ *		connect response message
+ *
+ * The number of rails of the message must be set already.
+ */
+static void rdma_ep_set_connection_info_ep_names(nccl_net_ofi_rdma_ep_t *ep,
+						 nccl_ofi_rdma_connection_info_t *conn_msg)
+{
+	size_t ep_name_len = ep->control_rails[0].local_ep_name_len;
+
+	assert(conn_msg->num_rails == ep->num_rails);
+	assert(conn_msg->num_control_rails == ep->num_control_rails);
+
+	conn_msg->ep_name_len = (uint16_t)ep_name_len;
+
+	for (uint16_t rail_id = 0; rail_id != ep->num_control_rails; ++rail_id) {
+		nccl_net_ofi_ep_rail_t *ep_rail = rdma_endpoint_get_control_rail(ep, rail_id);
+		assert(ep_rail->local_ep_name_len == ep_name_len);
+		memcpy(nccl_ofi_rdma_connection_info_control_ep_name(conn_msg, rail_id),
+		       ep_rail->local_ep_name, ep_name_len);
+	}
+
+	for (uint16_t rail_id = 0; rail_id != ep->num_rails; ++rail_id) {
+		nccl_net_ofi_ep_rail_t *ep_rail = rdma_endpoint_get_rail(ep, rail_id);
+		assert(ep_rail->local_ep_name_len == ep_name_len);
+		memcpy(nccl_ofi_rdma_connection_info_ep_name(conn_msg, rail_id),
+		       ep_rail->local_ep_name, ep_name_len);
+	}
+}
+
 /*
  * @brief	Populate connect response message with endpoint names
  *
@@ -4867,13 +7005,12 @@ static int prepare_conn_resp(nccl_net_ofi_rdma_ep_t *ep,
 	int num_rails = ep->num_rails;
 	int num_control_rails = ep->num_control_rails;
 	nccl_ofi_rdma_connection_info_t *conn_resp = (nccl_ofi_rdma_connection_info_t *)r_comm->conn_msg->ptr;
-	nccl_ofi_rdma_ep_name_t *rdma_ep_name;
-	nccl_net_ofi_ep_rail_t *ep_rail;
 
 	assert(num_rails <= MAX_NUM_RAILS);
 	assert(num_control_rails <= MAX_NUM_RAILS);
 
 	conn_resp->type = NCCL_OFI_RDMA_MSG_CONN_RESP;
+	conn_resp->version = NCCL_OFI_RDMA_PROTOCOL_VERSION;
 
 	/* Set r_comm's (local) comm ID to be sent back to remote */
 	conn_resp->local_comm_id = r_comm->local_comm_id;
@@ -4885,27 +7022,11 @@ static int prepare_conn_resp(nccl_net_ofi_rdma_ep_t *ep,
 	conn_resp->num_rails = num_rails;
 	conn_resp->num_control_rails = num_control_rails;
 
-	/* Set libfabric endpoint names for each rail */
-	for (uint16_t rail_id = 0; rail_id != num_rails; ++rail_id) {
-		rdma_ep_name = &conn_resp->ep_names[rail_id];
-		ep_rail = rdma_endpoint_get_rail(ep, rail_id);
-
-		assert(sizeof(rdma_ep_name->ep_name) == sizeof(ep_rail->local_ep_name));
-		memcpy(rdma_ep_name->ep_name, ep_rail->local_ep_name,
-		       ep_rail->local_ep_name_len);
-		rdma_ep_name->ep_name_len = ep_rail->local_ep_name_len;
-	}
-
-	/* Set libfabric endpoint names for each control rail */
-	for (uint16_t rail_id = 0; rail_id != num_control_rails; ++rail_id) {
-		rdma_ep_name = &conn_resp->control_ep_names[rail_id];
-		ep_rail = rdma_endpoint_get_control_rail(ep, rail_id);
+	/* Tell sender whether data rails are brought up lazily */
+	conn_resp->lazy_data_rails = (r_comm->num_active_rails < r_comm->num_rails);
 
-		assert(sizeof(rdma_ep_name->ep_name) == sizeof(ep_rail->local_ep_name));
-		memcpy(rdma_ep_name->ep_name, ep_rail->local_ep_name,
-		       ep_rail->local_ep_name_len);
-		rdma_ep_name->ep_name_len = ep_rail->local_ep_name_len;
-	}
+	/* Set libfabric endpoint names for each rail */
+	rdma_ep_set_connection_info_ep_names(ep, conn_resp);
 
 	return 0;
 }
@@ -4938,10 +7059,11 @@ static int post_send_conn_resp(nccl_net_ofi_rdma_recv_comm_t *r_comm,
 	uint16_t rail_id = 0;
 	nccl_net_ofi_rdma_recv_comm_rail_t *comm_rail = rdma_recv_comm_get_control_rail(r_comm, rail_id);
 	freelist_regmr_fn_handle_t *fl_mr_handle = (freelist_regmr_fn_handle_t *)r_comm->conn_msg->mr_handle;
-	void *desc = fi_mr_desc(fl_mr_handle->mr_handle->mr[rail_id]);
+	void *desc = fl_mr_handle->mr_handle->desc[rail_id];
 
 	req->state = NCCL_OFI_RDMA_REQ_PENDING;
-	rc = fi_send(comm_rail->local_ep, (void *)r_comm->conn_msg->ptr, sizeof(nccl_ofi_rdma_connection_info_t), desc,
+	rc = fi_send(comm_rail->local_ep, (void *)r_comm->conn_msg->ptr,
+		     nccl_ofi_rdma_connection_info_size((nccl_ofi_rdma_connection_info_t *)r_comm->conn_msg->ptr), desc,
 		     comm_rail->remote_addr, rdma_req_get_ofi_context(req, rail_id));
 
 	if (rc == -FI_EAGAIN) {
@@ -4950,126 +7072,89 @@ static int post_send_conn_resp(nccl_net_ofi_rdma_recv_comm_t *r_comm,
 		 * Process completions so that you have enough
 		 * resources for sending connect message
 		 */
-		int res = ofi_process_cq(ep);
+		int res = rdma_ep_progress(ep);
 		if (res != 0)
 			return res;
 	} else if (rc != 0) {
 		req->state = NCCL_OFI_RDMA_REQ_CREATED;
 		NCCL_OFI_WARN("Unable to send connect message for dev %d. RC: %zd, ERROR: %s",
 			      device->base.dev_id, rc, fi_strerror(-rc));
+	} else {
+		rdma_ep_mark_rail_active(ep, rail_id);
 	}
 
 	return rc;
 }
 
 /*
- * @brief	Close receive communicator if listen request is not pending
+ * @brief	Release a connection of a listen communicator, closing its
+ *		receive communicator unless the connection has been
+ *		handed out by accept
  */
-static int close_listen_recv_comm(nccl_net_ofi_rdma_listen_comm_t *l_comm)
+static int listen_conn_destroy(nccl_net_ofi_rdma_listen_conn_t *conn)
 {
-
-	if (!l_comm) {
+	if (!conn) {
 		return 0;
 	}
 
-	if (l_comm->req.state == NCCL_OFI_RDMA_REQ_PENDING) {
+	if (conn->req.state == NCCL_OFI_RDMA_REQ_PENDING) {
 		NCCL_OFI_WARN("Unable to free request of listen communicator. Request is still pending. Leaking memory.");
 		return -EINVAL;
 	}
 
-	if (l_comm->r_comm && recv_comm_destroy(l_comm->r_comm)) {
+	if (conn->r_comm && recv_comm_destroy(conn->r_comm)) {
 		return -EINVAL;
 	}
-	l_comm->r_comm = NULL;
+	conn->r_comm = NULL;
+
+	free(conn);
 
 	return 0;
 }
 
-static int accept(nccl_net_ofi_listen_comm_t *listen_comm,
-			   nccl_net_ofi_recv_comm_t **recv_comm)
+/*
+ * @brief	Advance establishment of one connection of a listen
+ *		communicator as far as possible without blocking
+ *
+ * Once the connection reaches COMM_CONNECTED, its receive communicator
+ * is ready to be returned by accept.
+ */
+static int accept_progress_conn(nccl_net_ofi_rdma_listen_comm_t *l_comm,
+				nccl_net_ofi_rdma_listen_conn_t *conn)
 {
 	int ret = 0;
-	nccl_net_ofi_rdma_req_state_t req_state;
-
-	nccl_net_ofi_rdma_listen_comm_t *l_comm =
-		(nccl_net_ofi_rdma_listen_comm_t *)listen_comm;
-
-	/* Extract communicator state from listen communicator object */
-	nccl_net_ofi_rdma_recv_comm_t *r_comm = l_comm->r_comm;
-
-	/* Extract request used for connect and connect response message */
-	nccl_net_ofi_rdma_req_t *req = &l_comm->req;
-
-	/* Extract struct used for message exchange */
-	nccl_ofi_rdma_connection_info_t *conn_msg = &l_comm->conn_msg;
-
-	/* Retrieve and validate endpoint */
-	nccl_net_ofi_rdma_ep_t *l_comm_ep = (nccl_net_ofi_rdma_ep_t *)l_comm->base.base.ep;
-	assert(l_comm_ep != NULL);
+	nccl_net_ofi_rdma_recv_comm_t *r_comm = conn->r_comm;
+	nccl_net_ofi_rdma_req_t *req = &conn->req;
+	nccl_ofi_rdma_connection_info_t *conn_msg = &conn->conn_msg;
 
-	nccl_net_ofi_rdma_ep_t *ep = NULL;
-	if (l_comm->r_comm) {
-		ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
-		assert(ep != NULL);
-	}
-
-	/* Retrieve and validate device */
-	nccl_net_ofi_rdma_domain_t *domain = rdma_endpoint_get_domain(l_comm_ep);
-	assert(domain != NULL);
-	nccl_net_ofi_rdma_device_t *device = rdma_domain_get_device(domain);
-	assert(device != NULL);
-
-	int dev_id = device->base.dev_id;
-
-	if (l_comm->stage == COMM_CONNECTED) {
-		NCCL_OFI_WARN("listenComm %p object already has an active connection (%d).",
-			      l_comm, l_comm->stage);
-		ret = -EINVAL;
-		goto exit;
-	}
-
-	/* Set return receive communicator to NULL until accept finalizes */
-	*recv_comm = NULL;
-
-	/*
-	 * Take appropriate actions based on connection stage of communicator.
-	 *
-	 * Once we have completed the actions for a particular stage, we proceed
-	 * to the next one until failure. This is to ensure we make maximum
-	 * progress in a single function invocation.
-	 */
-	switch (l_comm->stage) {
-	case COMM_CREATE_START:
-		/* COMM_CREATE_START:Allocate data required for the accept function */
-
-		l_comm->stage = COMM_RECV_CONN;
-
-		fallthrough;
-	case COMM_RECV_CONN:
+	/* Retrieve and validate endpoint */
+	nccl_net_ofi_rdma_ep_t *l_comm_ep = (nccl_net_ofi_rdma_ep_t *)l_comm->base.base.ep;
+	assert(l_comm_ep != NULL);
 
-		l_comm->stage = COMM_CONN_REQ_PENDING;
+	nccl_net_ofi_rdma_ep_t *ep = NULL;
+	if (r_comm) {
+		ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
+		assert(ep != NULL);
+	}
 
-		fallthrough;
-	case COMM_CONN_REQ_PENDING:
-		/* COMM_CONN_REQ_PENDING: Wait until connect message has been
-		 * received. Then, prepare for sending connect accept message,
-		 * i.e., create receive communicator and reset the previously
-		 * used request. */
+	/* Retrieve and validate device */
+	nccl_net_ofi_rdma_domain_t *domain = rdma_endpoint_get_domain(l_comm_ep);
+	assert(domain != NULL);
+	nccl_net_ofi_rdma_device_t *device = rdma_domain_get_device(domain);
+	assert(device != NULL);
 
-		/* Progress NCCL OFI engine so that connection is accepted */
-		ret = ofi_process_cq(l_comm_ep);
-		if (OFI_UNLIKELY(ret != 0)) {
-			goto exit;
-		}
+	int dev_id = device->base.dev_id;
 
-		/* Check if the connect message is received */
-		nccl_net_ofi_mutex_lock(&req->req_lock);
-		req_state = req->state;
-		nccl_net_ofi_mutex_unlock(&req->req_lock);
+	switch (conn->stage) {
+	case COMM_RECV_CONN:
+		/* COMM_RECV_CONN: The connect message has been received.
+		 * Prepare for sending connect accept message, i.e.,
+		 * create receive communicator and initialize the
+		 * connect response request. */
 
-		/* Wait until connect message is sent */
-		if (req_state != NCCL_OFI_RDMA_REQ_COMPLETED) {
-			return 0;
+		ret = rdma_connection_info_check_version(conn_msg, dev_id);
+		if (ret != 0) {
+			return ret;
 		}
 
 		/* Number of remote rails and number of local rails match */
@@ -5077,8 +7162,7 @@ static int accept(nccl_net_ofi_listen_comm_t *listen_comm,
 			NCCL_OFI_WARN("Unexpected number of remote rails for dev %d. Expected %i but got %i",
 				      dev_id, l_comm_ep->num_rails,
 				      conn_msg->num_rails);
-			ret = -EINVAL;
-			goto exit;
+			return -EINVAL;
 		}
 
 		/* Number of remote control rails and number of local control rails match */
@@ -5086,17 +7170,15 @@ static int accept(nccl_net_ofi_listen_comm_t *listen_comm,
 			NCCL_OFI_WARN("Unexpected number of remote control rails for dev %d. Expected %i but got %i",
 				      dev_id, l_comm_ep->num_control_rails,
 				      conn_msg->num_control_rails);
-			ret = -EINVAL;
-			goto exit;
+			return -EINVAL;
 		}
 
 		/* Prepare receive communicator object for the received peer connection */
 		r_comm = prepare_recv_comm(domain, l_comm_ep, conn_msg);
 		if (OFI_UNLIKELY(r_comm == NULL)) {
-			ret = -EINVAL;
-			goto exit;
+			return -EINVAL;
 		}
-		l_comm->r_comm = r_comm;
+		conn->r_comm = r_comm;
 
 		/* prepare_recv_comm establishes the endpoint used for this r_comm,
 		   so set the pointer here. */
@@ -5116,16 +7198,16 @@ static int accept(nccl_net_ofi_listen_comm_t *listen_comm,
 		ep->base.ref_cnt++;
 		nccl_net_ofi_mutex_unlock(&(domain->base.domain_lock));
 
-		/* Reset request state for connect response message */
-		prepare_send_conn_resp_req(l_comm);
+		/* Initialize request for connect response message */
+		prepare_send_conn_resp_req(l_comm, conn);
 
 		/* Initialize connect response message */
 		ret = prepare_conn_resp(ep, r_comm, dev_id);
 		if (ret != 0) {
-			goto exit;
+			return ret;
 		}
 
-		l_comm->stage = COMM_SEND_CONN;
+		conn->stage = COMM_SEND_CONN;
 
 		fallthrough;
 	case COMM_SEND_CONN:
@@ -5136,30 +7218,29 @@ static int accept(nccl_net_ofi_listen_comm_t *listen_comm,
 			return 0;
 		}
 		else if (ret != 0) {
-			goto exit;
+			return ret;
 		}
 
-		l_comm->stage = COMM_CONN_RESP_REQ_PENDING;
+		conn->stage = COMM_CONN_RESP_REQ_PENDING;
 
 		fallthrough;
 	case COMM_CONN_RESP_REQ_PENDING:
 		/* COMM_CONN_RESP_REQ_PENDING: Wait until connect
 		 * response message has been delivered. Afterwards,
-		 * cleanup and return receive communicator. */
+		 * cleanup. */
 
-		/* Progress our engine to get completions */
-		ret = ofi_process_cq(ep);
-		if (OFI_UNLIKELY(ret != 0)) {
-			goto exit;
+		/* The listen endpoint has already been progressed by
+		 * accept, so only progress a communicator-specific
+		 * endpoint here */
+		if (ep != l_comm_ep) {
+			ret = ofi_process_cq(ep);
+			if (OFI_UNLIKELY(ret != 0)) {
+				return ret;
+			}
 		}
 
-		/* Check if the connect response message is sent */
-		nccl_net_ofi_mutex_lock(&req->req_lock);
-		req_state = req->state;
-		nccl_net_ofi_mutex_unlock(&req->req_lock);
-
 		/* Wait until connect response message is sent */
-		if (req_state != NCCL_OFI_RDMA_REQ_COMPLETED) {
+		if (rdma_req_get_state(req) != NCCL_OFI_RDMA_REQ_COMPLETED) {
 			return 0;
 		}
 
@@ -5171,35 +7252,124 @@ static int accept(nccl_net_ofi_listen_comm_t *listen_comm,
 		nccl_ofi_freelist_entry_free(ep->conn_msg_fl, r_comm->conn_msg);
 		r_comm->conn_msg = NULL;
 
-		*recv_comm = &r_comm->base;
-
-		/* NULL pointer to recv communicator stored in listen
-		 * communicator's state to avoid that `close_listen_recv_comm'
-		 * deallocates the receive communicator */
-		l_comm->r_comm = NULL;
-
-		l_comm->stage = COMM_CONNECTED;
+		conn->stage = COMM_CONNECTED;
 
 		break;
 
 	case COMM_CONNECTED:
+		break;
 	default:
 		NCCL_OFI_WARN("Invalid state of receive communicator object: %d",
-			      l_comm->stage);
+			      conn->stage);
 		ret = -EINVAL;
 	}
 
-	nccl_net_ofi_mutex_lock(&comm_cleanup_list_lock);
-	++num_open_comms;
-	nccl_net_ofi_mutex_unlock(&comm_cleanup_list_lock);
+	return ret;
+}
+
+/*
+ * Connections to a listen communicator are established concurrently:
+ * every received connect message gets its own connection state, and
+ * each accept call progresses all of them. The first connection that
+ * is fully established is returned, the others stay in flight for
+ * later accept calls.
+ */
+static int accept(nccl_net_ofi_listen_comm_t *listen_comm,
+			   nccl_net_ofi_recv_comm_t **recv_comm)
+{
+	int ret = 0;
+	nccl_net_ofi_rdma_listen_conn_t *conn = NULL;
+
+	nccl_net_ofi_rdma_listen_comm_t *l_comm =
+		(nccl_net_ofi_rdma_listen_comm_t *)listen_comm;
+
+	/* Retrieve and validate endpoint */
+	nccl_net_ofi_rdma_ep_t *l_comm_ep = (nccl_net_ofi_rdma_ep_t *)l_comm->base.base.ep;
+	assert(l_comm_ep != NULL);
+
+	/* Set return receive communicator to NULL until accept finalizes */
+	*recv_comm = NULL;
+
+	/* Progress NCCL OFI engine so that connections are accepted */
+	ret = rdma_ep_progress(l_comm_ep);
+	if (OFI_UNLIKELY(ret != 0)) {
+		return ret;
+	}
+
+	/* Take over connect messages received since the last call */
+	nccl_net_ofi_mutex_lock(&l_comm->conn_queue_lock);
+	while (!l_comm->conn_queue->empty()) {
+		l_comm->accepting->push_back(l_comm->conn_queue->front());
+		l_comm->conn_queue->pop_front();
+	}
+	nccl_net_ofi_mutex_unlock(&l_comm->conn_queue_lock);
+
+	/* Progress all connections in flight, oldest first */
+	for (auto it = l_comm->accepting->begin(); it != l_comm->accepting->end(); ++it) {
+		ret = accept_progress_conn(l_comm, *it);
+		if (OFI_UNLIKELY(ret != 0)) {
+			conn = *it;
+			l_comm->accepting->erase(it);
+			/* Close receive communicator in case accept failed */
+			if (listen_conn_destroy(conn)) {
+				NCCL_OFI_WARN("Failed to close listen communicator");
+			}
+			return ret;
+		}
+	}
+
+	/* Hand out the oldest established connection */
+	for (auto it = l_comm->accepting->begin(); it != l_comm->accepting->end(); ++it) {
+		if ((*it)->stage != COMM_CONNECTED) {
+			continue;
+		}
+
+		conn = *it;
+		l_comm->accepting->erase(it);
+
+		*recv_comm = &conn->r_comm->base;
+		++l_comm->num_accepted;
+
+		NCCL_OFI_TRACE(NCCL_NET, "Listen comm %u accepted connection %" PRIu64 " in %" PRIu64 " us (%zu in flight)",
+			       l_comm->comm_id, l_comm->num_accepted,
+			       rdma_time_now_us() - conn->recv_time_us,
+			       l_comm->accepting->size());
+
+		/* NULL pointer to recv communicator stored in the
+		 * connection to avoid that `listen_conn_destroy'
+		 * deallocates the receive communicator */
+		conn->r_comm = NULL;
+		free(conn);
+
+		nccl_net_ofi_mutex_lock(&comm_cleanup_list_lock);
+		++num_open_comms;
+		nccl_net_ofi_mutex_unlock(&comm_cleanup_list_lock);
+
+		break;
+	}
+
+	return 0;
+}
+
+/*
+ * @brief	Release all connections of the given queue
+ */
+static int listen_conn_queue_destroy(std::deque<nccl_net_ofi_rdma_listen_conn_t *> *queue)
+{
+	int ret = 0;
 
- exit:;
-	/* Close receive communicator in case listen operation failed */
-	int close_ret = close_listen_recv_comm(l_comm);
-	if (close_ret) {
-		NCCL_OFI_WARN("Failed to close listen communicator");
+	while (!queue->empty()) {
+		nccl_net_ofi_rdma_listen_conn_t *conn = queue->front();
+		queue->pop_front();
+
+		int rc = listen_conn_destroy(conn);
+		if (rc != 0) {
+			NCCL_OFI_WARN("Unable to close receive communicator stored in listen communicator. Leaking memory.");
+			ret = rc;
+		}
 	}
-	return ret ? ret : close_ret;
+
+	return ret;
 }
 
 static int listen_close(nccl_net_ofi_listen_comm_t *listen_comm)
@@ -5213,27 +7383,40 @@ static int listen_close(nccl_net_ofi_listen_comm_t *listen_comm)
 	nccl_net_ofi_ep_t *base_ep = l_comm->base.base.ep;
 	assert(base_ep != NULL);
 
-	if (l_comm->req.state == NCCL_OFI_RDMA_REQ_PENDING) {
-		NCCL_OFI_WARN("Unable to free request of listen communicator. Request is still pending. Leaking memory.");
-		return -EINVAL;
+	/* Connections that were never picked up by accept */
+	for (auto conn : *l_comm->accepting) {
+		if (conn->req.state == NCCL_OFI_RDMA_REQ_PENDING) {
+			NCCL_OFI_WARN("Unable to free request of listen communicator. Request is still pending. Leaking memory.");
+			return -EINVAL;
+		}
 	}
 
-	if (l_comm->r_comm) {
-		ret = recv_comm_destroy(l_comm->r_comm);
-		if (ret != 0) {
-			NCCL_OFI_WARN("Unable to close receive communicator stored in listen communicator. Leaking memory.");
-			return ret;
-		}
+	ret = listen_conn_queue_destroy(l_comm->accepting);
+	if (ret != 0) {
+		return ret;
 	}
 
-	ret = nccl_net_ofi_mutex_destroy(&l_comm->req.req_lock);
+	/* Stop routing connect messages to this communicator and
+	 * release the ones that already arrived. Holding
+	 * listen_comm_lock waits for completion handlers that already
+	 * looked up the communicator. */
+	nccl_net_ofi_rdma_device_t *device = rdma_endpoint_get_device((nccl_net_ofi_rdma_ep_t *)base_ep);
+	nccl_net_ofi_mutex_lock(&device->listen_comm_lock);
+	rdma_device_set_comm(device, l_comm->comm_id, NULL);
+	nccl_net_ofi_mutex_lock(&l_comm->conn_queue_lock);
+	ret = listen_conn_queue_destroy(l_comm->conn_queue);
+	nccl_net_ofi_mutex_unlock(&l_comm->conn_queue_lock);
+	nccl_net_ofi_mutex_unlock(&device->listen_comm_lock);
 	if (ret != 0) {
-		NCCL_OFI_WARN("Failed to destroy req_lock");
-		return -ret;
+		return ret;
 	}
 
 	/* Release communicator ID */
-	rdma_endpoint_get_device((nccl_net_ofi_rdma_ep_t *)base_ep)->comm_idpool->free_id(l_comm->comm_id);
+	device->comm_idpool->free_id(l_comm->comm_id);
+
+	delete l_comm->conn_queue;
+	delete l_comm->accepting;
+	nccl_net_ofi_mutex_destroy(&l_comm->conn_queue_lock);
 
 	free(l_comm);
 	ret = base_ep->release_ep(base_ep, false, false);
@@ -5284,6 +7467,15 @@ static int listen(nccl_net_ofi_ep_t *base_ep,
 		goto error;
 	}
 
+	ret = nccl_net_ofi_mutex_init(&l_comm->conn_queue_lock, NULL);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Unable to initialize connection queue lock");
+		free(l_comm);
+		return ret;
+	}
+	l_comm->conn_queue = new std::deque<nccl_net_ofi_rdma_listen_conn_t *>;
+	l_comm->accepting = new std::deque<nccl_net_ofi_rdma_listen_conn_t *>;
+
 	/* Initialize listen communicator */
 	l_comm->base.base.type = NCCL_NET_OFI_LISTEN_COMM;
 	l_comm->base.base.ep = base_ep;
@@ -5302,12 +7494,10 @@ static int listen(nccl_net_ofi_ep_t *base_ep,
 	handle->comm_id = l_comm->comm_id;
 
 	/*  Add listen comm to ep's lookup array */
-	rdma_device_set_comm(device, l_comm->comm_id, &l_comm->base.base);
-
-	/* Prepare receive request to accept connections */
-	ret = prepare_recv_conn_req(l_comm);
-	if (ret != 0)
+	ret = rdma_device_set_comm(device, l_comm->comm_id, &l_comm->base.base);
+	if (OFI_UNLIKELY(ret != 0)) {
 		goto error;
+	}
 
 	*listen_comm = &l_comm->base;
 
@@ -5317,6 +7507,11 @@ static int listen(nccl_net_ofi_ep_t *base_ep,
 	if (l_comm && COMM_ID_INVALID != l_comm->comm_id) {
 		device->comm_idpool->free_id(l_comm->comm_id);
 	}
+	if (l_comm) {
+		delete l_comm->conn_queue;
+		delete l_comm->accepting;
+		nccl_net_ofi_mutex_destroy(&l_comm->conn_queue_lock);
+	}
 	free(l_comm);
  exit:
 	return ret;
@@ -5349,7 +7544,7 @@ static int alloc_rdma_write_req(nccl_net_ofi_rdma_send_comm_t *s_comm,
 	*ret_req = NULL;
 
 	/* Allocate NCCL OFI request */
-	nccl_net_ofi_rdma_req_t *req = allocate_req(s_comm->nccl_ofi_reqs_fl);
+	nccl_net_ofi_rdma_req_t *req = allocate_comm_req(&s_comm->reqs);
 	if (OFI_UNLIKELY(req == NULL)) {
 		NCCL_OFI_WARN("Unable to get NCCL OFI request for device");
 		return -ENOMEM;
@@ -5367,18 +7562,17 @@ static int alloc_rdma_send_req(nccl_net_ofi_rdma_send_comm_t *s_comm,
 					uint16_t msg_seq_num,
 					void *buff, size_t size,
 					nccl_net_ofi_rdma_mr_handle_t *buff_mr_handle,
-					bool eager,
+					bool eager, bool pull,
 					nccl_net_ofi_rdma_req_t **ret_req)
 {
 	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)s_comm->base.base.ep;
-	nccl_net_ofi_rdma_device_t *device = rdma_endpoint_get_device(ep);
 	nccl_net_ofi_rdma_domain_t *domain = rdma_endpoint_get_domain(ep);
 	assert(domain != NULL);
 	nccl_net_ofi_scheduler_t *scheduler = domain->scheduler;
 	*ret_req = NULL;
 
 	/* Allocate NCCL OFI request */
-	nccl_net_ofi_rdma_req_t *req = allocate_req(s_comm->nccl_ofi_reqs_fl);
+	nccl_net_ofi_rdma_req_t *req = allocate_comm_req(&s_comm->reqs);
 	if (OFI_UNLIKELY(req == NULL)) {
 		NCCL_OFI_WARN("Unable to get NCCL OFI request for device");
 		return -ENOMEM;
@@ -5399,8 +7593,20 @@ static int alloc_rdma_send_req(nccl_net_ofi_rdma_send_comm_t *s_comm,
 	/* If this is not an eager send, the schedule is created after knowing the
 	   remote length received in the control message.
 	 */
-	if (eager) {
-		send_data->schedule = scheduler->get_schedule(scheduler, size, device->num_rails);
+	if (eager && size == 0 && ep->zero_byte_inject) {
+		/* Zero-byte eager message is injected without a
+		   schedule (see post_rdma_zero_byte_send()). One extra
+		   completion is expected for the ctrl msg recv. */
+		send_data->total_num_compls = 2;
+		send_data->wdata = GET_RDMA_WRITE_IMM_DATA(s_comm->remote_comm_id, req->msg_seq_num, 1);
+	} else if (eager) {
+		int num_rails = 0;
+		int ret = rdma_send_comm_get_sched_rails(s_comm, size, &num_rails);
+		if (OFI_UNLIKELY(ret != 0)) {
+			return ret;
+		}
+
+		send_data->schedule = scheduler->get_schedule(scheduler, size, num_rails);
 		if (OFI_UNLIKELY(send_data->schedule == NULL)) {
 			return -EINVAL;
 		}
@@ -5413,7 +7619,14 @@ static int alloc_rdma_send_req(nccl_net_ofi_rdma_send_comm_t *s_comm,
 	}
 
 	send_data->eager = eager;
-	assert((!eager) || (send_data->schedule->num_xfer_infos == 1));
+	assert((!eager) || send_data->schedule == NULL || (send_data->schedule->num_xfer_infos == 1));
+
+	/* Pull sends are completed by the PULL_DONE message of the
+	   receiver, unless the receiver advertised its buffer first */
+	send_data->pull = pull;
+	/* The thread calling send() owns the request until it posted
+	   the pull message */
+	send_data->pull_state = NCCL_OFI_RDMA_PULL_POSTING;
 
 	*ret_req = req;
 
@@ -5463,7 +7676,7 @@ static int insert_rdma_send_req_into_msgbuff(nccl_net_ofi_rdma_send_comm_t *s_co
 	return 0;
 }
 
-static int post_rma_write(nccl_net_ofi_rdma_req_t *req)
+static int post_rma_write(nccl_net_ofi_rdma_req_t *req, bool set_fi_more)
 {
 	nccl_net_ofi_rdma_send_comm_t *s_comm = (nccl_net_ofi_rdma_send_comm_t *)req->comm;
 	uint16_t rail_id = 0;
@@ -5495,74 +7708,366 @@ static int post_rma_write(nccl_net_ofi_rdma_req_t *req)
 	msg.data = 0;
 
 	/* Post the message using fi_writemsg with FI_INJECT */
-	rc = fi_writemsg(comm_rail->local_ep, &msg, rma_op_data->flags);
+	rc = fi_writemsg(comm_rail->local_ep, &msg,
+			 rma_op_data->flags | (set_fi_more ? FI_MORE : 0));
 
 	if ((rc != 0) && (rc != -FI_EAGAIN)) {
 		NCCL_OFI_WARN("fi_write_inline failed; RC: %zd, Error: %s",
 			      rc, fi_strerror(-rc));
+	} else if (rc == 0) {
+		rdma_ep_mark_rail_active((nccl_net_ofi_rdma_ep_t *)s_comm->base.base.ep, rail_id);
+	}
+
+	return rc;
+}
+
+static int post_rdma_write(nccl_net_ofi_rdma_req_t *req,
+			   nccl_net_ofi_rdma_send_comm_rail_t *comm_rail,
+			   nccl_net_ofi_xfer_info_t *xfer_info,
+			   bool no_target_completion,
+			   bool set_fi_more)
+{
+	rdma_req_send_data_t *send_data = get_send_data(req);
+	assert(xfer_info->rail_id < send_data->buff_mr_handle->num_rails);
+	uint16_t rail_id = xfer_info->rail_id;
+	void *desc = send_data->buff_mr_handle->desc[rail_id];
+	struct iovec iov;
+	struct fi_rma_iov rma_iov;
+	struct fi_msg_rma msg;
+	uint64_t flags = 0;
+
+	if (!no_target_completion) {
+		flags |= FI_REMOTE_CQ_DATA;
+	}
+	if (set_fi_more) {
+		flags |= FI_MORE;
+	}
+
+	iov.iov_base = (void*)((uintptr_t)send_data->buff + xfer_info->offset);
+	iov.iov_len = xfer_info->msg_size;
+
+	rma_iov.addr = send_data->remote_buff + xfer_info->offset;
+	rma_iov.len = xfer_info->msg_size;
+	rma_iov.key = send_data->remote_mr_key[rail_id];
+
+	msg.msg_iov = &iov;
+	msg.desc = &desc;
+	msg.iov_count = 1;
+	msg.addr = comm_rail->remote_addr;
+	msg.rma_iov = &rma_iov;
+	msg.rma_iov_count = 1;
+	msg.context = rdma_req_get_ofi_context(req, rail_id);
+	msg.data = send_data->wdata;
+
+	/* Post RDMA write */
+	ssize_t rc = fi_writemsg(comm_rail->local_ep, &msg, flags);
+	if ((rc != 0) && (rc != -FI_EAGAIN)) {
+		NCCL_OFI_WARN("fi_writemsg failed; RC: %zd, Error: %s",
+			      rc, fi_strerror(-rc));
+	} else if (rc == 0) {
+		NCCL_OFI_TRACE_SEND_WRITE_SEG_START(req->dev_id, rail_id, xfer_info->msg_size, req->comm, req->msg_seq_num, req);
+		rdma_ep_mark_rail_active((nccl_net_ofi_rdma_ep_t *)req->comm->ep, rail_id);
+	}
+
+	return rc;
+}
+
+static int post_rdma_eager_send(nccl_net_ofi_rdma_req_t *req,
+				nccl_net_ofi_rdma_send_comm_rail_t *comm_rail,
+				nccl_net_ofi_xfer_info_t *xfer_info,
+				bool set_fi_more)
+{
+	rdma_req_send_data_t *send_data = get_send_data(req);
+	assert(xfer_info->rail_id < send_data->buff_mr_handle->num_rails);
+	uint16_t rail_id = xfer_info->rail_id;
+	void *desc = send_data->buff_mr_handle->desc[rail_id];
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)req->comm->ep;
+
+	ssize_t rc;
+	if ((ssize_t)xfer_info->msg_size <= ep->eager_inject_size &&
+	    send_data->buff_mr_handle->host_mem) {
+		/* Inject eager send. The provider copies the payload
+		   and generates no send completion, so the send side
+		   of the request completes right away. Injects take
+		   no flags; posting one also submits any operations
+		   deferred by FI_MORE. */
+		rc = fi_injectdata(comm_rail->local_ep,
+				   (void*)(((uintptr_t)send_data->buff) + xfer_info->offset),
+				   xfer_info->msg_size, send_data->wdata, comm_rail->remote_addr);
+		if (rc != 0) {
+			if (rc != -FI_EAGAIN) {
+				NCCL_OFI_WARN("fi_injectdata failed; RC: %zd, Error: %s", rc, fi_strerror(-rc));
+			}
+			return rc;
+		}
+
+		NCCL_OFI_TRACE_EAGER_SEND_START(req->dev_id, rail_id, xfer_info->msg_size, req->comm, req->msg_seq_num, req);
+		NCCL_OFI_TRACE_EAGER_SEND_COMPLETE(req->dev_id, rail_id, req->comm, req->msg_seq_num, req);
+
+		/* The schedule is not needed anymore. Release it
+		   before counting the completion, since the request
+		   may be freed as soon as it is completed. */
+		nccl_net_ofi_rdma_domain_t *domain = rdma_endpoint_get_domain(ep);
+		nccl_net_ofi_release_schedule(domain->scheduler, send_data->schedule);
+		send_data->schedule = NULL;
+
+		return inc_req_completion(req, 0, send_data->total_num_compls);
+	}
+
+	struct iovec iov;
+	struct fi_msg msg;
+	uint64_t flags = FI_REMOTE_CQ_DATA;
+
+	if (set_fi_more) {
+		flags |= FI_MORE;
+	}
+
+	iov.iov_base = (void*)(((uintptr_t)send_data->buff) + xfer_info->offset);
+	iov.iov_len = xfer_info->msg_size;
+
+	msg.msg_iov = &iov;
+	msg.desc = &desc;
+	msg.iov_count = 1;
+	msg.addr = comm_rail->remote_addr;
+	msg.context = rdma_req_get_ofi_context(req, rail_id);
+	msg.data = send_data->wdata;
+
+	/* Post eager send */
+	rc = fi_sendmsg(comm_rail->local_ep, &msg, flags);
+
+	if ((rc != 0) && (rc != -FI_EAGAIN)) {
+		NCCL_OFI_WARN("fi_sendmsg failed; RC: %zd, Error: %s", rc, fi_strerror(-rc));
+	} else if (rc == 0) {
+		NCCL_OFI_TRACE_EAGER_SEND_START(req->dev_id, rail_id, xfer_info->msg_size, req->comm, req->msg_seq_num, req);
+		rdma_ep_mark_rail_active(ep, rail_id);
 	}
 
 	return rc;
 }
 
-static int post_rdma_write(nccl_net_ofi_rdma_req_t *req,
-			   nccl_net_ofi_rdma_send_comm_rail_t *comm_rail,
-			   nccl_net_ofi_xfer_info_t *xfer_info,
-			   bool no_target_completion)
+/*
+ * @brief	Post a zero-byte message of a send request
+ *
+ * Zero-byte messages carry nothing but the immediate data that
+ * identifies the message at the receiver. They are injected on the
+ * first data rail as an eager send, or as an RDMA write if the
+ * receiver's ctrl message has arrived, without a schedule or memory
+ * descriptor. Injects generate no send completion, so the send side of
+ * the request completes right away. If the receiver asked for no
+ * completion, there is nothing to transfer at all.
+ *
+ * @return	0, on success
+ *		-FI_EAGAIN, if the inject needs to be retried
+ *		error, on others
+ */
+static int post_rdma_zero_byte_send(nccl_net_ofi_rdma_req_t *req)
+{
+	nccl_net_ofi_rdma_send_comm_t *s_comm = (nccl_net_ofi_rdma_send_comm_t *)req->comm;
+	rdma_req_send_data_t *send_data = get_send_data(req);
+	uint16_t rail_id = 0;
+	nccl_net_ofi_rdma_send_comm_rail_t *comm_rail = rdma_send_comm_get_rail(s_comm, rail_id);
+	ssize_t rc = 0;
+
+	assert(send_data->buff_len == 0 && send_data->schedule == NULL);
+
+	if (send_data->eager) {
+		rc = fi_injectdata(comm_rail->local_ep, NULL, 0, send_data->wdata,
+				   comm_rail->remote_addr);
+		if (rc != 0) {
+			if (rc != -FI_EAGAIN) {
+				NCCL_OFI_WARN("fi_injectdata failed; RC: %zd, Error: %s", rc, fi_strerror(-rc));
+			}
+			return rc;
+		}
+
+		NCCL_OFI_TRACE_EAGER_SEND_START(req->dev_id, rail_id, 0, req->comm, req->msg_seq_num, req);
+		NCCL_OFI_TRACE_EAGER_SEND_COMPLETE(req->dev_id, rail_id, req->comm, req->msg_seq_num, req);
+	} else if (!send_data->no_target_completion) {
+		rc = fi_inject_writedata(comm_rail->local_ep, NULL, 0, send_data->wdata,
+					 comm_rail->remote_addr, send_data->remote_buff,
+					 send_data->remote_mr_key[rail_id]);
+		if (rc != 0) {
+			if (rc != -FI_EAGAIN) {
+				NCCL_OFI_WARN("fi_inject_writedata failed; RC: %zd, Error: %s", rc, fi_strerror(-rc));
+			}
+			return rc;
+		}
+
+		NCCL_OFI_TRACE_SEND_WRITE_SEG_START(req->dev_id, rail_id, 0, req->comm, req->msg_seq_num, req);
+		NCCL_OFI_TRACE_SEND_WRITE_SEG_COMPLETE(req->dev_id, rail_id, req->comm, req->msg_seq_num, req);
+	}
+
+	return inc_req_completion(req, 0, send_data->total_num_compls);
+}
+
+/*
+ * @brief	Return true if the receiver should pull a message of `size'
+ *		bytes from the buffer registered with `mr_handle'
+ *
+ * Only device buffers are registered for remote reads. Their remote
+ * keys must fit the ctrl message encoding of the endpoint.
+ */
+static inline bool rdma_send_can_pull(nccl_net_ofi_rdma_ep_t *ep, size_t size,
+				      nccl_net_ofi_rdma_mr_handle_t *mr_handle)
+{
+	if (ep->pull_min_size < 0 || (ssize_t)size < ep->pull_min_size ||
+	    size == 0 || size > UINT32_MAX || mr_handle->host_mem) {
+		return false;
+	}
+
+	if (OFI_UNLIKELY(!mr_handle->rkeys_valid)) {
+		rdma_mr_handle_cache_keys(mr_handle);
+		if (!mr_handle->rkeys_valid) {
+			return false;
+		}
+	}
+
+	return ep->use_long_rkeys || mr_handle->short_rkeys_valid;
+}
+
+/*
+ * @brief	Post the data of send request `req', i.e., its eager
+ *		send, or its writes into the buffer advertised by the
+ *		receiver
+ *
+ * Writes striped over multiple rails resume from `xferred_rail_id'.
+ * See send_progress() for `set_fi_more'.
+ *
+ * @return	0, on success
+ *		-FI_EAGAIN, if the remaining operations need to be retried
+ *		error, on others
+ */
+static int post_rdma_send_data(nccl_net_ofi_rdma_req_t *req, bool set_fi_more)
 {
+	ssize_t ret = 0;
+	nccl_net_ofi_rdma_send_comm_t *s_comm = (nccl_net_ofi_rdma_send_comm_t *)req->comm;
 	rdma_req_send_data_t *send_data = get_send_data(req);
-	assert(xfer_info->rail_id < send_data->buff_mr_handle->num_rails);
-	uint16_t rail_id = xfer_info->rail_id;
-	struct fid_mr *rail_mr_handle = send_data->buff_mr_handle->mr[rail_id];
-	void *desc = fi_mr_desc(rail_mr_handle);
 
-	ssize_t rc;
-	/* Post RDMA write */
-	if (no_target_completion) {
-		rc = fi_write(comm_rail->local_ep, (void*)((uintptr_t)send_data->buff + xfer_info->offset),
-					xfer_info->msg_size, desc,
-					comm_rail->remote_addr,
-					send_data->remote_buff + xfer_info->offset,
-					send_data->remote_mr_key[rail_id], rdma_req_get_ofi_context(req, rail_id));
-	} else {
-		rc = fi_writedata(comm_rail->local_ep, (void*)((uintptr_t)send_data->buff + xfer_info->offset),
-					xfer_info->msg_size, desc, send_data->wdata,
-					comm_rail->remote_addr,
-					send_data->remote_buff + xfer_info->offset,
-					send_data->remote_mr_key[rail_id], rdma_req_get_ofi_context(req, rail_id));
+	// Get Schedule
+	nccl_net_ofi_schedule_t *schedule = send_data->schedule;
+	if (schedule == NULL && send_data->buff_len == 0) {
+		/* Zero-byte messages are not scheduled */
+		return post_rdma_zero_byte_send(req);
 	}
-	if ((rc != 0) && (rc != -FI_EAGAIN)) {
-		NCCL_OFI_WARN("fi_writedata failed; RC: %zd, Error: %s",
-			      rc, fi_strerror(-rc));
-	} else if (rc == 0) {
-		NCCL_OFI_TRACE_SEND_WRITE_SEG_START(req->dev_id, rail_id, xfer_info->msg_size, req->comm, req->msg_seq_num, req);
+	if (OFI_UNLIKELY(schedule == NULL)) {
+		NCCL_OFI_WARN("Schedule for req %p is NULL", req);
+		return -ENOTSUP;
 	}
 
-	return rc;
+	assert(!(send_data->eager) || schedule->num_xfer_infos == 1);
+
+	nccl_net_ofi_xfer_info_t *xfers = schedule->rail_xfer_infos;
+
+	if (send_data->eager) {
+		/* Get xfer information from the schedule */
+		nccl_net_ofi_xfer_info_t *xfer_info = &xfers[0];
+
+		/* Get communicator rail information to xfer the req */
+		nccl_net_ofi_rdma_send_comm_rail_t *comm_rail =
+			rdma_send_comm_get_rail(s_comm, xfer_info->rail_id);
+
+		ret = post_rdma_eager_send(req, comm_rail, xfer_info, set_fi_more);
+	} else {
+		uint16_t first_xfer = send_data->xferred_rail_id;
+		set_fi_more = set_fi_more && ((size_t)first_xfer + 1 == schedule->num_xfer_infos);
+		for (uint16_t rail_it = first_xfer; rail_it < schedule->num_xfer_infos; rail_it++) {
+			/* Get xfer information from the schedule */
+			nccl_net_ofi_xfer_info_t *xfer_info = &xfers[rail_it];
+			/* Get communicator rail information to xfer the req */
+			nccl_net_ofi_rdma_send_comm_rail_t *comm_rail =
+				rdma_send_comm_get_rail(s_comm, xfer_info->rail_id);
+
+			ret = post_rdma_write(req, comm_rail, xfer_info, send_data->no_target_completion,
+					      set_fi_more);
+
+			if (ret == 0) // Successfully sent the xfer with this rail
+				send_data->xferred_rail_id++;
+			else
+				break;
+		}
+	}
+
+	return ret;
 }
 
-static int post_rdma_eager_send(nccl_net_ofi_rdma_req_t *req,
-				nccl_net_ofi_rdma_send_comm_rail_t *comm_rail,
-				nccl_net_ofi_xfer_info_t *xfer_info)
+/*
+ * @brief	Inject the pull message of send request `req' on the
+ *		first control rail
+ *
+ * The message advertises the source buffer and its remote keys, in
+ * the layout of a ctrl message. It is built on the stack, since the
+ * provider copies injected messages, and generates no send
+ * completion. The send request completes once the PULL_DONE message
+ * of the receiver arrives, or once the data was written if the
+ * receiver responds with a ctrl message instead.
+ *
+ * Must only be called by the owner of the request (see
+ * nccl_ofi_rdma_pull_state_t). If the ctrl message of the receiver
+ * arrived in the meantime, the writes are posted instead. If the
+ * handler of the ctrl message took the request over while the inject
+ * failed, the request is left to the handler.
+ *
+ * @return	0, on success
+ *		-FI_EAGAIN, if the inject or the writes need to be retried
+ *		error, on others
+ */
+static int post_rdma_pull_msg(nccl_net_ofi_rdma_req_t *req)
 {
+	nccl_net_ofi_rdma_send_comm_t *s_comm = (nccl_net_ofi_rdma_send_comm_t *)req->comm;
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)s_comm->base.base.ep;
 	rdma_req_send_data_t *send_data = get_send_data(req);
-	assert(xfer_info->rail_id < send_data->buff_mr_handle->num_rails);
-	uint16_t rail_id = xfer_info->rail_id;
-	struct fid_mr *rail_mr_handle = send_data->buff_mr_handle->mr[rail_id];
-	void *desc = fi_mr_desc(rail_mr_handle);
-
-	ssize_t rc;
-	/* Post eager send */
-	rc = fi_senddata(comm_rail->local_ep, (void*)(((uintptr_t)send_data->buff) + xfer_info->offset), xfer_info->msg_size, desc,
-			 send_data->wdata, comm_rail->remote_addr, rdma_req_get_ofi_context(req, rail_id));
-
-	if ((rc != 0) && (rc != -FI_EAGAIN)) {
-		NCCL_OFI_WARN("fi_senddata failed; RC: %zd, Error: %s", rc, fi_strerror(-rc));
-	} else if (rc == 0) {
-		NCCL_OFI_TRACE_EAGER_SEND_START(req->dev_id, rail_id, xfer_info->msg_size, req->comm, req->msg_seq_num, req);
+	nccl_net_ofi_rdma_mr_handle_t *mr_handle = send_data->buff_mr_handle;
+	nccl_net_ofi_rdma_send_comm_rail_t *comm_rail = rdma_send_comm_get_control_rail(s_comm, 0);
+	nccl_net_ofi_rdma_ctrl_msg_t pull_msg = {};
+
+	pull_msg.type = NCCL_OFI_RDMA_MSG_PULL;
+	pull_msg.msg_seq_num = req->msg_seq_num;
+	pull_msg.remote_comm_id = s_comm->remote_comm_id;
+	/* `buff_len' may be shrunk concurrently by the handler of a
+	   ctrl message, whereas `size' is updated atomically */
+	pull_msg.buff_len = __atomic_load_n(&req->size, __ATOMIC_RELAXED);
+	pull_msg.buff_addr = (uint64_t)send_data->buff;
+
+	assert(mr_handle->num_rails == ep->num_rails);
+	if (ep->use_long_rkeys) {
+		memcpy(pull_msg.long_buff_mr_key, mr_handle->long_rkeys,
+		       ep->num_rails * NCCL_NET_OFI_CTRL_MSG_LONG_KEY_SIZE);
+	} else {
+		memcpy(pull_msg.short_buff_mr_key, mr_handle->short_rkeys,
+		       ep->num_rails * NCCL_NET_OFI_CTRL_MSG_SHORT_KEY_SIZE);
+	}
+
+	/* The response of the receiver may be processed as soon as
+	   the message is injected, so the request is released before */
+	nccl_ofi_rdma_pull_state_t state = NCCL_OFI_RDMA_PULL_POSTING;
+	if (!__atomic_compare_exchange_n(&send_data->pull_state, &state, NCCL_OFI_RDMA_PULL_POSTED,
+					 false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		/* The receiver advertised its buffer already */
+		assert(state == NCCL_OFI_RDMA_PULL_WRITES);
+		return post_rdma_send_data(req, false);
+	}
+
+	ssize_t rc = fi_inject(comm_rail->local_ep, &pull_msg,
+			       nccl_net_ofi_rdma_ctrl_msg_size(ep->num_rails, ep->use_long_rkeys),
+			       comm_rail->remote_addr);
+	if (rc != 0) {
+		/* Take the request back, unless the handler of a ctrl
+		   message owns it by now */
+		state = NCCL_OFI_RDMA_PULL_POSTED;
+		if (!__atomic_compare_exchange_n(&send_data->pull_state, &state,
+						 NCCL_OFI_RDMA_PULL_POSTING, false,
+						 __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) &&
+		    rc == -FI_EAGAIN) {
+			return 0;
+		}
+		if (rc != -FI_EAGAIN) {
+			NCCL_OFI_WARN("fi_inject of pull message failed; RC: %zd, Error: %s",
+				      rc, fi_strerror(-rc));
+		}
+		return rc;
 	}
 
-	return rc;
+	return 0;
 }
 
 static int post_rx_buffer(nccl_net_ofi_rdma_req_t *req,
@@ -5573,7 +8078,7 @@ static int post_rx_buffer(nccl_net_ofi_rdma_req_t *req,
 	nccl_ofi_freelist_elem_t *rx_buff_fl_elem = rx_buff_data->rx_buff_fl_elem;
 	freelist_regmr_fn_handle_t *fl_mr_handle =
 		(freelist_regmr_fn_handle_t *)rx_buff_fl_elem->mr_handle;
-	void *desc = fi_mr_desc(fl_mr_handle->mr_handle->mr[rx_buff_data->rail->rail_id]);
+	void *desc = fl_mr_handle->mr_handle->desc[rx_buff_data->rail->rail_id];
 	struct iovec iov;
 	struct fi_msg msg;
 	uint64_t flags = 0;
@@ -5582,6 +8087,14 @@ static int post_rx_buffer(nccl_net_ofi_rdma_req_t *req,
 		flags |= FI_MORE;
 	}
 
+	assert(rx_buff_data->slab_req == NULL);
+	if (rx_buff_data->multi_recv) {
+		flags |= FI_MULTI_RECV;
+		/* Reference held by the provider until it releases the
+		 * slab */
+		rx_buff_data->slab_refcnt = 1;
+	}
+
 	/* Reset memcheck guards of rx buffer freelist entry to
 	 * accessible but undefined to cover cases where the buffer
 	 * gets re-posted */
@@ -5616,59 +8129,33 @@ static int post_rx_buffer(nccl_net_ofi_rdma_req_t *req,
  *		to the network. This can be invoked when submitting a new request
  *		or processing pending requests list.
  *
+ * @param	set_fi_more
+ *		True if the caller posts another operation of the same kind
+ *		(transmit or receive) to the endpoint of the rail the request
+ *		is pending on right after. Only applied if the request posts
+ *		a single operation, so that a later operation of the request
+ *		failing with FI_EAGAIN cannot leave it held back.
+ *
  * @return	0, if successfully sent
  *              -EINVAL   Invalid request
  * 		-FI_EAGAIN, if need to retry the xfer
  * 		-1, error
  */
-static int send_progress(nccl_net_ofi_rdma_req_t *req)
+static int send_progress(nccl_net_ofi_rdma_req_t *req, bool set_fi_more)
 {
 	ssize_t ret = 0;;
-	nccl_net_ofi_rdma_send_comm_t *s_comm = (nccl_net_ofi_rdma_send_comm_t *)req->comm;
 
 	assert(req != NULL);
 
 	if (req->type == NCCL_OFI_RDMA_SEND) { // Post RDMA write
-		rdma_req_send_data_t *send_data = get_send_data(req);
-
-		// Get Schedule
-		nccl_net_ofi_schedule_t *schedule = send_data->schedule;
-		if (OFI_UNLIKELY(schedule == NULL)) {
-			NCCL_OFI_WARN("Schedule for req %p is NULL", req);
-			return -ENOTSUP;;
+		if (rdma_send_data_pull_msg_pending(get_send_data(req))) {
+			/* The data is sent once the receiver responded */
+			return post_rdma_pull_msg(req);
 		}
 
-		assert(!(send_data->eager) || schedule->num_xfer_infos == 1);
-
-		nccl_net_ofi_xfer_info_t *xfers = schedule->rail_xfer_infos;
-
-		if (send_data->eager) {
-			/* Get xfer information from the schedule */
-			nccl_net_ofi_xfer_info_t *xfer_info = &xfers[0];
-
-			/* Get communicator rail information to xfer the req */
-			nccl_net_ofi_rdma_send_comm_rail_t *comm_rail =
-				rdma_send_comm_get_rail(s_comm, xfer_info->rail_id);
-
-			ret = post_rdma_eager_send(req, comm_rail, xfer_info);
-		} else {
-			for (uint16_t rail_it = send_data->xferred_rail_id; rail_it < schedule->num_xfer_infos; rail_it++) {
-				/* Get xfer information from the schedule */
-				nccl_net_ofi_xfer_info_t *xfer_info = &xfers[rail_it];
-				/* Get communicator rail information to xfer the req */
-				nccl_net_ofi_rdma_send_comm_rail_t *comm_rail =
-					rdma_send_comm_get_rail(s_comm, xfer_info->rail_id);
-
-				ret = post_rdma_write(req, comm_rail, xfer_info, send_data->no_target_completion);
-
-				if (ret == 0) // Successfully sent the xfer with this rail
-					send_data->xferred_rail_id++;
-				else
-					break;
-			}
-		}
+		ret = post_rdma_send_data(req, set_fi_more);
 	} else if (req->type == NCCL_OFI_RDMA_WRITE) { // Post RMA write
-		ret = post_rma_write(req);
+		ret = post_rma_write(req, set_fi_more);
 		if (ret == 0) {
 			rdma_req_rma_op_data_t *rma_op_data = req_get_rma_op_data(req, NCCL_OFI_RDMA_WRITE);
 			// Successfully sent the xfer with this rail
@@ -5680,7 +8167,7 @@ static int send_progress(nccl_net_ofi_rdma_req_t *req)
 		/* Get ep rail information to xfer the req */
 		assert(rx_buff_data->rail != NULL);
 
-		ret = post_rx_buffer(req, rx_buff_data->rail, false);
+		ret = post_rx_buffer(req, rx_buff_data->rail, set_fi_more);
 	} else {
 		NCCL_OFI_WARN("Unexpected request type. Request type: %d", req->type);
 		ret = -EINVAL;
@@ -5702,7 +8189,7 @@ static ssize_t send_ctrl_post(nccl_net_ofi_rdma_recv_comm_t *r_comm,
 	nccl_net_ofi_rdma_recv_comm_rail_t *comm_rail = rdma_recv_comm_get_control_rail(r_comm, rail_id);
 
 	assert(rail_id < mr_handle->num_rails);
-	void *desc = fi_mr_desc(mr_handle->mr[rail_id]);
+	void *desc = mr_handle->desc[rail_id];
 
 	ssize_t rc = fi_send(comm_rail->local_ep, ctrl_fl_elem->ptr,
 			size,
@@ -5711,6 +8198,8 @@ static ssize_t send_ctrl_post(nccl_net_ofi_rdma_recv_comm_t *r_comm,
 	if ((rc != 0) && (rc != -FI_EAGAIN)) {
 		NCCL_OFI_WARN("Error posting RDMA %s request. RC: %zd, Error: %s",
 			      nccl_net_ofi_req_str(req), rc, fi_strerror(-rc));
+	} else if (rc == 0) {
+		rdma_ep_mark_rail_active((nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep, rail_id);
 	}
 	return rc;
 }
@@ -5788,6 +8277,14 @@ static int post_eager_copy(nccl_net_ofi_rdma_req_t *req)
 	// Get communicator rail information to xfer the req
 	nccl_net_ofi_rdma_recv_comm_rail_t *comm_rail;
 	uint16_t rx_rail_id = rx_buff_data->rail->rail_id;
+	if (rx_rail_id != 0) {
+		/* The sender activated its data rails */
+		int ret = rdma_recv_comm_activate_rails(r_comm);
+		if (OFI_UNLIKELY(ret != 0)) {
+			return ret;
+		}
+	}
+	assert(rx_rail_id < __atomic_load_n(&r_comm->num_active_rails, __ATOMIC_ACQUIRE));
 	comm_rail = rdma_recv_comm_get_rail(r_comm, rx_rail_id);
 
 	/* Unpack mr_handle */
@@ -5798,10 +8295,10 @@ static int post_eager_copy(nccl_net_ofi_rdma_req_t *req)
 	nccl_net_ofi_rdma_mr_handle_t *dest_mr_handle = recv_data->dest_mr_handle;
 
 	assert(rx_rail_id < dest_mr_handle->num_rails);
-	void *desc = fi_mr_desc(dest_mr_handle->mr[rx_rail_id]);
+	void *desc = dest_mr_handle->desc[rx_rail_id];
 
-	void *rx_buff = rx_buff_data->rx_buff_fl_elem->ptr;
-	uint64_t rx_key = fi_mr_key(rx_mr_handle->mr[rx_rail_id]);
+	void *rx_buff = rx_buff_data->buff;
+	uint64_t rx_key = rdma_mr_handle_get_rkey(rx_mr_handle, rx_rail_id);
 	if (rx_key == FI_KEY_NOTAVAIL) {
 		NCCL_OFI_WARN("Failed to get rx_key");
 		return -EIO;
@@ -5814,6 +8311,8 @@ static int post_eager_copy(nccl_net_ofi_rdma_req_t *req)
 	if ((rc != 0) && (rc != -FI_EAGAIN)) {
 		NCCL_OFI_WARN("Error posting RDMA ctrl request. RC: %zd, Error: %s",
 			      rc, fi_strerror(-rc));
+	} else if (rc == 0) {
+		rdma_ep_mark_rail_active((nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep, rx_rail_id);
 	}
 
 	return rc;
@@ -5829,19 +8328,18 @@ static int post_flush_req(nccl_net_ofi_rdma_req_t *req)
 	nccl_net_ofi_rdma_recv_comm_rail_t *comm_rail;
 	ssize_t rc = 0;
 
-	/* iterate all rails and post RDMA local read */
-	for (uint16_t rail_id = 0; rail_id < ep->num_rails; rail_id++) {
+	/* iterate all active rails and post RDMA local read. Use the
+	 * rail count captured at allocation, since rails may have been
+	 * activated while the flush was pending. */
+	for (uint16_t rail_id = 0; rail_id < flush_data->total_num_compls; rail_id++) {
 		comm_rail = rdma_recv_comm_get_rail(r_comm, rail_id);
 
-		void *desc = fi_mr_desc(f_buff->mr_handle->mr[rail_id]);
+		void *desc = f_buff->mr_handle->desc[rail_id];
 
 		uint64_t cuda_key = 0ULL;
 		if (flush_data->mr_handle != NULL) {
-			struct fid_mr *mr_handle = NULL;
-			mr_handle = flush_data->mr_handle->mr[rail_id];
-
 			/* Extract remote key */
-			cuda_key = fi_mr_key(mr_handle);
+			cuda_key = rdma_mr_handle_get_rkey(flush_data->mr_handle, rail_id);
 			if (OFI_UNLIKELY(cuda_key == FI_KEY_NOTAVAIL)) {
 				NCCL_OFI_WARN("Memory registration may not have completed.");
 				rc = -FI_ENODATA;
@@ -5860,6 +8358,8 @@ static int post_flush_req(nccl_net_ofi_rdma_req_t *req)
 			NCCL_OFI_WARN("Error posting flush request. RC: %zd, Error: %s",
 				      rc, fi_strerror(-rc));
 			goto exit;
+		} else if (rc == 0) {
+			rdma_ep_mark_rail_active(ep, rail_id);
 		}
 	}
 
@@ -5873,12 +8373,17 @@ static inline int check_post_rx_buff_req(nccl_net_ofi_rdma_req_t *rx_buff_req)
 	rdma_req_rx_buff_data_t *rx_buff_data = get_rx_buff_data(rx_buff_req);
 	nccl_net_ofi_rdma_ep_t *ep = rx_buff_data->ep;
 
+	if (rx_buff_data->slab_req != NULL) {
+		return put_rx_buff_msg(rx_buff_req);
+	}
+
 	nccl_net_ofi_ep_rail_t *rail = rx_buff_data->rail;
 
 	nccl_net_ofi_mutex_lock(&rail->rx_buff_mutex);
 
 	bool need_post = false;
-	if (rail->num_rx_buff_posted < rail->max_rx_buff_posted) {
+	rdma_rail_tune_rx_buff(rail);
+	if (rail->num_rx_buff_posted < rail->target_rx_buff_posted) {
 		++(rail->num_rx_buff_posted);
 		need_post = true;
 	}
@@ -5887,12 +8392,10 @@ static inline int check_post_rx_buff_req(nccl_net_ofi_rdma_req_t *rx_buff_req)
 
 	if (need_post) {
 		/* Attempt to re-post rx buffer */
-		ret = send_progress(rx_buff_req);
+		ret = send_progress(rx_buff_req, false);
 		if (ret == -FI_EAGAIN) {
 			/* Place in pending requests queue for next try */
-			nccl_net_ofi_mutex_lock(&ep->pending_reqs_lock);
-			ep->pending_reqs_queue->push_back(rx_buff_req);
-			nccl_net_ofi_mutex_unlock(&ep->pending_reqs_lock);
+			rdma_ep_add_pending_req(ep, rx_buff_req);
 			NCCL_OFI_TRACE_PENDING_INSERT(rx_buff_req);
 
 			return 0;
@@ -5930,6 +8433,7 @@ static int send(nccl_net_ofi_send_comm_t *send_comm, void *data, size_t size, in
 	bool polled_cq = false;
 	bool have_ctrl = false;
 	bool eager = false;
+	bool pull = false;
 	int dev_id = 0;
 
 	assert(s_comm != NULL);
@@ -6020,15 +8524,20 @@ static int send(nccl_net_ofi_send_comm_t *send_comm, void *data, size_t size, in
 	/* look for control messages and then retry the message search
 	   to avoid unnecessary polling / queueing. */
 	if (OFI_UNLIKELY(!polled_cq && !have_ctrl)) {
+		size_t num_cqes = 0;
+
 		for (uint16_t rail_id = 0; rail_id != s_comm->num_control_rails; ++rail_id) {
 			nccl_net_ofi_rdma_domain_rail_t *rail =
 				rdma_domain_get_rail(domain, rail_id);
 
-			ret = ofi_process_cq_rail(rdma_domain_get_device(domain), rail);
+			ret = ofi_process_cq_rail(rdma_domain_get_device(domain), rail, &num_cqes);
 			if (OFI_UNLIKELY(ret != 0)) {
 				goto error;
 			}
 		}
+		if (domain->cq_epoll_fd >= 0 && num_cqes > 0) {
+			__atomic_fetch_add(&domain->num_cqes_read, num_cqes, __ATOMIC_RELAXED);
+		}
 		polled_cq = true;
 		goto retry;
 	}
@@ -6056,8 +8565,11 @@ static int send(nccl_net_ofi_send_comm_t *send_comm, void *data, size_t size, in
 		eager = true;
 	}
 
+	/* Determine if the receiver should pull the data */
+	pull = (!have_ctrl && !eager && rdma_send_can_pull(ep, size, mr_handle));
+
 	ret = alloc_rdma_send_req(s_comm, msg_seq_num, data,
-				  size, mr_handle, eager, &req);
+				  size, mr_handle, eager, pull, &req);
 	if (OFI_UNLIKELY(ret != 0)) {
 		goto error;
 	}
@@ -6098,15 +8610,14 @@ static int send(nccl_net_ofi_send_comm_t *send_comm, void *data, size_t size, in
 
 	NCCL_OFI_TRACE_SEND(req->dev_id, size, s_comm, msg_seq_num, req, base_req);
 
-	/* Try posting RDMA write for received RDMA control messages */
-	if (have_ctrl || eager) {
+	/* Try posting RDMA write for received RDMA control messages,
+	   or the pull message */
+	if (have_ctrl || eager || pull) {
 
-		ret = send_progress(req);
+		ret = send_progress(req, false);
 		if (ret == -FI_EAGAIN) {
 			/* Add to pending reqs queue */
-			nccl_net_ofi_mutex_lock(&ep->pending_reqs_lock);
-			ep->pending_reqs_queue->push_back(req);
-			nccl_net_ofi_mutex_unlock(&ep->pending_reqs_lock);
+			rdma_ep_add_pending_req(ep, req);
 			ret = 0;
 			NCCL_OFI_TRACE_PENDING_INSERT(req);
 		} else if (OFI_UNLIKELY(ret != 0)) {
@@ -6163,7 +8674,7 @@ static int send_close_deferred(nccl_net_ofi_send_comm_t *send_comm)
 	nccl_net_ofi_mutex_lock(&comm_cleanup_list_lock);
 
 	/* Deferred cleanup */
-	s_comm_cleanup_list->push_back(s_comm);
+	rdma_ep_add_closing_comm((nccl_net_ofi_rdma_ep_t *)s_comm->base.base.ep, s_comm, NULL);
 
 	assert(num_open_comms > 0);
 	num_open_comms--;
@@ -6197,77 +8708,339 @@ static void prepare_send_connect_message(nccl_net_ofi_rdma_ep_t *ep, int dev_id,
 	int num_control_rails = ep->num_control_rails;
 
 	conn_msg->type = NCCL_OFI_RDMA_MSG_CONN;
+	conn_msg->version = NCCL_OFI_RDMA_PROTOCOL_VERSION;
 
 	/* Send s_comm's local comm ID to be transferred to receiver */
 	conn_msg->local_comm_id = local_comm_id;
 
-	/* Send s_comm's remote comm ID */
-	conn_msg->remote_comm_id = remote_comm_id;
+	/* Send s_comm's remote comm ID */
+	conn_msg->remote_comm_id = remote_comm_id;
+
+	/* Set number of rails to be sent back to remote for verification */
+	conn_msg->num_rails = num_rails;
+	conn_msg->num_control_rails = num_control_rails;
+
+	/* Ask receiver to bring up data rails lazily */
+	conn_msg->lazy_data_rails = (ofi_nccl_rdma_lazy_data_rails() != 0 && num_rails > 1);
+
+	/* Set libfabric endpoint names for each rail */
+	rdma_ep_set_connection_info_ep_names(ep, conn_msg);
+}
+
+/*
+ * @brief	Allocate a RDMA send communicator with `num_rails' rails using `calloc()'
+ *
+ * @param	num_rails
+ *		The number of rails of the allocated send communicator
+ * @param	num_control_rails
+ *		The number of control rails of the allocated send communicator
+ * @return	communicator, on success
+ *		NULL, on error
+ */
+static inline nccl_net_ofi_rdma_send_comm_t *calloc_rdma_send_comm(int num_rails, int num_control_rails)
+{
+	nccl_net_ofi_rdma_send_comm_t *s_comm = (nccl_net_ofi_rdma_send_comm_t *)calloc(1, sizeof(nccl_net_ofi_rdma_send_comm_t));
+	if (OFI_UNLIKELY(!s_comm)) {
+		NCCL_OFI_WARN("Unable to allocate send communicator");
+        goto error;
+    }
+
+	s_comm->rails = (nccl_net_ofi_rdma_send_comm_rail_t *)calloc(num_rails, sizeof(nccl_net_ofi_rdma_send_comm_rail_t));
+    if (OFI_UNLIKELY(!s_comm->rails)) {
+        NCCL_OFI_WARN("Unable to allocate send communicator rails array");
+        goto error;
+    }
+
+	s_comm->control_rails = (nccl_net_ofi_rdma_send_comm_rail_t *)calloc(num_control_rails, sizeof(nccl_net_ofi_rdma_send_comm_rail_t));
+    if (OFI_UNLIKELY(!s_comm->control_rails)) {
+        NCCL_OFI_WARN("Unable to allocate send communicator control rails array");
+        goto error;
+    }
+
+    return s_comm;
+
+error:
+
+    free_rdma_send_comm(s_comm);
+    return NULL;
+}
+
+/*
+ * @brief	Return true if endpoint `ep' receives into the rx buffers
+ *		of the shared rx endpoint of its domain instead of
+ *		posting its own
+ */
+static inline bool rdma_ep_uses_shared_rx(nccl_net_ofi_rdma_ep_t *ep)
+{
+	nccl_net_ofi_rdma_domain_t *domain = rdma_endpoint_get_domain(ep);
+	return domain->shared_rx_ep != NULL && domain->shared_rx_ep != ep;
+}
+
+/*
+ * @brief	Set up receiving into rx buffer slabs with FI_MULTI_RECV
+ *		on all rails of endpoint, if requested and supported
+ *
+ * Sets ep->multi_recv_msgs. Falls back to one message per rx buffer
+ * if the provider does not support setting the minimum free space
+ * of a slab.
+ */
+static int rdma_ep_init_multi_recv(nccl_net_ofi_rdma_ep_t *ep)
+{
+	int ret = 0;
+	nccl_net_ofi_rdma_device_t *device = rdma_endpoint_get_device(ep);
+	size_t multi_recv_msgs = ofi_nccl_rdma_multi_recv_msgs();
+
+	ep->multi_recv_msgs = 0;
+
+	if (multi_recv_msgs == 0) {
+		return 0;
+	}
+
+	if (!(rdma_device_get_rail(device, 0)->info->caps & FI_MULTI_RECV)) {
+		NCCL_OFI_INFO(NCCL_NET, "FI_MULTI_RECV not supported by provider. Posting one message per rx buffer");
+		return 0;
+	}
+
+	/* A slab is released once it cannot hold the largest message
+	 * received on the rail anymore */
+	for (uint16_t rail_id = 0; rail_id < ep->num_control_rails; ++rail_id) {
+		nccl_net_ofi_ep_rail_t *rail = rdma_endpoint_get_control_rail(ep, rail_id);
+		size_t min_free = ep->ctrl_rx_buff_size;
+
+		ret = fi_setopt(&rail->ofi_ep->fid, FI_OPT_ENDPOINT, FI_OPT_MIN_MULTI_RECV,
+				&min_free, sizeof(min_free));
+		if (ret != 0) {
+			goto error;
+		}
+	}
+
+	for (uint16_t rail_id = 0; ep->eager_rx_buff_size > 0 && rail_id < ep->num_rails; ++rail_id) {
+		nccl_net_ofi_ep_rail_t *rail = rdma_endpoint_get_rail(ep, rail_id);
+		size_t min_free = ep->eager_rx_buff_size;
+
+		ret = fi_setopt(&rail->ofi_ep->fid, FI_OPT_ENDPOINT, FI_OPT_MIN_MULTI_RECV,
+				&min_free, sizeof(min_free));
+		if (ret != 0) {
+			goto error;
+		}
+	}
+
+	ep->multi_recv_msgs = multi_recv_msgs;
+
+	return 0;
+
+error:
+	if (ret == -FI_ENOPROTOOPT || ret == -FI_ENOSYS) {
+		NCCL_OFI_INFO(NCCL_NET, "Unable to set minimum multi-recv buffer space. Posting one message per rx buffer");
+		return 0;
+	}
+
+	NCCL_OFI_WARN("Failed to set FI_OPT_MIN_MULTI_RECV. RC: %d, ERROR: %s",
+		      ret, fi_strerror(-ret));
+	return ret;
+}
+
+/*
+ * @brief	Initialize rx buffer and rx_buff request freelists of endpoint
+ */
+static int init_rx_buff_freelists(nccl_net_ofi_rdma_ep_t *ep)
+{
+	int ret = 0;
+	nccl_net_ofi_rdma_domain_t *domain = rdma_endpoint_get_domain(ep);
+
+	/* This is a little bit of a heuristic, but we need as many requests as
+	   we have posted control messages, so that's as reasonable a starting
+	   point as any. */
+	ret = nccl_ofi_freelist_init(nccl_net_ofi_rdma_req_size(ep->num_rails),
+				     ofi_nccl_rdma_min_posted_control_buffers(), 16, 0,
+				     rdma_fl_req_entry_init_fn(ep->num_rails), NULL,
+				     &ep->rx_buff_reqs_fl);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Failed to init rx_buff_reqs_fl");
+		return ret;
+	}
+
+	ret = nccl_ofi_freelist_init_mr(rdma_ep_rx_buff_alloc_size(ep, ep->ctrl_rx_buff_size),
+					rdma_ep_rx_buff_count(ep, ofi_nccl_rdma_min_posted_control_buffers()),
+					16, 0,
+					NULL, NULL,
+					freelist_regmr_host_fn, freelist_deregmr_host_fn,
+					domain, 1, &ep->ctrl_rx_buff_fl);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Failed to init ctrl_rx_buff_fl");
+		if (nccl_ofi_freelist_fini(ep->rx_buff_reqs_fl))
+			NCCL_OFI_WARN("Also failed to freelist_fini rx_buff_reqs_fl");
+		ep->rx_buff_reqs_fl = NULL;
+		return ret;
+	}
+
+	if (ep->eager_rx_buff_size > 0) {
+		ret = nccl_ofi_freelist_init_mr(rdma_ep_rx_buff_alloc_size(ep, ep->eager_rx_buff_size),
+						rdma_ep_rx_buff_count(ep, ofi_nccl_rdma_min_posted_eager_buffers()),
+						16, 0,
+						NULL, NULL,
+						freelist_regmr_host_fn, freelist_deregmr_host_fn,
+						domain, EAGER_RX_BUFFER_ALIGNMENT, &ep->eager_rx_buff_fl);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Failed to init eager_rx_buff_size");
+			nccl_ofi_freelist_fini(ep->ctrl_rx_buff_fl);
+			nccl_ofi_freelist_fini(ep->rx_buff_reqs_fl);
+			ep->ctrl_rx_buff_fl = NULL;
+			ep->rx_buff_reqs_fl = NULL;
+			return ret;
+		}
+	} else {
+		ep->eager_rx_buff_fl = NULL;
+	}
+
+	return ret;
+}
+
+/*
+ * @brief	Finalize rx buffer and rx_buff request freelists of endpoint
+ */
+static int fini_rx_buff_freelists(nccl_net_ofi_rdma_ep_t *ep)
+{
+	int ret = 0;
+
+	if (ep->ctrl_rx_buff_fl != NULL) {
+		ret = nccl_ofi_freelist_fini(ep->ctrl_rx_buff_fl);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Failed to fini ctrl_rx_buff_fl");
+			return ret;
+		}
+		ep->ctrl_rx_buff_fl = NULL;
+	}
+
+	if (ep->eager_rx_buff_fl != NULL) {
+		ret = nccl_ofi_freelist_fini(ep->eager_rx_buff_fl);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Failed to fini eager_rx_buff_fl");
+			return ret;
+		}
+		ep->eager_rx_buff_fl = NULL;
+	}
+
+	if (ep->rx_buff_reqs_fl != NULL) {
+		ret = nccl_ofi_freelist_fini(ep->rx_buff_reqs_fl);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Failed to fini rx_buff_reqs_fl");
+			return ret;
+		}
+		ep->rx_buff_reqs_fl = NULL;
+	}
+
+	return ret;
+}
 
-	/* Set number of rails to be sent back to remote for verification */
-	conn_msg->num_rails = num_rails;
-	conn_msg->num_control_rails = num_control_rails;
+/*
+ * @brief	Return the number of endpoints whose rx buffers endpoint
+ *		`ep' posts
+ *
+ * Endpoints using the shared rx endpoint of their domain post none.
+ * The shared rx endpoint posts the rx buffers of every endpoint
+ * sharing it, for at least one and at most RDMA_SHARED_RX_MAX_EPS
+ * endpoints.
+ */
+static inline size_t rdma_ep_rx_buff_num_eps(nccl_net_ofi_rdma_ep_t *ep)
+{
+	nccl_net_ofi_rdma_domain_t *domain = rdma_endpoint_get_domain(ep);
 
-	/* Set libfabric endpoint names for each control rail */
-	for (uint16_t rail_id = 0; rail_id != num_control_rails; ++rail_id) {
-		memcpy(conn_msg->control_ep_names[rail_id].ep_name,
-		       ep->control_rails[rail_id].local_ep_name,
-		       ep->control_rails[rail_id].local_ep_name_len);
-		conn_msg->control_ep_names[rail_id].ep_name_len =
-			ep->control_rails[rail_id].local_ep_name_len;
+	if (rdma_ep_uses_shared_rx(ep)) {
+		return 0;
+	} else if (domain->shared_rx_ep != ep) {
+		return 1;
 	}
 
-	/* Set libfabric endpoint names for each rail */
-	for (uint16_t rail_id = 0; rail_id != num_rails; ++rail_id) {
-		memcpy(conn_msg->ep_names[rail_id].ep_name,
-		       ep->rails[rail_id].local_ep_name,
-		       ep->rails[rail_id].local_ep_name_len);
-		conn_msg->ep_names[rail_id].ep_name_len =
-			ep->rails[rail_id].local_ep_name_len;
-	}
+	size_t num_eps = __atomic_load_n(&domain->num_shared_rx_eps, __ATOMIC_RELAXED);
+	return std::min(std::max(num_eps, (size_t)1),
+			std::max((size_t)ofi_nccl_rdma_shared_rx_max_eps(), (size_t)1));
 }
 
 /*
- * @brief	Allocate a RDMA send communicator with `num_rails' rails using `calloc()'
+ * @brief	Set the bounds of the number of rx buffers posted to
+ *		control (`is_control') or data rail `rail' of endpoint `ep'
  *
- * @param	num_rails
- *		The number of rails of the allocated send communicator
- * @param	num_control_rails
- *		The number of control rails of the allocated send communicator
- * @return	communicator, on success
- *		NULL, on error
+ * The *_rx_buff_posted limits are used in the progress engine to
+ * determine if the receive queue is hydrated with sufficient buffers.
+ * The parameters account for all the rails of an endpoint, so bounds
+ * are scaled down to what a single rail would need, and scaled up by
+ * the number of endpoints the rail posts rx buffers for.
  */
-static inline nccl_net_ofi_rdma_send_comm_t *calloc_rdma_send_comm(int num_rails, int num_control_rails)
+static void rdma_ep_rail_set_rx_buff_bounds(nccl_net_ofi_rdma_ep_t *ep,
+					    nccl_net_ofi_ep_rail_t *rail, bool is_control)
 {
-	nccl_net_ofi_rdma_send_comm_t *s_comm = (nccl_net_ofi_rdma_send_comm_t *)calloc(1, sizeof(nccl_net_ofi_rdma_send_comm_t));
-	if (OFI_UNLIKELY(!s_comm)) {
-		NCCL_OFI_WARN("Unable to allocate send communicator");
-        goto error;
-    }
+	size_t num_eps = rdma_ep_rx_buff_num_eps(ep);
 
-	s_comm->rails = (nccl_net_ofi_rdma_send_comm_rail_t *)calloc(num_rails, sizeof(nccl_net_ofi_rdma_send_comm_rail_t));
-    if (OFI_UNLIKELY(!s_comm->rails)) {
-        NCCL_OFI_WARN("Unable to allocate send communicator rails array");
-        goto error;
-    }
+	if (is_control) {
+		rail->min_rx_buff_posted = num_eps * rdma_ep_rx_buff_count(ep, NCCL_OFI_DIV_CEIL(
+			ofi_nccl_rdma_min_posted_control_buffers(), ep->num_control_rails
+		));
+		rail->max_rx_buff_posted = num_eps * rdma_ep_rx_buff_count(ep, NCCL_OFI_DIV_CEIL(
+			ofi_nccl_rdma_max_posted_control_buffers(), ep->num_control_rails
+		));
+	} else if (ep->eager_rx_buff_size >= 0) {
+		rail->min_rx_buff_posted = num_eps * rdma_ep_rx_buff_count(ep, NCCL_OFI_DIV_CEIL(
+			ofi_nccl_rdma_min_posted_eager_buffers(), ep->num_rails
+		));
+		rail->max_rx_buff_posted = num_eps * rdma_ep_rx_buff_count(ep, NCCL_OFI_DIV_CEIL(
+			ofi_nccl_rdma_max_posted_eager_buffers(), ep->num_rails
+		));
+	} else {
+		rail->min_rx_buff_posted = 0;
+		rail->max_rx_buff_posted = 0;
+	}
+}
 
-	s_comm->control_rails = (nccl_net_ofi_rdma_send_comm_rail_t *)calloc(num_control_rails, sizeof(nccl_net_ofi_rdma_send_comm_rail_t));
-    if (OFI_UNLIKELY(!s_comm->control_rails)) {
-        NCCL_OFI_WARN("Unable to allocate send communicator control rails array");
-        goto error;
-    }
+/*
+ * @brief	Resize the rx buffer pool of shared rx endpoint `ep' after
+ *		an endpoint started or stopped sharing it
+ *
+ * Missing rx buffers are posted right away. Rx buffers beyond a
+ * lowered target are freed as they are filled if
+ * RDMA_RX_BUFF_AUTOTUNE is enabled, and stay posted otherwise.
+ *
+ * @return	0, on success
+ *		non-zero, on error
+ */
+static int rdma_shared_rx_ep_resize(nccl_net_ofi_rdma_ep_t *ep)
+{
+	int ret = 0;
 
-    return s_comm;
+	for (uint16_t i = 0; i < ep->num_control_rails + ep->num_rails; ++i) {
+		bool is_control = (i < ep->num_control_rails);
+		nccl_net_ofi_ep_rail_t *rail = is_control ?
+			rdma_endpoint_get_control_rail(ep, i) :
+			rdma_endpoint_get_rail(ep, i - ep->num_control_rails);
+
+		/* The bounds are computed under the lock, so that the
+		 * last resize of a rail uses the latest number of
+		 * sharing endpoints */
+		nccl_net_ofi_mutex_lock(&rail->rx_buff_mutex);
+		rdma_ep_rail_set_rx_buff_bounds(ep, rail, is_control);
+		if (ofi_nccl_rdma_rx_buff_autotune() != 0) {
+			rdma_rail_set_rx_buff_target(rail, rail->target_rx_buff_posted);
+		} else {
+			rail->target_rx_buff_posted = rail->max_rx_buff_posted;
+		}
+		nccl_net_ofi_mutex_unlock(&rail->rx_buff_mutex);
 
-error:
+		ret = post_rx_buffs_on_rail(ep, rail);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Failed to post shared rx buffers: %d", ret);
+			return ret;
+		}
+	}
 
-    free_rdma_send_comm(s_comm);
-    return NULL;
+	return ret;
 }
 
 /*
  * @brief	Initialize rx buffer data of endpoint
  *
+ * Endpoints using the shared rx endpoint of their domain do not
+ * allocate or post rx buffers of their own.
+ *
  * @param	ep
  *		Endpoint with rx buffer and rx_buff requests not being
  *		initialized yet.
@@ -6279,98 +9052,76 @@ static inline int init_rx_buffers(nccl_net_ofi_rdma_ep_t *ep)
 	int ret = 0;
 	nccl_net_ofi_ep_rail_t *rail;
 	nccl_net_ofi_rdma_domain_t *domain = rdma_endpoint_get_domain(ep);
+	bool shared_rx = rdma_ep_uses_shared_rx(ep);
 
-	/* This is a little bit of a heuristic, but we need as many requests as
-	   we have posted control messages, so that's as reasonable a starting
-	   point as any. */
-	ret = nccl_ofi_freelist_init(sizeof(nccl_net_ofi_rdma_req_t),
-				     ofi_nccl_rdma_min_posted_control_buffers(), 16, 0,
-				     rdma_fl_req_entry_init, rdma_fl_req_entry_fini,
-				     &ep->rx_buff_reqs_fl);
-	if (ret != 0) {
-		NCCL_OFI_WARN("Failed to init rx_buff_reqs_fl");
-		return ret;
-	}
-
-	ret = nccl_ofi_freelist_init_mr(ep->ctrl_rx_buff_size,
-					ofi_nccl_rdma_min_posted_control_buffers(), 16, 0,
-					NULL, NULL,
-					freelist_regmr_host_fn, freelist_deregmr_host_fn,
-					domain, 1, &ep->ctrl_rx_buff_fl);
-	if (ret != 0) {
-		NCCL_OFI_WARN("Failed to init ctrl_rx_buff_fl");
-		if (nccl_ofi_freelist_fini(ep->rx_buff_reqs_fl))
-			NCCL_OFI_WARN("Also failed to freelist_fini rx_buff_reqs_fl");
-		return ret;
-	}
+	if (!shared_rx) {
+		ret = rdma_ep_init_multi_recv(ep);
+		if (ret != 0) {
+			return ret;
+		}
 
-	if (ep->eager_rx_buff_size > 0) {
-		ret = nccl_ofi_freelist_init_mr(ep->eager_rx_buff_size,
-						ofi_nccl_rdma_min_posted_eager_buffers(), 16, 0,
-						NULL, NULL,
-						freelist_regmr_host_fn, freelist_deregmr_host_fn,
-						domain, EAGER_RX_BUFFER_ALIGNMENT, &ep->eager_rx_buff_fl);
+		ret = init_rx_buff_freelists(ep);
 		if (ret != 0) {
-			NCCL_OFI_WARN("Failed to init eager_rx_buff_size");
-			nccl_ofi_freelist_fini(ep->ctrl_rx_buff_fl);
-			nccl_ofi_freelist_fini(ep->rx_buff_reqs_fl);
 			return ret;
 		}
-	} else {
-		ep->eager_rx_buff_fl = NULL;
 	}
 
-        ret = nccl_ofi_freelist_init_mr(sizeof(nccl_ofi_rdma_connection_info_t),
+        ret = nccl_ofi_freelist_init_mr(NCCL_OFI_RDMA_CONNECTION_INFO_MAX_SIZE,
 					4, 4, 0, NULL, NULL,
 					freelist_regmr_host_fn, freelist_deregmr_host_fn,
 					domain, sizeof(void *), &ep->conn_msg_fl);
 	if (ret != 0) {
 		NCCL_OFI_WARN("Failed to init conn_msg freelist");
-		if (ep->eager_rx_buff_fl != NULL) {
-			nccl_ofi_freelist_fini(ep->eager_rx_buff_fl);
-		}
-		nccl_ofi_freelist_fini(ep->ctrl_rx_buff_fl);
-		nccl_ofi_freelist_fini(ep->rx_buff_reqs_fl);
+		fini_rx_buff_freelists(ep);
+		return ret;
+	}
+
+	/* Room for RDMA_EP_MAX_COMMS communicators holding their
+	   maximum number of requests */
+	size_t max_comm_reqs = std::max((size_t)4 * NCCL_OFI_MAX_REQUESTS,
+					(size_t)NCCL_OFI_MAX_SEND_REQUESTS);
+	ret = nccl_ofi_freelist_init(nccl_net_ofi_rdma_req_size(ep->num_rails), 16, 16,
+				     ofi_nccl_rdma_ep_max_comms() * max_comm_reqs,
+				     rdma_fl_req_entry_init_fn(ep->num_rails), NULL,
+				     &ep->comm_reqs_fl);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Failed to init comm_reqs_fl");
+		nccl_ofi_freelist_fini(ep->conn_msg_fl);
+		ep->conn_msg_fl = NULL;
+		fini_rx_buff_freelists(ep);
 		return ret;
 	}
 
-	/*
-	 * The *_rx_buff_posted limits are used in the progress engine to
-	 * determine if the receive queue is hydrated with sufficient buffers.
-	 * The parameters account for all the rails, so scale down bounds to
-	 * what a single rail would need.
-	 */
 	for (uint16_t rail_id = 0; rail_id < ep->num_control_rails; ++rail_id) {
 		rail = rdma_endpoint_get_control_rail(ep, rail_id);
-		rail->min_rx_buff_posted = NCCL_OFI_DIV_CEIL(
-			ofi_nccl_rdma_min_posted_control_buffers(), ep->num_control_rails
-		);
-		rail->max_rx_buff_posted = NCCL_OFI_DIV_CEIL(
-			ofi_nccl_rdma_max_posted_control_buffers(), ep->num_control_rails
-		);
+		rdma_ep_rail_set_rx_buff_bounds(ep, rail, true);
 		rail->num_rx_buff_posted = 0;
+		rail->rx_buff_size = rdma_ep_rx_buff_alloc_size(ep, ep->ctrl_rx_buff_size);
+		rdma_rail_init_rx_buff_target(rail);
 		nccl_net_ofi_mutex_init(&rail->rx_buff_mutex, NULL);
 		rail->rx_buff_req_alloc = ctrl_rx_buff_req_alloc;
 	}
 
 	for (uint16_t rail_id = 0; rail_id < ep->num_rails; ++rail_id) {
 		rail = rdma_endpoint_get_rail(ep, rail_id);
-		if (ep->eager_rx_buff_size >= 0) {
-			rail->min_rx_buff_posted = NCCL_OFI_DIV_CEIL(
-				ofi_nccl_rdma_min_posted_eager_buffers(), ep->num_rails
-				);
-			rail->max_rx_buff_posted = NCCL_OFI_DIV_CEIL(
-				ofi_nccl_rdma_max_posted_eager_buffers(), ep->num_rails
-				);
-		} else {
-			rail->min_rx_buff_posted = 0;
-			rail->max_rx_buff_posted = 0;
-		}
+		rdma_ep_rail_set_rx_buff_bounds(ep, rail, false);
 		rail->num_rx_buff_posted = 0;
+		rail->rx_buff_size = (ep->eager_rx_buff_size > 0) ?
+			rdma_ep_rx_buff_alloc_size(ep, ep->eager_rx_buff_size) : 0;
+		rdma_rail_init_rx_buff_target(rail);
 		nccl_net_ofi_mutex_init(&rail->rx_buff_mutex, NULL);
 		rail->rx_buff_req_alloc = eager_rx_buff_req_alloc;
 	}
 
+	if (shared_rx) {
+		/* Grow the shared pool by the demand of this endpoint */
+		__atomic_fetch_add(&domain->num_shared_rx_eps, 1, __ATOMIC_RELAXED);
+		ret = rdma_shared_rx_ep_resize(domain->shared_rx_ep);
+		if (ret != 0) {
+			__atomic_fetch_sub(&domain->num_shared_rx_eps, 1, __ATOMIC_RELAXED);
+		}
+	}
+
 	return ret;
 }
 
@@ -6387,24 +9138,19 @@ static inline int fini_rx_buffers(nccl_net_ofi_rdma_ep_t *ep)
 {
 	int ret = 0;
 	nccl_net_ofi_ep_rail_t *rail;
+	nccl_net_ofi_rdma_domain_t *domain = rdma_endpoint_get_domain(ep);
 
-	ret = nccl_ofi_freelist_fini(ep->ctrl_rx_buff_fl);
-	if (ret != 0) {
-		NCCL_OFI_WARN("Failed to fini ctrl_rx_buff_fl");
-		return ret;
-	}
-
-	if (ep->eager_rx_buff_fl != NULL) {
-		ret = nccl_ofi_freelist_fini(ep->eager_rx_buff_fl);
+	if (rdma_ep_uses_shared_rx(ep)) {
+		__atomic_fetch_sub(&domain->num_shared_rx_eps, 1, __ATOMIC_RELAXED);
+		ret = rdma_shared_rx_ep_resize(domain->shared_rx_ep);
 		if (ret != 0) {
-			NCCL_OFI_WARN("Failed to fini eager_rx_buff_fl");
+			NCCL_OFI_WARN("Failed to shrink the shared rx buffer pool");
 			return ret;
 		}
 	}
 
-	ret = nccl_ofi_freelist_fini(ep->rx_buff_reqs_fl);
+	ret = fini_rx_buff_freelists(ep);
 	if (ret != 0) {
-		NCCL_OFI_WARN("Failed to fini rx_buff_reqs_fl");
 		return ret;
 	}
 
@@ -6414,13 +9160,21 @@ static inline int fini_rx_buffers(nccl_net_ofi_rdma_ep_t *ep)
 		return ret;
 	}
 
+	ret = nccl_ofi_freelist_fini(ep->comm_reqs_fl);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Failed to fini comm_reqs_fl");
+		return ret;
+	}
+
 	for (uint16_t rail_id = 0; rail_id < ep->num_rails; ++rail_id) {
 		rail = rdma_endpoint_get_rail(ep, rail_id);
+		rdma_rail_fini_rx_buff_target(rail);
 		nccl_net_ofi_mutex_destroy(&rail->rx_buff_mutex);
 	}
 
 	for (uint16_t rail_id = 0; rail_id < ep->num_control_rails; ++rail_id) {
 		rail = rdma_endpoint_get_control_rail(ep, rail_id);
+		rdma_rail_fini_rx_buff_target(rail);
 		nccl_net_ofi_mutex_destroy(&rail->rx_buff_mutex);
 	}
 
@@ -6433,7 +9187,7 @@ static int get_mr_key(nccl_net_ofi_device_t *base_dev, void *mhandle,
 	int ret = 0;
 	nccl_net_ofi_rdma_mr_handle_t *mr_handle = (nccl_net_ofi_rdma_mr_handle_t *)mhandle;
 
-	uint64_t key = fi_mr_key(mr_handle->mr[0]);
+	uint64_t key = rdma_mr_handle_get_rkey(mr_handle, 0);
 	if (OFI_UNLIKELY(key == FI_KEY_NOTAVAIL)) {
 		ret = -ENOENT;
 		NCCL_OFI_WARN("Error retrieving MR key, leaking key");
@@ -6493,12 +9247,10 @@ static int rma_write_impl(nccl_net_ofi_send_comm_t *send_comm, void* src, size_t
 
 	/* Try posting RMA write with write_inline interface */
 
-	ret = send_progress(req);
+	ret = send_progress(req, false);
 	if (ret == -FI_EAGAIN) {
 		/* Add to pending reqs queue */
-		nccl_net_ofi_mutex_lock(&ep->pending_reqs_lock);
-		ep->pending_reqs_queue->push_back(req);
-		nccl_net_ofi_mutex_unlock(&ep->pending_reqs_lock);
+		rdma_ep_add_pending_req(ep, req);
 		ret = 0;
 		NCCL_OFI_TRACE_PENDING_INSERT(req);
 	} else if (OFI_UNLIKELY(ret != 0)) {
@@ -6528,8 +9280,7 @@ static int rma_write(nccl_net_ofi_send_comm_t *send_comm, void* src, size_t size
 		     uint64_t dest, uint64_t mr_key, nccl_net_ofi_req_t ** base_req)
 {
 	nccl_net_ofi_rdma_mr_handle_t *mr_handle = (nccl_net_ofi_rdma_mr_handle_t *)mhandle;
-	struct fid_mr *rail_mr_handle = mr_handle->mr[0];
-	void *desc = fi_mr_desc(rail_mr_handle);
+	void *desc = mr_handle->desc[0];
 	uint64_t flags = 0;
 	return rma_write_impl(send_comm, src, size, desc, dest, mr_key, flags, base_req);
 }
@@ -6577,7 +9328,6 @@ static inline int create_send_comm(nccl_net_ofi_conn_handle_t *handle,
 	nccl_net_ofi_rdma_send_comm_t *ret_s_comm = NULL;
 	int num_rails = ep->num_rails;
 	int num_control_rails = ep->num_control_rails;
-	uint16_t rail_id = 0;
 	nccl_net_ofi_ep_rail_t *first_control_rail = rdma_endpoint_get_control_rail(ep, 0);
 	nccl_net_ofi_rdma_send_comm_rail_t *first_comm_control_rail;
 
@@ -6621,14 +9371,16 @@ static inline int create_send_comm(nccl_net_ofi_conn_handle_t *handle,
 	ret_s_comm->n_ctrl_received = 0;
 	ret_s_comm->n_ctrl_expected = 0;
 
-	/* Store communicator ID from handle in communicator */
-	if (OFI_UNLIKELY(handle->comm_id >= device->num_comm_ids)) {
+	/* Store communicator ID from handle in communicator. The
+	   protocol version of the peer is not known yet. */
+	if (OFI_UNLIKELY(handle->comm_id >= NCCL_OFI_RDMA_MAX_REMOTE_COMMS)) {
 		NCCL_OFI_WARN("Received an invalid communicator ID %" PRIu32 " for device %d", handle->comm_id,
 			      dev_id);
 		ret = -EINVAL;
 		goto error;
 	}
 	ret_s_comm->remote_comm_id = handle->comm_id;
+	ret_s_comm->max_num_segms = NCCL_OFI_RDMA_MAX_NUM_SEGMS_V1;
 
 	/* Allocate send communicator ID */
 	comm_id = device->comm_idpool->allocate_id();
@@ -6640,20 +9392,19 @@ static inline int create_send_comm(nccl_net_ofi_conn_handle_t *handle,
 	ret_s_comm->local_comm_id = (uint32_t)comm_id;
 
 	/* Add ourselves to ep's lookup array */
-	rdma_device_set_comm(device, ret_s_comm->local_comm_id, &ret_s_comm->base.base);
+	ret = rdma_device_set_comm(device, ret_s_comm->local_comm_id, &ret_s_comm->base.base);
+	if (OFI_UNLIKELY(ret != 0)) {
+		goto error;
+	}
 
 	/* Allocate communicator rails array */
 	ret_s_comm->num_rails = num_rails;
 	ret_s_comm->num_control_rails = num_control_rails;
 
-	/* Insert remote name into AV of first rail */
-	ret = fi_av_insert(first_control_rail->av,
-			   (void *)handle->ep_name, 1,
-			   &remote_addr, 0, NULL);
-	if (OFI_UNLIKELY(ret != 1)) {
-		NCCL_OFI_WARN("Unable to insert remote address into address vector for device %d. RC: %d",
-			      dev_id, ret);
-		ret = -EINVAL;
+	/* Resolve remote name in AV of first rail */
+	ret = rdma_ep_rail_av_insert(first_control_rail, handle->ep_name, 1,
+				     &remote_addr, dev_id);
+	if (OFI_UNLIKELY(ret != 0)) {
 		goto error;
 	}
 
@@ -6665,16 +9416,10 @@ static inline int create_send_comm(nccl_net_ofi_conn_handle_t *handle,
 	first_comm_control_rail->local_ep = first_control_rail->ofi_ep;
 	ret_s_comm->num_init_control_rails = 1;
 
-	/* Allocate request free list */
-	ret = nccl_ofi_freelist_init(sizeof(nccl_net_ofi_rdma_req_t), 16, 16,
-				     NCCL_OFI_MAX_SEND_REQUESTS,
-				     rdma_fl_req_entry_init, rdma_fl_req_entry_fini,
-				     &ret_s_comm->nccl_ofi_reqs_fl);
-	if (OFI_UNLIKELY(ret != 0)) {
-		NCCL_OFI_WARN("Could not allocate NCCL OFI request free list for dev %d rail %d",
-			      dev_id, rail_id);
-		goto error;
-	}
+	/* Draw requests from the endpoint request freelist */
+	ret_s_comm->reqs.fl = ep->comm_reqs_fl;
+	ret_s_comm->reqs.num_allocated = 0;
+	ret_s_comm->reqs.max_allocated = NCCL_OFI_MAX_SEND_REQUESTS;
 
 	/* Allocate connect message, will be returned after send completion */
 	ret_s_comm->conn_msg = nccl_ofi_freelist_entry_alloc(ep->conn_msg_fl);
@@ -6731,7 +9476,7 @@ static inline nccl_net_ofi_rdma_req_t *prepare_send_conn_req(nccl_net_ofi_rdma_s
 {
 	nccl_net_ofi_rdma_req_t *req = NULL;
 
-	req = allocate_req(s_comm->nccl_ofi_reqs_fl);
+	req = allocate_comm_req(&s_comm->reqs);
 	if (OFI_UNLIKELY(req == NULL)) {
 		NCCL_OFI_WARN("Unable to get NCCL OFI request for device %d",
 			      s_comm->base.base.dev_id);
@@ -6758,7 +9503,7 @@ static inline nccl_net_ofi_rdma_req_t *prepare_recv_conn_resp_req(nccl_net_ofi_r
 {
 	nccl_net_ofi_rdma_req_t *req = NULL;
 
-	req = allocate_req(s_comm->nccl_ofi_reqs_fl);
+	req = allocate_comm_req(&s_comm->reqs);
 	if (OFI_UNLIKELY(req == NULL)) {
 		NCCL_OFI_WARN("Unable to get NCCL OFI request for device %d",
 			      s_comm->base.base.dev_id);
@@ -6793,14 +9538,15 @@ static int post_send_conn(nccl_net_ofi_rdma_send_comm_t *s_comm,
 	uint16_t rail_id = 0;
 	nccl_net_ofi_rdma_send_comm_rail_t *comm_rail = rdma_send_comm_get_control_rail(s_comm, rail_id);
 	freelist_regmr_fn_handle_t *fl_mr_handle = (freelist_regmr_fn_handle_t *)s_comm->conn_msg->mr_handle;
-	void *desc = fi_mr_desc(fl_mr_handle->mr_handle->mr[rail_id]);
+	void *desc = fl_mr_handle->mr_handle->desc[rail_id];
 
 	/*
 	 * TODO: replace it with API of FI_INJECT type when most of
 	 * providers can support it, so that need for completion check
 	 * can be lifted.
 	 */
-	rc = fi_send(comm_rail->local_ep, (void *)s_comm->conn_msg->ptr, sizeof(nccl_ofi_rdma_connection_info_t), desc,
+	rc = fi_send(comm_rail->local_ep, (void *)s_comm->conn_msg->ptr,
+		     nccl_ofi_rdma_connection_info_size((nccl_ofi_rdma_connection_info_t *)s_comm->conn_msg->ptr), desc,
 		     comm_rail->remote_addr, rdma_req_get_ofi_context(req, rail_id));
 
 	if (rc == -FI_EAGAIN) {
@@ -6808,12 +9554,14 @@ static int post_send_conn(nccl_net_ofi_rdma_send_comm_t *s_comm,
 		 * Process completions so that you have enough
 		 * resources for sending connect message
 		 */
-		int res = ofi_process_cq(ep);
+		int res = rdma_ep_progress(ep);
 		if (res != 0)
 			rc = -2;
 	} else if (rc != 0) {
 		NCCL_OFI_WARN("Unable to send connect message for dev %d. RC: %zd, ERROR: %s",
 			      device->base.dev_id, rc, fi_strerror(-rc));
+	} else {
+		rdma_ep_mark_rail_active(ep, rail_id);
 	}
 
 	return rc;
@@ -6931,7 +9679,7 @@ static int connect(nccl_net_ofi_ep_t *base_ep,
 		 * request. */
 
 		/* Progress our engine to get completions */
-		ret = ofi_process_cq(ep);
+		ret = rdma_ep_progress(ep);
 		if (OFI_UNLIKELY(ret != 0)) {
 			/* Send communicator cannot be closed since
 			 * send request of send connect message is
@@ -6940,9 +9688,7 @@ static int connect(nccl_net_ofi_ep_t *base_ep,
 		}
 
 		/* Check if the connect message is sent */
-		nccl_net_ofi_mutex_lock(&req->req_lock);
-		conn_msg_state = req->state;
-		nccl_net_ofi_mutex_unlock(&req->req_lock);
+		conn_msg_state = rdma_req_get_state(req);
 
 		/* Wait until connect message is sent */
 		if (conn_msg_state != NCCL_OFI_RDMA_REQ_COMPLETED) {
@@ -6968,14 +9714,12 @@ static int connect(nccl_net_ofi_ep_t *base_ep,
 		/* Progress our engine to get completions. If the
 		 * connect response message has arrived, the
 		 * connection establishment will be finalized. */
-		ret = ofi_process_cq(ep);
+		ret = rdma_ep_progress(ep);
 		if (OFI_UNLIKELY(ret != 0)) {
 			return ret;
 		}
 
-		nccl_net_ofi_mutex_lock(&s_comm->conn_resp_req->req_lock);
-		conn_resp_req_state = s_comm->conn_resp_req->state;
-		nccl_net_ofi_mutex_unlock(&s_comm->conn_resp_req->req_lock);
+		conn_resp_req_state = rdma_req_get_state(s_comm->conn_resp_req);
 
 		/* Wait until conn resp message is received */
 		if (conn_resp_req_state != NCCL_OFI_RDMA_REQ_COMPLETED) {
@@ -7013,6 +9757,46 @@ static void ep_rail_release(nccl_net_ofi_ep_rail_t *rail, int dev_id)
 				     dev_id);
 	rail->ofi_ep = NULL;
 	rail->av = NULL;
+
+	/* Cached addresses go away with the address vector */
+	if (rail->av_cache != NULL) {
+		delete rail->av_cache;
+		rail->av_cache = NULL;
+		nccl_net_ofi_mutex_destroy(&rail->av_cache_lock);
+	}
+}
+
+
+/*
+ * @brief	Initialize pending requests queue of endpoint rail
+ */
+static int ep_rail_init_pending_reqs(nccl_net_ofi_ep_rail_t *rail)
+{
+	int ret = nccl_net_ofi_mutex_init(&rail->pending_reqs_lock, NULL);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Mutex initialization failed: %s", strerror(ret));
+		return -ret;
+	}
+
+	rail->pending_reqs_queue = new std::deque<nccl_net_ofi_rdma_req_t *>;
+
+	return 0;
+}
+
+
+/*
+ * @brief	Finalize pending requests queue of endpoint rail
+ */
+static int ep_rail_fini_pending_reqs(nccl_net_ofi_ep_rail_t *rail)
+{
+	if (rail->pending_reqs_queue == NULL) {
+		return 0;
+	}
+
+	delete rail->pending_reqs_queue;
+	rail->pending_reqs_queue = NULL;
+
+	return nccl_net_ofi_mutex_destroy(&rail->pending_reqs_lock);
 }
 
 
@@ -7023,12 +9807,12 @@ static void release_rdma_ep_resources(nccl_net_ofi_rdma_ep_t *ep, int dev_id)
 {
 	nccl_net_ofi_ep_rail_t *rail;
 
-	for (uint16_t rail_id = 0; rail_id != ep->num_control_rails; ++rail_id) {
+	for (uint16_t rail_id = 0; ep->control_rails != NULL && rail_id != ep->num_control_rails; ++rail_id) {
 		rail = rdma_endpoint_get_control_rail(ep, rail_id);
 		ep_rail_release(rail, dev_id);
 	}
 
-	for (uint16_t rail_id = 0; rail_id != ep->num_rails; ++rail_id) {
+	for (uint16_t rail_id = 0; ep->rails != NULL && rail_id != ep->num_rails; ++rail_id) {
 		rail = rdma_endpoint_get_rail(ep, rail_id);
 		ep_rail_release(rail, dev_id);
 	}
@@ -7072,33 +9856,49 @@ static int ep_rail_init(nccl_net_ofi_rdma_ep_t *ep,
 			nccl_net_ofi_rdma_device_rail_t *dev_rail,
 			nccl_net_ofi_rdma_domain_rail_t *domain_rail,
 			nccl_net_ofi_ep_rail_t *ep_rail,
-			uint32_t tclass)
+			uint32_t tclass,
+			struct fid_ep *srx)
 {
 	int ret = 0;
 	struct fi_info *rail_info = dev_rail->info;
+	bool dup_info = (tclass != FI_TC_UNSPEC || srx != NULL);
 
-	if (tclass != FI_TC_UNSPEC) {
+	if (dup_info) {
 		rail_info = fi_dupinfo(rail_info);
 		if (rail_info == NULL) {
 			NCCL_OFI_WARN("Could not allocate new fi_info struct");
 			return -ENOMEM;
 		}
 
-		rail_info->tx_attr->tclass = tclass;
+		if (tclass != FI_TC_UNSPEC) {
+			rail_info->tx_attr->tclass = tclass;
+		}
+		if (srx != NULL) {
+			rail_info->ep_attr->rx_ctx_cnt = FI_SHARED_CONTEXT;
+		}
 	}
 
 	ret = nccl_ofi_ofiutils_init_connection(rail_info,
 						domain_rail->domain,
 						&ep_rail->ofi_ep,
 						&ep_rail->av,
-						domain_rail->cq);
-	if (tclass != FI_TC_UNSPEC) {
+						domain_rail->cq,
+						srx);
+	if (dup_info) {
 		fi_freeinfo(rail_info);
 	}
 	if (ret != 0) {
 		return ret;
 	}
 
+	ret = nccl_net_ofi_mutex_init(&ep_rail->av_cache_lock, NULL);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Mutex initialization failed: %s", strerror(ret));
+		ep_rail_release(ep_rail, dev_id);
+		return -ret;
+	}
+	ep_rail->av_cache = new std::unordered_map<std::string, fi_addr_t>;
+
 	ep_rail->rail_id = rail_id;
 
 	ret = set_local_address(ep_rail->ofi_ep, ep_rail);
@@ -7125,14 +9925,19 @@ static int init_rail_ofi_resources(nccl_net_ofi_rdma_device_t *device,
 	nccl_net_ofi_ep_rail_t *rail;
 	nccl_net_ofi_ep_rail_t *control_rail;
 	uint32_t tc = (ofi_nccl_use_low_lat_tc() == 0) ? FI_TC_UNSPEC : FI_TC_LOW_LATENCY;
+	nccl_net_ofi_rdma_ep_t *shared_rx_ep = domain->shared_rx_ep;
+	struct fid_ep *srx = NULL;
 
 	/* Initialize libfabric resources of endpoint rails */
 	for (uint16_t rail_id = 0; rail_id != device->num_rails; ++rail_id) {
 		rail_dev = rdma_device_get_rail(device, rail_id);
 		domain_rail = rdma_domain_get_rail(domain, rail_id);
 		rail = rdma_endpoint_get_rail(ep, rail_id);
+		if (shared_rx_ep != NULL) {
+			srx = rdma_endpoint_get_rail(shared_rx_ep, rail_id)->ofi_ep;
+		}
 
-		ret = ep_rail_init(ep, dev_id, rail_id, rail_dev, domain_rail, rail, FI_TC_UNSPEC);
+		ret = ep_rail_init(ep, dev_id, rail_id, rail_dev, domain_rail, rail, FI_TC_UNSPEC, srx);
 		if (ret != 0) {
 			NCCL_OFI_WARN("Initializing rail %d failed", rail_id);
 			goto exit;
@@ -7145,8 +9950,11 @@ static int init_rail_ofi_resources(nccl_net_ofi_rdma_device_t *device,
 		domain_rail = rdma_domain_get_rail(domain, rail_id);
 		rail = rdma_endpoint_get_rail(ep, rail_id);
 		control_rail = rdma_endpoint_get_control_rail(ep, rail_id);
+		if (shared_rx_ep != NULL) {
+			srx = rdma_endpoint_get_control_rail(shared_rx_ep, rail_id)->ofi_ep;
+		}
 
-		ret = ep_rail_init(ep, dev_id, rail_id, rail_dev, domain_rail, control_rail, tc);
+		ret = ep_rail_init(ep, dev_id, rail_id, rail_dev, domain_rail, control_rail, tc, srx);
 		if (ret != 0) {
 			NCCL_OFI_WARN("Initializing control rail %d failed", rail_id);
 			goto exit;
@@ -7246,14 +10054,18 @@ static int nccl_net_ofi_rdma_endpoint_free(nccl_net_ofi_ep_t *base_ep)
 		return ret;
 	}
 
-	if (ep->pending_reqs_queue) {
-		delete ep->pending_reqs_queue;
-		ep->pending_reqs_queue = NULL;
+	for (uint16_t rail_id = 0; ep->rails != NULL && rail_id < ep->num_rails; ++rail_id) {
+		ret = ep_rail_fini_pending_reqs(rdma_endpoint_get_rail(ep, rail_id));
+		if (ret != 0) {
+			return ret;
+		}
 	}
 
-	ret = nccl_net_ofi_mutex_destroy(&ep->pending_reqs_lock);
-	if (ret != 0) {
-		return ret;
+	for (uint16_t rail_id = 0; ep->control_rails != NULL && rail_id < ep->num_control_rails; ++rail_id) {
+		ret = ep_rail_fini_pending_reqs(rdma_endpoint_get_control_rail(ep, rail_id));
+		if (ret != 0) {
+			return ret;
+		}
 	}
 
 	free(ep->control_rails);
@@ -7264,25 +10076,138 @@ static int nccl_net_ofi_rdma_endpoint_free(nccl_net_ofi_ep_t *base_ep)
 }
 
 
-static inline int init_max_write_inline_size_if_not_initialized(nccl_net_ofi_rdma_device_t *device,
-								nccl_net_ofi_rdma_ep_t *ep)
-{
-	int ret = 0;
-	if (is_max_write_inline_size_initialized == false) {
-		/* Overwrite default max_write_inline_size value if
-		 * FI_OPT_INJECT_RMA_SIZE option is available */
-		ret = get_inject_rma_size_opt(ep->rails[0].ofi_ep,
-					      &max_write_inline_size);
-		if (ret == 0) {
-			is_max_write_inline_size_initialized = true;
-		} else if (ret == -FI_ENOPROTOOPT) {
-			max_write_inline_size = device->device_rails[0].info->tx_attr->inject_size;
-			is_max_write_inline_size_initialized = true;
-			ret = 0;
+static inline int init_max_write_inline_size_if_not_initialized(nccl_net_ofi_rdma_device_t *device,
+								nccl_net_ofi_rdma_ep_t *ep)
+{
+	int ret = 0;
+	if (is_max_write_inline_size_initialized == false) {
+		/* Overwrite default max_write_inline_size value if
+		 * FI_OPT_INJECT_RMA_SIZE option is available */
+		ret = get_inject_rma_size_opt(ep->rails[0].ofi_ep,
+					      &max_write_inline_size);
+		if (ret == 0) {
+			is_max_write_inline_size_initialized = true;
+		} else if (ret == -FI_ENOPROTOOPT) {
+			max_write_inline_size = device->device_rails[0].info->tx_attr->inject_size;
+			is_max_write_inline_size_initialized = true;
+			ret = 0;
+		} else {
+			NCCL_OFI_WARN("Failed to retrieve maximum write inline size");
+		}
+	}
+	return ret;
+}
+
+
+/*
+ * @brief	Allocate endpoint rails and initialize rail counts and rx
+ *		buffer sizes of endpoint
+ */
+static int rdma_ep_init_rails(nccl_net_ofi_rdma_domain_t *domain,
+			      nccl_net_ofi_rdma_device_t *device,
+			      nccl_net_ofi_rdma_ep_t *ep)
+{
+	int ret = 0;
+
+	ep->num_rails = domain->num_rails;
+
+	if (ofi_nccl_rdma_rr_ctrl_msg()) {
+		/*
+		 * Round robin the control message across all rails by using dedicated
+		 * endpoints with CQs shared with the data endpoints.
+		 */
+		ep->num_control_rails = domain->num_rails;
+	} else {
+		/*
+		 * Use a single rail for control messages, with a dedicated
+		 * endpoint and a CQ shared with the data endpoint.
+		 */
+		ep->num_control_rails = 1;
+	}
+
+	ep->use_long_rkeys = device->use_long_rkeys;
+
+	ep->rails = (nccl_net_ofi_ep_rail_t *)calloc(ep->num_rails,
+		sizeof(nccl_net_ofi_ep_rail_t));
+	if (!ep->rails) {
+		NCCL_OFI_WARN("Unable to allocate rdma rails");
+		return -ENOMEM;
+	}
+
+	ep->control_rails = (nccl_net_ofi_ep_rail_t *)calloc(ep->num_control_rails, sizeof(nccl_net_ofi_ep_rail_t));
+	if (!ep->control_rails) {
+		NCCL_OFI_WARN("Unable to allocate rdma control rails");
+		return -ENOMEM;
+	}
+
+	for (uint16_t rail_id = 0; rail_id < ep->num_rails; ++rail_id) {
+		ret = ep_rail_init_pending_reqs(rdma_endpoint_get_rail(ep, rail_id));
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	for (uint16_t rail_id = 0; rail_id < ep->num_control_rails; ++rail_id) {
+		ret = ep_rail_init_pending_reqs(rdma_endpoint_get_control_rail(ep, rail_id));
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	ep->ctrl_rx_buff_size = std::max({sizeof(nccl_net_ofi_rdma_ctrl_msg_t),
+	    NCCL_OFI_RDMA_CONNECTION_INFO_MAX_SIZE,
+	    sizeof(nccl_net_ofi_rdma_close_msg_t)});
+	ep->eager_send_size = ofi_nccl_eager_max_size();
+	/* Work around EFA provider bug around posting 0 byte rx buffers by not
+	   posting 0 byte rx buffers.  Note that if eager_send_size is -1
+	   (disabled), eager_rx_buff_size will also be -1. */
+	ep->eager_rx_buff_size = (ep->eager_send_size == 0) ?
+		EAGER_RX_BUFFER_ALIGNMENT : ep->eager_send_size;
+
+	/* Eager messages may be sent on any data rail, so only inject
+	   messages that fit into the inject size of all of them */
+	ep->eager_inject_size = -1;
+	if (ofi_nccl_rdma_eager_inject() && ep->eager_send_size >= 0) {
+		size_t inject_size = SIZE_MAX;
+		for (uint16_t rail_id = 0; rail_id < ep->num_rails; ++rail_id) {
+			struct fi_info *info = rdma_device_get_rail(device, rail_id)->info;
+			inject_size = std::min(inject_size, info->tx_attr->inject_size);
+		}
+		ep->eager_inject_size = (ssize_t)std::min(inject_size, (size_t)ep->eager_send_size);
+	}
+
+	/* Zero-byte messages are injected on the first data rail with
+	   a NULL buffer and no descriptor, which requires inject
+	   support and remote CQ data for the immediate data */
+	ep->zero_byte_inject = false;
+	if (ofi_nccl_rdma_zero_byte_inject() != 0) {
+		struct fi_info *info = rdma_device_get_rail(device, 0)->info;
+		if (info->tx_attr->inject_size > 0 &&
+		    (info->caps & FI_RMA) != 0 &&
+		    info->domain_attr->cq_data_size >= sizeof(uint32_t)) {
+			ep->zero_byte_inject = true;
+		} else {
+			NCCL_OFI_INFO(NCCL_INIT | NCCL_NET,
+				      "Provider %s does not support injects with remote CQ data; "
+				      "disabling zero-byte injects",
+				      info->fabric_attr->prov_name);
+		}
+	}
+
+	/* Pull messages are injected on the first control rail and
+	   advertise virtual addresses */
+	ep->pull_min_size = -1;
+	if (ofi_nccl_rdma_pull_min_size() >= 0 && virt_addr_mr) {
+		struct fi_info *info = rdma_device_get_rail(device, 0)->info;
+		size_t pull_msg_size = nccl_net_ofi_rdma_ctrl_msg_size(ep->num_rails, ep->use_long_rkeys);
+		if (pull_msg_size <= info->tx_attr->inject_size) {
+			ep->pull_min_size = (ssize_t)ofi_nccl_rdma_pull_min_size();
 		} else {
-			NCCL_OFI_WARN("Failed to retrieve maximum write inline size");
+			NCCL_OFI_INFO(NCCL_NET, "Pull message of %zu bytes exceeds inject size %zu; pull mode disabled",
+				      pull_msg_size, info->tx_attr->inject_size);
 		}
 	}
+
 	return ret;
 }
 
@@ -7323,57 +10248,11 @@ static int nccl_net_ofi_rdma_domain_create_endpoint(nccl_net_ofi_domain_t *base_
 	ep->base.release_ep = nccl_net_ofi_rdma_endpoint_release;
 	ep->base.free_ep = nccl_net_ofi_rdma_endpoint_free;
 
-	ep->num_rails = domain->num_rails;
-
-	if (ofi_nccl_rdma_rr_ctrl_msg()) {
-		/*
-		 * Round robin the control message across all rails by using dedicated
-		 * endpoints with CQs shared with the data endpoints.
-		 */
-		ep->num_control_rails = domain->num_rails;
-	} else {
-		/*
-		 * Use a single rail for control messages, with a dedicated
-		 * endpoint and a CQ shared with the data endpoint.
-		 */
-		ep->num_control_rails = 1;
-	}
-
-	ep->use_long_rkeys = device->use_long_rkeys;
-
-	ep->rails = (nccl_net_ofi_ep_rail_t *)calloc(ep->num_rails,
-		sizeof(nccl_net_ofi_ep_rail_t));
-	if (!ep->rails) {
-		NCCL_OFI_WARN("Unable to allocate rdma rails");
-		ret = -ENOMEM;
-		goto error;
-	}
-
-	ep->control_rails = (nccl_net_ofi_ep_rail_t *)calloc(ep->num_control_rails, sizeof(nccl_net_ofi_ep_rail_t));
-	if (!ep->control_rails) {
-		NCCL_OFI_WARN("Unable to allocate rdma control rails");
-		ret = -ENOMEM;
-		goto error;
-	}
-
-	ep->pending_reqs_queue = new std::deque<nccl_net_ofi_rdma_req_t *>;
-
-	ret = nccl_net_ofi_mutex_init(&ep->pending_reqs_lock, NULL);
+	ret = rdma_ep_init_rails(domain, device, ep);
 	if (ret != 0) {
-		NCCL_OFI_WARN("Mutex initialization failed: %s", strerror(ret));
 		goto error;
 	}
 
-	ep->ctrl_rx_buff_size = std::max({sizeof(nccl_net_ofi_rdma_ctrl_msg_t),
-	    sizeof(nccl_ofi_rdma_connection_info_t),
-	    sizeof(nccl_net_ofi_rdma_close_msg_t)});
-	ep->eager_send_size = ofi_nccl_eager_max_size();
-	/* Work around EFA provider bug around posting 0 byte rx buffers by not
-	   posting 0 byte rx buffers.  Note that if eager_send_size is -1
-	   (disabled), eager_rx_buff_size will also be -1. */
-	ep->eager_rx_buff_size = (ep->eager_send_size == 0) ?
-		EAGER_RX_BUFFER_ALIGNMENT : ep->eager_send_size;
-
 	ep->is_endpoint_per_communicator_ep = false;
 
 	ret = init_rail_ofi_resources(device, domain, ep);
@@ -7403,6 +10282,14 @@ static int nccl_net_ofi_rdma_domain_create_endpoint(nccl_net_ofi_domain_t *base_
 		ret = init_max_write_inline_size_if_not_initialized(device, ep);
 	}
 
+	/* Start the progress thread with the first endpoint of the
+	 * domain, which is the endpoint it progresses. Endpoints
+	 * created later are per-communicator endpoints sharing the CQs
+	 * of the domain. */
+	if (ret == 0 && ofi_nccl_progress_thread() != 0 && !domain->progress_thread_started) {
+		ret = rdma_domain_start_progress_thread(domain, device);
+	}
+
 error:
 	if (ret != 0) {
 		ep->base.release_ep(&(ep->base), false, false);
@@ -7412,12 +10299,206 @@ static int nccl_net_ofi_rdma_domain_create_endpoint(nccl_net_ofi_domain_t *base_
 }
 
 
+/*
+ * @brief	Create the shared rx endpoint of a domain
+ *
+ * The shared rx endpoint owns one libfabric shared receive context
+ * per data and control rail and the rx buffers posted to them.
+ * Endpoints created on the domain afterwards bind to these contexts
+ * instead of posting rx buffers of their own, so that the number of
+ * posted rx buffers no longer grows with the number of endpoints.
+ *
+ * @return	0, on success or if shared receive contexts are not
+ *		supported by the provider
+ *		non-zero, on error
+ */
+static int create_shared_rx_ep(nccl_net_ofi_rdma_domain_t *domain,
+			       nccl_net_ofi_rdma_device_t *device)
+{
+	int ret = 0;
+	bool rx_buffers_init = false;
+	nccl_net_ofi_rdma_ep_t *ep = NULL;
+
+	assert(domain->shared_rx_ep == NULL);
+
+	ep = (nccl_net_ofi_rdma_ep_t *)calloc(1, sizeof(nccl_net_ofi_rdma_ep_t));
+	if (!ep) {
+		NCCL_OFI_WARN("Unable to allocate shared rx endpoint");
+		return -ENOMEM;
+	}
+
+	ret = nccl_net_ofi_endpoint_init(&domain->base, &ep->base);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Initializing endpoint base failed");
+		free(ep);
+		return ret;
+	}
+
+	ep->base.free_ep = nccl_net_ofi_rdma_endpoint_free;
+
+	ret = rdma_ep_init_rails(domain, device, ep);
+	if (ret != 0) {
+		goto error;
+	}
+
+	for (uint16_t rail_id = 0; rail_id < ep->num_rails; ++rail_id) {
+		nccl_net_ofi_rdma_device_rail_t *rail_dev = rdma_device_get_rail(device, rail_id);
+		nccl_net_ofi_rdma_domain_rail_t *domain_rail = rdma_domain_get_rail(domain, rail_id);
+		nccl_net_ofi_ep_rail_t *rail = rdma_endpoint_get_rail(ep, rail_id);
+
+		rail->rail_id = rail_id;
+		ret = fi_srx_context(domain_rail->domain, rail_dev->info->rx_attr,
+				     &rail->ofi_ep, NULL);
+		if (ret != 0) {
+			goto error;
+		}
+	}
+
+	for (uint16_t rail_id = 0; rail_id < ep->num_control_rails; ++rail_id) {
+		nccl_net_ofi_rdma_device_rail_t *rail_dev = rdma_device_get_rail(device, rail_id);
+		nccl_net_ofi_rdma_domain_rail_t *domain_rail = rdma_domain_get_rail(domain, rail_id);
+		nccl_net_ofi_ep_rail_t *rail = rdma_endpoint_get_control_rail(ep, rail_id);
+
+		rail->rail_id = rail_id;
+		ret = fi_srx_context(domain_rail->domain, rail_dev->info->rx_attr,
+				     &rail->ofi_ep, NULL);
+		if (ret != 0) {
+			goto error;
+		}
+	}
+
+	ret = init_rx_buffers(ep);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Preparation of shared rx buffers failed");
+		goto error;
+	}
+	rx_buffers_init = true;
+
+	ret = post_rx_buffs(ep);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Error posting shared rx buffers: %d", ret);
+		goto error;
+	}
+
+	domain->shared_rx_ep = ep;
+
+	NCCL_OFI_TRACE(NCCL_NET, "RDMA shared rx endpoint %p for dev #%d is created",
+		       ep, device->base.dev_id);
+
+	return 0;
+
+error:
+	release_rdma_ep_resources(ep, device->base.dev_id);
+	if (rx_buffers_init) {
+		fini_rx_buffers(ep);
+	}
+	for (uint16_t rail_id = 0; ep->rails != NULL && rail_id < ep->num_rails; ++rail_id) {
+		ep_rail_fini_pending_reqs(rdma_endpoint_get_rail(ep, rail_id));
+	}
+	for (uint16_t rail_id = 0; ep->control_rails != NULL && rail_id < ep->num_control_rails; ++rail_id) {
+		ep_rail_fini_pending_reqs(rdma_endpoint_get_control_rail(ep, rail_id));
+	}
+	free(ep->control_rails);
+	free(ep->rails);
+	free(ep);
+
+	if (ret == -FI_ENOSYS || ret == -FI_EOPNOTSUPP) {
+		NCCL_OFI_INFO(NCCL_NET, "Shared receive contexts not supported by provider. Endpoints will post their own rx buffers");
+		return 0;
+	}
+
+	NCCL_OFI_WARN("Failed to create shared rx endpoint. RC: %d, ERROR: %s",
+		      ret, fi_strerror(-ret));
+	return ret;
+}
+
+
+/*
+ * @brief	Allocate the CQ entry buffer of a domain rail and
+ *		initialize its adaptive read count
+ */
+static int domain_rail_init_cq_buffers(nccl_net_ofi_rdma_domain_rail_t *domain_rail)
+{
+	int ret;
+
+	domain_rail->cq_read_count = std::max(cq_read_count, (size_t)1);
+	domain_rail->cq_read_count_max = std::max((size_t)ofi_nccl_cq_read_count_max(),
+						  domain_rail->cq_read_count);
+
+	ret = nccl_net_ofi_mutex_init(&domain_rail->cq_lock, NULL);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Unable to initialize CQ lock");
+		return -ret;
+	}
+
+	domain_rail->cqe_buffers = (struct fi_cq_data_entry *)
+		calloc(domain_rail->cq_read_count_max, sizeof(struct fi_cq_data_entry));
+	if (domain_rail->cqe_buffers == NULL) {
+		NCCL_OFI_WARN("Unable to allocate CQ entry buffer");
+		nccl_net_ofi_mutex_destroy(&domain_rail->cq_lock);
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+/*
+ * @brief	Release resources allocated by domain_rail_init_cq_buffers()
+ */
+static void domain_rail_fini_cq_buffers(nccl_net_ofi_rdma_domain_rail_t *domain_rail)
+{
+	if (domain_rail->cqe_buffers == NULL) {
+		return;
+	}
+
+	/* Report the CQ reads per completion entry to show the effect of
+	 * CQ_IDLE_POLL_INTERVAL */
+	if (domain_rail->num_cq_entries > 0) {
+		NCCL_OFI_INFO(NCCL_NET, "Domain rail %u: %" PRIu64 " fi_cq_read calls for %" PRIu64
+			      " completion entries (%.2f per entry)",
+			      domain_rail->rail_id, domain_rail->num_cq_reads,
+			      domain_rail->num_cq_entries,
+			      (double)domain_rail->num_cq_reads / domain_rail->num_cq_entries);
+	}
+
+	free(domain_rail->cqe_buffers);
+	domain_rail->cqe_buffers = NULL;
+	nccl_net_ofi_mutex_destroy(&domain_rail->cq_lock);
+}
+
+
 static int
 nccl_net_ofi_rdma_domain_free(nccl_net_ofi_domain_t *base_domain)
 {
 	int ret;
 	nccl_net_ofi_rdma_domain_t *domain = (nccl_net_ofi_rdma_domain_t *)base_domain;
 
+	rdma_domain_stop_progress_thread(domain);
+
+	/* All endpoints bound to the shared receive contexts are gone
+	   by now, so they can be closed before the CQs */
+	if (domain->shared_rx_ep != NULL) {
+		ret = nccl_net_ofi_rdma_endpoint_free(&domain->shared_rx_ep->base);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Failed to free shared rx endpoint");
+			return ret;
+		}
+		domain->shared_rx_ep = NULL;
+	}
+
+	if (domain->cq_epoll_fd >= 0) {
+		close(domain->cq_epoll_fd);
+		domain->cq_epoll_fd = -1;
+	}
+	if (domain->progress_wake_fd >= 0) {
+		close(domain->progress_wake_fd);
+		domain->progress_wake_fd = -1;
+	}
+	if (domain->progress_wait_histogram) {
+		delete domain->progress_wait_histogram;
+		domain->progress_wait_histogram = NULL;
+	}
+
 	ret = dealloc_and_dereg_flush_buff(domain);
 	if (ret != 0) {
 		NCCL_OFI_WARN("Failed to deregister ctrl buffer pool");
@@ -7430,6 +10511,7 @@ nccl_net_ofi_rdma_domain_free(nccl_net_ofi_domain_t *base_domain)
 			domain->domain_rails[i].cq = NULL;
 		}
 		fi_close(&domain->domain_rails[i].domain->fid);
+		domain_rail_fini_cq_buffers(&domain->domain_rails[i]);
 	}
 	free(domain->domain_rails);
 
@@ -7458,9 +10540,76 @@ nccl_net_ofi_rdma_domain_free(nccl_net_ofi_domain_t *base_domain)
 }
 
 
+/*
+ * @brief	Collect the wait fds of all rail CQs of the domain, and
+ *		an eventfd signaled on new pending requests, in an epoll
+ *		instance for the progress thread to block on
+ */
+static int init_cq_wait(nccl_net_ofi_rdma_domain_t *domain)
+{
+	int ret;
+
+	domain->cq_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (domain->cq_epoll_fd < 0) {
+		ret = -errno;
+		NCCL_OFI_WARN("Unable to create epoll instance: %s", strerror(-ret));
+		return ret;
+	}
+
+	for (uint16_t rail_id = 0; rail_id != domain->num_rails; ++rail_id) {
+		nccl_net_ofi_rdma_domain_rail_t *domain_rail = rdma_domain_get_rail(domain, rail_id);
+		int wait_fd = -1;
+
+		ret = fi_control(&domain_rail->cq->fid, FI_GETWAIT, &wait_fd);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Unable to retrieve CQ wait fd. RC: %d, ERROR: %s",
+				      ret, fi_strerror(-ret));
+			return ret;
+		}
+
+		struct epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.u32 = rail_id;
+		ret = epoll_ctl(domain->cq_epoll_fd, EPOLL_CTL_ADD, wait_fd, &event);
+		if (ret != 0) {
+			ret = -errno;
+			NCCL_OFI_WARN("Unable to add CQ wait fd to epoll instance: %s",
+				      strerror(-ret));
+			return ret;
+		}
+	}
+
+	domain->progress_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (domain->progress_wake_fd < 0) {
+		ret = -errno;
+		NCCL_OFI_WARN("Unable to create eventfd: %s", strerror(-ret));
+		return ret;
+	}
+
+	struct epoll_event wake_event = {};
+	wake_event.events = EPOLLIN;
+	wake_event.data.u32 = MAX_NUM_RAILS;
+	ret = epoll_ctl(domain->cq_epoll_fd, EPOLL_CTL_ADD, domain->progress_wake_fd, &wake_event);
+	if (ret != 0) {
+		ret = -errno;
+		NCCL_OFI_WARN("Unable to add eventfd to epoll instance: %s", strerror(-ret));
+		return ret;
+	}
+
+	domain->progress_wait_histogram =
+		new timer_histogram<histogram_custom_binner<std::size_t>>(
+			"rdma progress thread wait time (us)",
+			histogram_custom_binner<std::size_t>(
+				{0, 10, 50, 100, 500, 1000, 5000, 10000, 50000, 100000}));
+
+	return 0;
+}
+
+
 static nccl_net_ofi_domain_t *nccl_net_ofi_rdma_device_create_domain(nccl_net_ofi_device_t *base_dev)
 {
 	int ret = 0;
+	bool use_cq_wait = false;
 	nccl_net_ofi_rdma_domain_t *domain = NULL;
 	nccl_net_ofi_rdma_device_t *device = NULL;
 
@@ -7470,11 +10619,16 @@ static nccl_net_ofi_domain_t *nccl_net_ofi_rdma_device_create_domain(nccl_net_of
 		return NULL;
 	}
 
+	/* Blocking on CQs is only done by the progress thread */
+	use_cq_wait = (ofi_nccl_progress_thread() != 0 && ofi_nccl_cq_wait_spin_usec() >= 0);
+
 	domain = (nccl_net_ofi_rdma_domain_t *)calloc(1, sizeof(nccl_net_ofi_rdma_domain_t));
 	if (!domain) {
 		NCCL_OFI_WARN("Unable to allocate rdma domain");
 		return NULL;
 	}
+	domain->cq_epoll_fd = -1;
+	domain->progress_wake_fd = -1;
 
 	ret = nccl_net_ofi_domain_init(&device->base, &domain->base);
 	if (ret != 0) {
@@ -7507,6 +10661,11 @@ static nccl_net_ofi_domain_t *nccl_net_ofi_rdma_device_create_domain(nccl_net_of
 
 		domain_rail->rail_id = i;
 
+		ret = domain_rail_init_cq_buffers(domain_rail);
+		if (ret != 0) {
+			goto error;
+		}
+
 		ret = fi_domain(device_rail->fabric, device_rail->info,
 				&domain_rail->domain, NULL);
 		if (OFI_UNLIKELY(ret != 0)) {
@@ -7519,7 +10678,32 @@ static nccl_net_ofi_domain_t *nccl_net_ofi_rdma_device_create_domain(nccl_net_of
 		   opened on this domain rail */
 		struct fi_cq_attr cq_attr = {};
 		cq_attr.format = FI_CQ_FORMAT_DATA;
+		if (use_cq_wait) {
+			cq_attr.wait_obj = FI_WAIT_FD;
+		}
 		ret = fi_cq_open(domain_rail->domain, &cq_attr, &domain_rail->cq, NULL);
+		if (use_cq_wait && ret == -FI_ENOSYS) {
+			NCCL_OFI_INFO(NCCL_NET, "CQ wait objects not supported by provider. Progress thread will not block");
+			use_cq_wait = false;
+			cq_attr.wait_obj = FI_WAIT_NONE;
+
+			/* Reopen the CQs of the previous rails without wait
+			   objects as well. No endpoint is bound to them yet. */
+			for (uint16_t prev_id = 0; prev_id != i; ++prev_id) {
+				nccl_net_ofi_rdma_domain_rail_t *prev_rail = rdma_domain_get_rail(domain, prev_id);
+
+				fi_close(&prev_rail->cq->fid);
+				prev_rail->cq = NULL;
+				ret = fi_cq_open(prev_rail->domain, &cq_attr, &prev_rail->cq, NULL);
+				if (OFI_UNLIKELY(ret != 0)) {
+					NCCL_OFI_WARN("Couldn't reopen CQ. RC: %d, ERROR: %s",
+						      ret, fi_strerror(-ret));
+					goto error;
+				}
+			}
+
+			ret = fi_cq_open(domain_rail->domain, &cq_attr, &domain_rail->cq, NULL);
+		}
 		if (OFI_UNLIKELY(ret != 0)) {
 			NCCL_OFI_WARN("Couldn't open CQ. RC: %d, ERROR: %s",
 				      ret, fi_strerror(-ret));
@@ -7528,6 +10712,13 @@ static nccl_net_ofi_domain_t *nccl_net_ofi_rdma_device_create_domain(nccl_net_of
 		assert(domain_rail->cq != NULL);
 	}
 
+	if (use_cq_wait) {
+		ret = init_cq_wait(domain);
+		if (ret != 0) {
+			goto error;
+		}
+	}
+
 	/*
 	 * Setup flush resources.
 	 */
@@ -7543,6 +10734,13 @@ static nccl_net_ofi_domain_t *nccl_net_ofi_rdma_device_create_domain(nccl_net_of
 	}
 	assert(domain->scheduler);
 
+	if (ofi_nccl_endpoint_per_communicator() != 0 && ofi_nccl_rdma_shared_rx() != 0) {
+		ret = create_shared_rx_ep(domain, device);
+		if (ret != 0) {
+			goto error;
+		}
+	}
+
 error:
 	if (ret != 0) {
 		domain->base.release(&(domain->base), false, false);
@@ -7704,9 +10902,10 @@ nccl_net_ofi_rdma_device_release(nccl_net_ofi_device_t *base_device)
 		free(device->device_rails);
 	}
 
-	if (device->comms) {
-		free(device->comms);
-		device->comms = NULL;
+	if (device->comm_table) {
+		delete device->comm_table;
+		device->comm_table = NULL;
+		nccl_net_ofi_mutex_destroy(&device->listen_comm_lock);
 	}
 
 	if (device->comm_idpool) {
@@ -7822,6 +11021,18 @@ static nccl_net_ofi_rdma_device_t *nccl_net_ofi_rdma_device_create(
 		goto error;
 	}
 
+	if (ofi_nccl_progress_thread() != 0 && topo != NULL) {
+		/* Rails of a device are grouped by topology, so the
+		 * first NIC is representative of all of them */
+		ret = nccl_ofi_topo_get_nic_cpuset(topo, info_list, &device->local_cpuset);
+		device->has_local_cpuset = (ret == 0);
+		if (ret != 0) {
+			NCCL_OFI_INFO(NCCL_NET, "Unable to determine cpuset of dev %d. Progress threads will not be pinned",
+				      dev_id);
+			ret = 0;
+		}
+	}
+
 	if (info_list->domain_attr->mr_key_size <= NCCL_NET_OFI_CTRL_MSG_SHORT_KEY_SIZE) {
 		device->use_long_rkeys = false;
 	} else {
@@ -7838,16 +11049,17 @@ static nccl_net_ofi_rdma_device_t *nccl_net_ofi_rdma_device_create(
 		goto error;
 	}
 
-	/* Create array of comms. */
-	/* TODO make this array expandable */
-	device->comms = (nccl_net_ofi_comm_t**)calloc(NCCL_OFI_RDMA_MAX_COMMS,
-		sizeof(nccl_net_ofi_comm_t*));
-	if (!device->comms) {
-		NCCL_OFI_WARN("Failed to alloc comms array");
-		ret = -ENOMEM;
+	ret = nccl_net_ofi_mutex_init(&device->listen_comm_lock, NULL);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Unable to initialize listen_comm_lock");
 		goto error;
 	}
 
+	/* Create lookup table of comms. Leaves of the table are
+	   allocated as comm IDs get used. Its existence also marks
+	   listen_comm_lock as initialized for device release. */
+	device->comm_table = new nccl_ofi_idtable_t(device->num_comm_ids);
+
 	/* Initialize device ID pool */
 	device->comm_idpool = new nccl_ofi_idpool_t(device->num_comm_ids);
 
@@ -7886,6 +11098,11 @@ static void get_hints(struct fi_info *hints)
 	 * the NCCL level.  */
 	hints->caps |= FI_LOCAL_COMM | FI_REMOTE_COMM;
 
+	/* Rx buffer slabs receiving several messages each */
+	if (ofi_nccl_rdma_multi_recv_msgs() > 0) {
+		hints->caps |= FI_MULTI_RECV;
+	}
+
 	hints->mode = FI_CONTEXT | FI_CONTEXT2;
 
 	hints->ep_attr->type = FI_EP_RDM;
@@ -7914,14 +11131,9 @@ static inline int nccl_net_ofi_rdma_plugin_fini(nccl_net_ofi_plugin_t *plugin)
 		rdma_plugin->topo = NULL;
 	}
 
-	if (r_comm_cleanup_list != NULL) {
-		delete r_comm_cleanup_list;
-		r_comm_cleanup_list = NULL;
-	}
-
-	if (s_comm_cleanup_list != NULL) {
-		delete s_comm_cleanup_list;
-		s_comm_cleanup_list = NULL;
+	if (closing_ep_list != NULL) {
+		delete closing_ep_list;
+		closing_ep_list = NULL;
 	}
 
 	ret = nccl_net_ofi_plugin_fini(plugin);
@@ -7951,6 +11163,14 @@ static inline int nccl_net_ofi_rdma_plugin_complete_init(nccl_net_ofi_plugin_t *
 		return ncclInvalidArgument;
 	}
 
+	if (ofi_nccl_endpoint_per_communicator() != 0 && ofi_nccl_rdma_shared_rx() != 0 &&
+	    ofi_nccl_rdma_multi_recv_msgs() != 0) {
+		/* FI_OPT_MIN_MULTI_RECV is an endpoint option and cannot be
+		 * set on the shared receive contexts */
+		NCCL_OFI_WARN("RDMA_SHARED_RX and RDMA_MULTI_RECV_MSGS are not supported together");
+		return ncclInvalidArgument;
+	}
+
 	/* Initialize user data iterator */
 	ret = nccl_ofi_topo_set_to_begin(rdma_plugin->topo, &data_iter);
 	if (ret != 0) {
@@ -8014,8 +11234,7 @@ static inline int nccl_net_ofi_rdma_plugin_create(size_t num_devices,
 
 	/* TODO: we should probably have an rdma_plugin object and put globals
 	   such as these there. */
-	s_comm_cleanup_list = new std::deque<nccl_net_ofi_rdma_send_comm_t*>;
-	r_comm_cleanup_list = new std::deque<nccl_net_ofi_rdma_recv_comm_t*>;
+	closing_ep_list = new std::deque<nccl_net_ofi_rdma_ep_t*>;
 
 	plugin->topo = topo;
 
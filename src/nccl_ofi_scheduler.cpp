@@ -84,8 +84,10 @@ static inline int set_schedule_by_threshold(nccl_net_ofi_threshold_scheduler_t *
 
 	if (size < scheduler->max_small_msg_size) {
 		nccl_net_ofi_mutex_lock(&scheduler->rr_lock);
-		int curr_rail_id = scheduler->rr_small_counter;
-		scheduler->rr_small_counter = (scheduler->rr_small_counter + 1) % num_rails;
+		/* The counter is shared by callers that may schedule on
+		 * fewer rails, so wrap it to `num_rails' first */
+		int curr_rail_id = scheduler->rr_small_counter % num_rails;
+		scheduler->rr_small_counter = (curr_rail_id + 1) % num_rails;
 		nccl_net_ofi_mutex_unlock(&scheduler->rr_lock);
 
 		schedule->num_xfer_infos = 1;
@@ -99,8 +101,8 @@ static inline int set_schedule_by_threshold(nccl_net_ofi_threshold_scheduler_t *
 		assert(num_stripes <= num_rails);
 
 		nccl_net_ofi_mutex_lock(&scheduler->rr_lock);
-		int curr_rail_id = scheduler->rr_counter;
-		scheduler->rr_counter = (scheduler->rr_counter + num_stripes) % num_rails;
+		int curr_rail_id = scheduler->rr_counter % num_rails;
+		scheduler->rr_counter = (curr_rail_id + num_stripes) % num_rails;
 		nccl_net_ofi_mutex_unlock(&scheduler->rr_lock);
 
 		/* Number of bytes left to assign */
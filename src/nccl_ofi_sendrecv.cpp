@@ -2397,7 +2397,8 @@ static int nccl_net_ofi_sendrecv_domain_create_endpoint(nccl_net_ofi_domain_t *b
 						ofi_domain,
 						&ep->ofi_ep,
 						&ep->av,
-						domain->cq);
+						domain->cq,
+						NULL);
 	if (ret != 0) {
 		return ret;
 	}
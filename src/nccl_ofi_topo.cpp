@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <string.h>
 #include <hwloc.h>
+#include <hwloc/glibc-sched.h>
 #include <rdma/fabric.h>
 #include <errno.h>
 #include <stdlib.h>
@@ -1660,3 +1661,40 @@ struct fi_info *nccl_ofi_topo_next_info_list(nccl_ofi_topo_data_iterator_t *iter
 
 	return info_list;
 }
+
+int nccl_ofi_topo_get_nic_cpuset(nccl_ofi_topo_t *topo, struct fi_info *info,
+				 cpu_set_t *cpuset)
+{
+	int ret;
+	hwloc_obj_t nic_node = NULL;
+	hwloc_obj_t ancestor = NULL;
+
+	if (!topo || !topo->topo) {
+		NCCL_OFI_WARN("Invalid topology. Topology is not initialized.");
+		return -EINVAL;
+	}
+
+	ret = get_hwloc_pcidev_by_fi_info(topo->topo, info, &nic_node);
+	if (ret != 0) {
+		return ret;
+	}
+	if (!nic_node) {
+		return -ENOENT;
+	}
+
+	/* I/O objects do not have cpusets. Use the closest ancestor
+	 * that has one. */
+	ancestor = hwloc_get_non_io_ancestor_obj(topo->topo, nic_node);
+	if (!ancestor || !ancestor->cpuset) {
+		return -ENOENT;
+	}
+
+	ret = hwloc_cpuset_to_glibc_sched_affinity(topo->topo, ancestor->cpuset,
+						   cpuset, sizeof(*cpuset));
+	if (ret != 0) {
+		NCCL_OFI_WARN("Failed to convert cpuset of NIC topology node");
+		return -EINVAL;
+	}
+
+	return 0;
+}
@@ -342,7 +342,7 @@ static int configure_ep_max_msg_size(struct fid_ep *ep)
 #if HAVE_DECL_FI_OPT_MAX_MSG_SIZE
 	ssize_t eager_max_size = (ssize_t)ofi_nccl_eager_max_size();
 	size_t optval = std::max(sizeof(nccl_net_ofi_rdma_ctrl_msg_t),
-				 sizeof(nccl_ofi_rdma_connection_info_t));
+				 NCCL_OFI_RDMA_CONNECTION_INFO_MAX_SIZE);
 
 	if (eager_max_size > 0) {
 		optval = std::max(optval, static_cast<size_t>(eager_max_size));
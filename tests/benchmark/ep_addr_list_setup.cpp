@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2025 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+#include "config.h"
+
+#include <chrono>
+#include <stdio.h>
+
+#include "test-common.h"
+#include "nccl_ofi_ep_addr_list.h"
+
+/*
+ * Simulate connection setup with one endpoint per communicator: each
+ * of `num_peers' peers in turn connects `num_rounds' communicators,
+ * creating an endpoint whenever all existing endpoints are connected
+ * to the peer already. The first peer creates all endpoints, and every
+ * other peer connects to all of them. Reports the average cost of a
+ * connection.
+ */
+static void measure_connection_setup(size_t num_peers, size_t num_rounds)
+{
+	nccl_ofi_ep_addr_list_t ep_addr_list;
+
+	auto start = std::chrono::steady_clock::now();
+	for (size_t peer = 0; peer < num_peers; ++peer) {
+		for (size_t round = 0; round < num_rounds; ++round) {
+			nccl_net_ofi_ep_t *ep = NULL;
+			int ret = ep_addr_list.get(&peer, sizeof(peer), &ep);
+			if (ret != 0) {
+				NCCL_OFI_WARN("ep_addr_list.get failed");
+				exit(1);
+			}
+			if (ep == NULL) {
+				if (peer != 0) {
+					NCCL_OFI_WARN("No ep returned when expected. peer %zu, round %zu",
+						      peer, round);
+					exit(1);
+				}
+				ep = (nccl_net_ofi_ep_t *)(uintptr_t)(round + 1);
+				ret = ep_addr_list.insert(ep, &peer, sizeof(peer));
+				if (ret != 0) {
+					NCCL_OFI_WARN("ep_addr_list.insert failed");
+					exit(1);
+				}
+			}
+			/* Endpoints are handed out in insertion order */
+			if ((uintptr_t)ep != round + 1) {
+				NCCL_OFI_WARN("Unexpected ep returned. peer %zu, round %zu", peer, round);
+				exit(1);
+			}
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	/* Every peer is connected to every endpoint now */
+	for (size_t peer = 0; peer < num_peers; ++peer) {
+		nccl_net_ofi_ep_t *ep = NULL;
+		ep_addr_list.get(&peer, sizeof(peer), &ep);
+		if (ep != NULL) {
+			NCCL_OFI_WARN("Unexpected non-NULL ep");
+			exit(1);
+		}
+	}
+
+	for (size_t round = 0; round < num_rounds; ++round) {
+		if (ep_addr_list.remove((nccl_net_ofi_ep_t *)(uintptr_t)(round + 1)) != 0) {
+			NCCL_OFI_WARN("Delete ep failed unexpectedly");
+			exit(1);
+		}
+	}
+
+	double ns = std::chrono::duration<double, std::nano>(end - start).count();
+	NCCL_OFI_INFO(NCCL_NET, "%zu peers, %zu endpoints: %.1f ns per connection",
+		      num_peers, num_rounds, ns / (num_peers * num_rounds));
+}
+
+int main(int argc, char *argv[])
+{
+	ofi_log_function = logger;
+
+	/* Connection setup cost should not grow with the number of endpoints */
+	measure_connection_setup(1024, 16);
+	measure_connection_setup(1024, 1024);
+
+	printf("Benchmark completed successfully!\n");
+
+	return 0;
+}
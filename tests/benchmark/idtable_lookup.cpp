@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2025 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+#include "config.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test-common.h"
+#include "nccl_ofi_idtable.h"
+
+/*
+ * Compare lookup cost with a dense array for a working set of
+ * `num_ids' IDs, looked up in the order of immediate data of write
+ * completions arriving from many peers.
+ */
+static void measure_lookup(size_t size, size_t num_ids)
+{
+	const size_t num_lookups = 1 << 24;
+	nccl_ofi_idtable_t table(size);
+	void **dense = (void **)calloc(size, sizeof(void *));
+	size_t *ids = (size_t *)malloc(num_lookups * sizeof(size_t));
+	if (dense == NULL || ids == NULL) {
+		NCCL_OFI_WARN("Failed to allocate lookup arrays");
+		exit(1);
+	}
+
+	for (size_t id = 0; id < num_ids; id++) {
+		if (table.set(id, &dense[id]) != 0) {
+			NCCL_OFI_WARN("ID table set failed");
+			exit(1);
+		}
+		dense[id] = &dense[id];
+	}
+
+	srand(0);
+	for (size_t i = 0; i < num_lookups; i++) {
+		ids[i] = (size_t)rand() % num_ids;
+	}
+
+	uintptr_t sum_dense = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < num_lookups; i++) {
+		sum_dense += (uintptr_t)__atomic_load_n(&dense[ids[i]], __ATOMIC_ACQUIRE);
+	}
+	auto mid = std::chrono::steady_clock::now();
+	uintptr_t sum_table = 0;
+	for (size_t i = 0; i < num_lookups; i++) {
+		sum_table += (uintptr_t)table.get(ids[i]);
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	if (sum_dense != sum_table) {
+		NCCL_OFI_WARN("ID table lookups differ from dense array lookups");
+		exit(1);
+	}
+
+	double ns_dense = std::chrono::duration<double, std::nano>(mid - start).count() / num_lookups;
+	double ns_table = std::chrono::duration<double, std::nano>(end - mid).count() / num_lookups;
+	NCCL_OFI_INFO(NCCL_NET, "%zu live IDs: dense array %.2f ns/lookup, ID table %.2f ns/lookup, "
+		      "%zu of %zu leaves allocated",
+		      num_ids, ns_dense, ns_table, table.get_num_leaves(),
+		      (size + nccl_ofi_idtable_t::leaf_size - 1) / nccl_ofi_idtable_t::leaf_size);
+
+	free(ids);
+	free(dense);
+}
+
+int main(int argc, char *argv[])
+{
+	ofi_log_function = logger;
+
+	/* Lookup cost with few and with many live communicators */
+	measure_lookup(1 << 18, 64);
+	measure_lookup(1 << 18, 1 << 14);
+
+	printf("Benchmark completed successfully!\n");
+
+	return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2025 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+#include "config.h"
+
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "test-common.h"
+#include "nccl_ofi_rdma.h"
+#include "nccl_ofi_scheduler.h"
+
+/*
+ * Number of NICs per GPU of p5.48xlarge (topology/p5.48xl-topo.xml),
+ * the topology with the most rails
+ */
+#define P5_NUM_RAILS (4)
+
+/*
+ * Measure the cost of striping messages of `msg_size' bytes and
+ * tracking their segment completions on the receive side: schedule
+ * the message over `num_rails' rails, encode the write immediate data
+ * of each segment, and decode it again for every segment completion,
+ * counting completions until the decoded segment count is reached.
+ * Messages are split into `num_segms' segments, or follow the schedule
+ * if `num_segms' is 0.
+ */
+static int measure_segments(nccl_net_ofi_scheduler_t *scheduler, int num_rails,
+			    size_t msg_size, size_t num_segms)
+{
+	const size_t num_msgs = 1 << 20;
+	/* Largest comm ID a receiver hands out */
+	const uint32_t comm_id = IMM_COMM_ID_MASK;
+	size_t total_segms = 0;
+	size_t num_completed = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < num_msgs; i++) {
+		nccl_net_ofi_schedule_t *schedule =
+			scheduler->get_schedule(scheduler, msg_size, num_rails);
+		if (schedule == NULL) {
+			NCCL_OFI_WARN("Failed to schedule message of %zu bytes", msg_size);
+			return 1;
+		}
+		size_t nsegms = (num_segms != 0) ? num_segms : schedule->num_xfer_infos;
+		uint16_t seq = i & MSG_SEQ_NUM_MASK;
+		uint64_t data = GET_RDMA_WRITE_IMM_DATA(comm_id, seq, nsegms);
+
+		/* Receive side: one write completion per segment */
+		int ncompls = 0;
+		for (size_t segm = 0; segm < nsegms; segm++) {
+			if (GET_COMM_ID_FROM_IMM(data) != comm_id ||
+			    GET_SEQ_NUM_FROM_IMM(data) != seq) {
+				NCCL_OFI_WARN("Immediate data decoded to wrong message");
+				return 1;
+			}
+			int total = (int)GET_NUM_SEG_FROM_IMM(data);
+			if (__atomic_add_fetch(&ncompls, 1, __ATOMIC_ACQ_REL) == total) {
+				num_completed++;
+			}
+		}
+		total_segms += nsegms;
+		nccl_net_ofi_release_schedule(scheduler, schedule);
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	if (num_completed != num_msgs) {
+		NCCL_OFI_WARN("Completed %zu of %zu messages", num_completed, num_msgs);
+		return 1;
+	}
+
+	double ns = std::chrono::duration<double, std::nano>(end - start).count() / num_msgs;
+	NCCL_OFI_INFO(NCCL_NET, "%d rails, %zu byte messages, %zu segments: %.2f ns/message",
+		      num_rails, msg_size, total_segms / num_msgs, ns);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	ofi_log_function = logger;
+	system_page_size = 4096;
+	size_t msg_sizes[] = {64 * 1024, 1024 * 1024, 16 * 1024 * 1024};
+
+	nccl_net_ofi_scheduler_t *scheduler;
+	if (nccl_net_ofi_threshold_scheduler_init(P5_NUM_RAILS, &scheduler)) {
+		NCCL_OFI_WARN("Failed to initialize threshold scheduler");
+		return 1;
+	}
+
+	for (size_t t = 0; t < sizeof(msg_sizes) / sizeof(size_t); t++) {
+		/* Segments as scheduled today, one per rail at most */
+		if (measure_segments(scheduler, P5_NUM_RAILS, msg_sizes[t], 0)) {
+			return 1;
+		}
+		/* Most segments a version 1 receiver can decode */
+		if (measure_segments(scheduler, P5_NUM_RAILS, msg_sizes[t],
+				     NCCL_OFI_RDMA_MAX_NUM_SEGMS_V1)) {
+			return 1;
+		}
+		/* Most segments the immediate data can encode */
+		if (measure_segments(scheduler, P5_NUM_RAILS, msg_sizes[t],
+				     NCCL_OFI_RDMA_MAX_NUM_SEGMS)) {
+			return 1;
+		}
+	}
+
+	if (scheduler->fini(scheduler)) {
+		NCCL_OFI_WARN("Failed to destroy threshold scheduler");
+		return 1;
+	}
+
+	printf("Benchmark completed successfully!\n");
+
+	return 0;
+}
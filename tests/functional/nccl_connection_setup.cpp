@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2025 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+/*
+ * This benchmark measures the time to establish connections from all
+ * other ranks to a single listen communicator on rank 0, i.e., the
+ * fan-in pattern of bootstrapping a communicator with many peers.
+ *
+ * Usage: nccl_connection_setup [-i <iterations>]
+ *
+ *   -i  Number of timed rounds (default: 10). In every round, each
+ *       rank other than rank 0 connects once to the listen
+ *       communicator of rank 0 while rank 0 accepts all connections.
+ *
+ * Rank 0 reports the time from the start of a round until it accepted
+ * all connections, averaged over the rounds, and the resulting time
+ * per connection.
+ */
+
+#include "config.h"
+
+#include <chrono>
+#include <vector>
+
+#include "test-common.h"
+
+#define DEFAULT_ITERS	(10)
+
+int main(int argc, char* argv[])
+{
+	ncclResult_t res = ncclSuccess;
+	int rank, num_ranks, opt;
+	int dev = 0;
+	int num_iters = DEFAULT_ITERS;
+	double elapsed_us = 0;
+
+	/* Plugin defines */
+	int ndev;
+	nccl_net_ofi_listen_comm_t *lComm = NULL;
+	std::vector<nccl_net_ofi_recv_comm_t *> rComms;
+	test_nccl_net_t *extNet = NULL;
+	test_nccl_net_device_handle_t *s_ignore, *r_ignore;
+	char handle[NCCL_NET_HANDLE_MAXSIZE] = {};
+
+	ofi_log_function = logger;
+
+	MPI_Init(&argc, &argv);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+	if (num_ranks < 2) {
+		NCCL_OFI_WARN("Expected at least two ranks but got %d.", num_ranks);
+		res = ncclInvalidArgument;
+		goto exit;
+	}
+
+	while ((opt = getopt(argc, argv, "i:")) != -1) {
+		switch (opt) {
+		case 'i':
+			num_iters = atoi(optarg);
+			break;
+		default:
+			NCCL_OFI_WARN("Usage: %s [-i <iterations>]", argv[0]);
+			res = ncclInvalidArgument;
+			goto exit;
+		}
+	}
+	if (num_iters <= 0) {
+		num_iters = DEFAULT_ITERS;
+	}
+
+	/* Get external Network from NCCL-OFI library */
+	extNet = get_extNet();
+	if (extNet == NULL) {
+		res = ncclInternalError;
+		goto exit;
+	}
+
+	/* Init API */
+	OFINCCLCHECKGOTO(extNet->init(&logger), res, exit);
+	OFINCCLCHECKGOTO(extNet->devices(&ndev), res, exit);
+
+	if (rank == 0) {
+		OFINCCLCHECKGOTO(extNet->listen(dev, (void *)&handle, (void **)&lComm), res, exit);
+	}
+	MPI_Bcast(handle, NCCL_NET_HANDLE_MAXSIZE, MPI_CHAR, 0, MPI_COMM_WORLD);
+
+	for (int iter = 0; iter < num_iters; iter++) {
+		MPI_Barrier(MPI_COMM_WORLD);
+		auto start = std::chrono::steady_clock::now();
+
+		if (rank == 0) {
+			/* Accept one connection from every other rank */
+			while (rComms.size() < (size_t)(num_ranks - 1)) {
+				nccl_net_ofi_recv_comm_t *rComm = NULL;
+				OFINCCLCHECKGOTO(extNet->accept((void *)lComm, (void **)&rComm, &r_ignore),
+						 res, exit);
+				if (rComm != NULL) {
+					rComms.push_back(rComm);
+				}
+			}
+			auto end = std::chrono::steady_clock::now();
+			elapsed_us += std::chrono::duration<double, std::micro>(end - start).count();
+
+			for (auto rComm : rComms) {
+				OFINCCLCHECKGOTO(extNet->closeRecv((void *)rComm), res, exit);
+			}
+			rComms.clear();
+		} else {
+			nccl_net_ofi_send_comm_t *sComm = NULL;
+			while (sComm == NULL) {
+				OFINCCLCHECKGOTO(extNet->connect(dev, (void *)handle, (void **)&sComm,
+								 &s_ignore), res, exit);
+			}
+			OFINCCLCHECKGOTO(extNet->closeSend((void *)sComm), res, exit);
+		}
+	}
+
+	if (rank == 0) {
+		double round_us = elapsed_us / num_iters;
+		printf("# %d connections per round, %d rounds\n", num_ranks - 1, num_iters);
+		printf("# %14s %18s\n", "round (us)", "per connection (us)");
+		printf("  %14.2f %18.2f\n", round_us, round_us / (num_ranks - 1));
+
+		OFINCCLCHECKGOTO(extNet->closeListen((void *)lComm), res, exit);
+		lComm = NULL;
+	}
+
+	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Finalize();
+
+exit:
+	return res;
+}
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2025 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+/*
+ * This benchmark measures the latency and bandwidth of ping-pong message
+ * exchanges between two ranks over a single device, as well as the CPU
+ * time spent per exchange.
+ *
+ * Usage: nccl_message_latency [-i <iterations>] [-g <gap_us>]
+ *
+ *   -i  Number of timed exchanges per message size (default: scaled
+ *       down from 1000 with the message size)
+ *   -g  Idle time in microseconds between two exchanges (default: 0).
+ *       A non-zero gap lets a progress thread blocking on CQ wait
+ *       objects go idle, so that the reported latency includes its
+ *       wake-up latency and the reported CPU time shows the CPU saved.
+ *
+ * Both ranks may run on the same host, in which case the provider's
+ * loopback path is measured. Protocol options are selected through the
+ * plugin's environment variables, e.g., OFI_NCCL_RDMA_PULL_MIN_SIZE,
+ * OFI_NCCL_PROGRESS_THREAD or OFI_NCCL_CQ_WAIT_SPIN_USEC, so that runs
+ * with and without an option can be compared.
+ */
+
+#include "config.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sys/resource.h>
+
+#include "test-common.h"
+
+#define WARMUP_ITERS	(10)
+
+static double cpu_time_us(void)
+{
+	struct rusage usage;
+
+	getrusage(RUSAGE_SELF, &usage);
+	return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e6 +
+		usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static ncclResult_t wait_req(test_nccl_net_t *extNet, nccl_net_ofi_req_t *req)
+{
+	int done = 0;
+
+	while (!done) {
+		OFINCCLCHECK(extNet->test((void *)req, &done, NULL));
+	}
+
+	return ncclSuccess;
+}
+
+/*
+ * Exchange one message of `size' bytes in each direction. Rank 0 sends
+ * first and rank 1 replies.
+ */
+static ncclResult_t ping_pong(test_nccl_net_t *extNet, int rank,
+			      nccl_net_ofi_send_comm_t *sComm,
+			      nccl_net_ofi_recv_comm_t *rComm,
+			      void *send_buf, void *send_mhandle,
+			      void *recv_buf, void *recv_mhandle, size_t size)
+{
+	int tag = 1;
+	nccl_net_ofi_req_t *send_req = NULL;
+	nccl_net_ofi_req_t *recv_req = NULL;
+
+	while (recv_req == NULL) {
+		OFINCCLCHECK(extNet->irecv((void *)rComm, 1, &recv_buf, &size, &tag,
+					   &recv_mhandle, (void **)&recv_req));
+	}
+
+	if (rank == 1) {
+		OFINCCLCHECK(wait_req(extNet, recv_req));
+	}
+
+	while (send_req == NULL) {
+		OFINCCLCHECK(extNet->isend((void *)sComm, send_buf, size, tag,
+					   send_mhandle, (void **)&send_req));
+	}
+	OFINCCLCHECK(wait_req(extNet, send_req));
+
+	if (rank == 0) {
+		OFINCCLCHECK(wait_req(extNet, recv_req));
+	}
+
+	return ncclSuccess;
+}
+
+int main(int argc, char* argv[])
+{
+	ncclResult_t res = ncclSuccess;
+	int rank, num_ranks, peer_rank, opt;
+	int dev = 0;
+	int buffer_type = NCCL_PTR_HOST;
+	int num_iters = 0;
+	long gap_us = 0;
+	test_nccl_properties_t props = {};
+
+	/* Plugin defines */
+	int ndev;
+	nccl_net_ofi_send_comm_t *sComm = NULL;
+	nccl_net_ofi_listen_comm_t *lComm = NULL;
+	nccl_net_ofi_recv_comm_t *rComm = NULL;
+	test_nccl_net_t *extNet = NULL;
+	test_nccl_net_device_handle_t *s_ignore, *r_ignore;
+	char src_handle[NCCL_NET_HANDLE_MAXSIZE] = {};
+	char handle[NCCL_NET_HANDLE_MAXSIZE] = {};
+
+	void *send_buf = NULL, *recv_buf = NULL;
+	void *send_mhandle = NULL, *recv_mhandle = NULL;
+
+	size_t sizes[] = {0, 8, 64, 512, 4 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024,
+			  4 * 1024 * 1024, 16 * 1024 * 1024, 64 * 1024 * 1024};
+	size_t max_size = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+
+	ofi_log_function = logger;
+
+	MPI_Init(&argc, &argv);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+	if (num_ranks != 2) {
+		NCCL_OFI_WARN("Expected two ranks but got %d. "
+			"The nccl_message_latency benchmark should be run with exactly two ranks.",
+			num_ranks);
+		res = ncclInvalidArgument;
+		goto exit;
+	}
+	peer_rank = 1 - rank;
+
+	while ((opt = getopt(argc, argv, "i:g:")) != -1) {
+		switch (opt) {
+		case 'i':
+			num_iters = atoi(optarg);
+			break;
+		case 'g':
+			gap_us = atol(optarg);
+			break;
+		default:
+			NCCL_OFI_WARN("Usage: %s [-i <iterations>] [-g <gap_us>]", argv[0]);
+			res = ncclInvalidArgument;
+			goto exit;
+		}
+	}
+
+	/* Get external Network from NCCL-OFI library */
+	extNet = get_extNet();
+	if (extNet == NULL) {
+		res = ncclInternalError;
+		goto exit;
+	}
+
+	/* Init API */
+	OFINCCLCHECKGOTO(extNet->init(&logger), res, exit);
+	OFINCCLCHECKGOTO(extNet->devices(&ndev), res, exit);
+	OFINCCLCHECKGOTO(extNet->getProperties(dev, &props), res, exit);
+	print_dev_props(dev, &props);
+
+	if (is_gdr_supported_nic(props.ptrSupport)) {
+		buffer_type = NCCL_PTR_CUDA;
+	}
+
+	/* Connect both directions */
+	OFINCCLCHECKGOTO(extNet->listen(dev, (void *)&handle, (void **)&lComm), res, exit);
+	MPI_Sendrecv(handle, NCCL_NET_HANDLE_MAXSIZE, MPI_CHAR, peer_rank, 0,
+		     src_handle, NCCL_NET_HANDLE_MAXSIZE, MPI_CHAR, peer_rank, 0,
+		     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+	while (sComm == NULL || rComm == NULL) {
+		if (sComm == NULL) {
+			OFINCCLCHECKGOTO(extNet->connect(dev, (void *)src_handle, (void **)&sComm,
+							 &s_ignore), res, exit);
+		}
+		if (rComm == NULL) {
+			OFINCCLCHECKGOTO(extNet->accept((void *)lComm, (void **)&rComm, &r_ignore),
+					 res, exit);
+		}
+	}
+
+	OFINCCLCHECKGOTO(allocate_buff(&send_buf, max_size, buffer_type), res, exit);
+	OFINCCLCHECKGOTO(initialize_buff(send_buf, max_size, buffer_type), res, exit);
+	OFINCCLCHECKGOTO(allocate_buff(&recv_buf, max_size, buffer_type), res, exit);
+	OFINCCLCHECKGOTO(extNet->regMr((void *)sComm, send_buf, max_size, buffer_type,
+				       &send_mhandle), res, exit);
+	OFINCCLCHECKGOTO(extNet->regMr((void *)rComm, recv_buf, max_size, buffer_type,
+				       &recv_mhandle), res, exit);
+
+	if (rank == 0) {
+		printf("# %s buffers, gap %ld us\n",
+		       buffer_type == NCCL_PTR_CUDA ? "CUDA" : "host", gap_us);
+		printf("# %12s %10s %12s %12s %14s\n", "size (B)", "iters",
+		       "latency (us)", "bw (GB/s)", "cpu/iter (us)");
+	}
+
+	for (size_t szidx = 0; szidx < sizeof(sizes) / sizeof(sizes[0]); szidx++) {
+		size_t size = sizes[szidx];
+		int iters = num_iters;
+		if (iters <= 0) {
+			iters = (size <= 64 * 1024) ? 1000 : std::max(10, (int)(64 * 1024 * 1000 / size));
+		}
+
+		for (int i = 0; i < WARMUP_ITERS; i++) {
+			OFINCCLCHECKGOTO(ping_pong(extNet, rank, sComm, rComm, send_buf, send_mhandle,
+						   recv_buf, recv_mhandle, size), res, exit);
+		}
+		MPI_Barrier(MPI_COMM_WORLD);
+
+		/* Idle gaps are excluded from the measured latency but
+		   not from the CPU time */
+		double elapsed_us = 0;
+		double cpu_start_us = cpu_time_us();
+		for (int i = 0; i < iters; i++) {
+			if (gap_us > 0) {
+				usleep(gap_us);
+			}
+			auto start = std::chrono::steady_clock::now();
+			OFINCCLCHECKGOTO(ping_pong(extNet, rank, sComm, rComm, send_buf, send_mhandle,
+						   recv_buf, recv_mhandle, size), res, exit);
+			auto end = std::chrono::steady_clock::now();
+			elapsed_us += std::chrono::duration<double, std::micro>(end - start).count();
+		}
+		double cpu_us = cpu_time_us() - cpu_start_us;
+
+		if (rank == 0) {
+			/* Half of the round trip */
+			double latency_us = elapsed_us / iters / 2;
+			printf("  %12zu %10d %12.2f %12.2f %14.2f\n", size, iters, latency_us,
+			       size / latency_us / 1e3, cpu_us / iters);
+		}
+		MPI_Barrier(MPI_COMM_WORLD);
+	}
+
+	OFINCCLCHECKGOTO(extNet->deregMr((void *)sComm, send_mhandle), res, exit);
+	OFINCCLCHECKGOTO(extNet->deregMr((void *)rComm, recv_mhandle), res, exit);
+	OFINCCLCHECKGOTO(deallocate_buffer(send_buf, buffer_type), res, exit);
+	send_buf = NULL;
+	OFINCCLCHECKGOTO(deallocate_buffer(recv_buf, buffer_type), res, exit);
+	recv_buf = NULL;
+
+	OFINCCLCHECKGOTO(extNet->closeListen((void *)lComm), res, exit);
+	lComm = NULL;
+	OFINCCLCHECKGOTO(extNet->closeSend((void *)sComm), res, exit);
+	sComm = NULL;
+	OFINCCLCHECKGOTO(extNet->closeRecv((void *)rComm), res, exit);
+	rComm = NULL;
+
+	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Finalize();
+
+exit:
+	return res;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2025 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test-common.h"
+#include "nccl_ofi_idtable.h"
+
+/* Define unit test child class of nccl_ofi_idtable_t that can directly
+   access the directory */
+class nccl_ofi_idtable_t_unit_test : public nccl_ofi_idtable_t {
+public:
+	nccl_ofi_idtable_t_unit_test(size_t size_arg) : nccl_ofi_idtable_t(size_arg) {}
+
+	size_t get_dir_size()
+	{
+		return dir.size();
+	}
+};
+
+int main(int argc, char *argv[])
+{
+	ofi_log_function = logger;
+	const size_t leaf_size = nccl_ofi_idtable_t::leaf_size;
+	size_t sizes[] = {1, leaf_size - 1, leaf_size, leaf_size + 1, 1 << 18};
+
+	for (size_t t = 0; t < sizeof(sizes) / sizeof(size_t); t++) {
+		size_t size = sizes[t];
+		int ret = 0;
+		(void) ret; // Avoid unused-variable warning
+
+		auto *table = new nccl_ofi_idtable_t_unit_test(size);
+		assert(table->get_size() == size);
+		assert(table->get_dir_size() == (size + leaf_size - 1) / leaf_size);
+
+		/* Nothing allocated and nothing stored initially */
+		assert(table->get_num_leaves() == 0);
+		assert(table->get(0) == NULL);
+		assert(table->get(size - 1) == NULL);
+
+		/* Clearing an ID never allocates a leaf */
+		ret = table->set(size - 1, NULL);
+		assert(ret == 0);
+		assert(table->get_num_leaves() == 0);
+
+		/* First and last ID of the table */
+		ret = table->set(0, &sizes[0]);
+		assert(ret == 0);
+		ret = table->set(size - 1, &sizes[1]);
+		assert(ret == 0);
+		if (size - 1 < leaf_size) {
+			assert(table->get_num_leaves() == 1);
+			assert(size == 1 || table->get(0) == &sizes[0]);
+		} else {
+			assert(table->get_num_leaves() == 2);
+			assert(table->get(0) == &sizes[0]);
+			/* Neighbours within the leaf are untouched */
+			assert(table->get(1) == NULL);
+			assert(table->get(size - 2) == NULL);
+		}
+		assert(table->get(size - 1) == &sizes[1]);
+
+		/* Fill all IDs, then clear them again */
+		for (size_t id = 0; id < size; id++) {
+			ret = table->set(id, &sizes[id % 5]);
+			assert(ret == 0);
+		}
+		assert(table->get_num_leaves() == table->get_dir_size());
+		for (size_t id = 0; id < size; id++) {
+			assert(table->get(id) == &sizes[id % 5]);
+			ret = table->set(id, NULL);
+			assert(ret == 0);
+			assert(table->get(id) == NULL);
+		}
+
+		delete table;
+	}
+
+	printf("Test completed successfully!\n");
+
+	return 0;
+}
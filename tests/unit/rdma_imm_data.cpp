@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2025 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+#include "config.h"
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test-common.h"
+#include "nccl_ofi_rdma.h"
+
+/* Immediate data as encoded by protocol version 1 peers */
+static inline uint64_t imm_data_v1(uint64_t comm_id, uint64_t seq, uint64_t nseg)
+{
+	return seq | (comm_id << NCCL_OFI_RDMA_SEQ_BITS) |
+		(nseg << (NCCL_OFI_RDMA_SEQ_BITS + NCCL_OFI_RDMA_COMM_ID_BITS));
+}
+
+int main(int argc, char *argv[])
+{
+	ofi_log_function = logger;
+	uint64_t comm_ids[] = {0, 1, 0x1234, IMM_COMM_ID_MASK};
+	uint64_t seqs[] = {0, 1, MSG_SEQ_NUM_MASK};
+
+	for (uint64_t comm_id : comm_ids) {
+		for (uint64_t seq : seqs) {
+			for (uint64_t nseg = 1; nseg <= NCCL_OFI_RDMA_MAX_NUM_SEGMS; nseg++) {
+				uint64_t data = GET_RDMA_WRITE_IMM_DATA(comm_id, seq, nseg);
+				if (data > UINT32_MAX ||
+				    GET_COMM_ID_FROM_IMM(data) != comm_id ||
+				    GET_SEQ_NUM_FROM_IMM(data) != seq ||
+				    GET_NUM_SEG_FROM_IMM(data) != nseg) {
+					NCCL_OFI_WARN("Round trip failed for comm %" PRIu64 ", seq %" PRIu64 ", %" PRIu64 " segments",
+						      comm_id, seq, nseg);
+					exit(1);
+				}
+
+				if (nseg > NCCL_OFI_RDMA_MAX_NUM_SEGMS_V1) {
+					continue;
+				}
+
+				/* Version 1 senders are decoded the same way */
+				uint64_t data_v1 = imm_data_v1(comm_id, seq, nseg);
+				if (GET_COMM_ID_FROM_IMM(data_v1) != comm_id ||
+				    GET_SEQ_NUM_FROM_IMM(data_v1) != seq ||
+				    GET_NUM_SEG_FROM_IMM(data_v1) != nseg) {
+					NCCL_OFI_WARN("Version 1 data of comm %" PRIu64 ", seq %" PRIu64 ", %" PRIu64
+						      " segments misdecoded",
+						      comm_id, seq, nseg);
+					exit(1);
+				}
+			}
+		}
+	}
+
+	/* Data to version 1 receivers keeps their 18-bit comm IDs */
+	uint64_t comm_id_v1 = ((uint64_t)1 << NCCL_OFI_RDMA_COMM_ID_BITS) - 2;
+	for (uint64_t nseg = 1; nseg <= NCCL_OFI_RDMA_MAX_NUM_SEGMS_V1; nseg++) {
+		if (GET_RDMA_WRITE_IMM_DATA(comm_id_v1, 7, nseg) != imm_data_v1(comm_id_v1, 7, nseg)) {
+			NCCL_OFI_WARN("Data to version 1 receiver with %" PRIu64 " segments differs", nseg);
+			exit(1);
+		}
+	}
+
+	printf("Test completed successfully!\n");
+
+	return 0;
+}
@@ -306,6 +306,28 @@ static inline int test_threshold_scheduler()
 		}
 	}
 
+	/* Communicators may schedule on fewer rails than the scheduler
+	 * was created for. A message must stay on these rails even
+	 * though the round-robin counters were advanced by schedules
+	 * over all rails. */
+	size_t msg_sizes_single_rail[2] = {msg_sizes_1[4], msg_sizes_4[0]};
+	for (int iter = 0; iter < 2; iter++) {
+		int rail_ids_single_rail[1] = {0};
+		size_t offsets_single_rail[1] = {0};
+		size_t msg_size_per_stripe_single_rail[1] = {msg_sizes_single_rail[iter]};
+		ret = test_multiplexer(scheduler,
+		                       1,
+		                       msg_sizes_single_rail[iter],
+		                       1,
+		                       rail_ids_single_rail,
+		                       offsets_single_rail,
+		                       msg_size_per_stripe_single_rail);
+		if (ret) {
+			NCCL_OFI_WARN("Verification failed");
+			return ret;
+		}
+	}
+
 	ret = scheduler->fini(scheduler);
 	if (ret) {
 		NCCL_OFI_WARN("Failed to destroy threshold scheduler");